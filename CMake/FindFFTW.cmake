@@ -1,13 +1,16 @@
 # FFTW_INCLUDE_DIR = fftw3.h
 # FFTW_LIBRARIES = libfftw3.a
 # FFTW_FOUND = true if FFTW3 is found
+# FFTW_THREADS_LIBRARY = libfftw3f_threads, if available
 
 IF(FFTW_INCLUDE_DIRS)
   FIND_PATH(FFTW_INCLUDE_DIR fftw3.h  ${FFTW_INCLUDE_DIRS})
   FIND_LIBRARY(FFTW_LIBRARY fftw3f ${FFTW_LIBRARY_DIRS})
+  FIND_LIBRARY(FFTW_THREADS_LIBRARY fftw3f_threads ${FFTW_LIBRARY_DIRS})
 ELSE(FFTW_INCLUDE_DIRS)
   FIND_PATH(FFTW_INCLUDE_DIR fftw3.h ${lib_INCLUDE_PATHS})
   FIND_LIBRARY(FFTW_LIBRARIES fftw3f ${lib_LIBRARY_PATHS}) 
+  FIND_LIBRARY(FFTW_THREADS_LIBRARY fftw3f_threads ${lib_LIBRARY_PATHS})
 ENDIF(FFTW_INCLUDE_DIRS)
 
 SET(FFTW_FOUND FALSE)
@@ -21,6 +24,7 @@ ENDIF(FFTW_INCLUDE_DIR AND FFTW_LIBRARIES)
 MARK_AS_ADVANCED(
    FFTW_INCLUDE_DIR
    FFTW_LIBRARIES
+   FFTW_THREADS_LIBRARY
    FFTW_FOUND
 )
 
@@ -0,0 +1,116 @@
+/*******************************************************************************
+
+  File:    sqaffine.c
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+#ifndef __x86_64__
+    #define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sq_dsp.h>
+#include <sq_utils.h>
+
+char* usage_text[] = 
+{
+    "                                                                   ",
+    "NAME                                                               ",
+    "   sqaffine - maps each sample x of the signal to a*x + b in one   ",
+    "              pass, where a = R*exp(j*Theta) and b is a complex DC ",
+    "              offset; x may be conjugated first. It does the work  ",
+    "              of sqconjugate, sqscaleandrotate and sqoffset at once",
+    "SYNOPSIS                                                           ",
+    "   sqaffine [OPTIONS] ...                                          ",
+    "DESCRIPTION                                                        ",
+    "   -l number of samples to read in one go.                         ",
+    "   -s scaling factor R (default 1)                                 ",
+    "   -t phase Theta, in radians (default 0)                          ",
+    "   -r real offset                                                  ",
+    "   -i imaginary offset                                             ",
+    "   -c conjugate the samples before scaling and rotating them       ",
+    "                                                                   "
+};
+int arrlen = sizeof(usage_text)/sizeof(*usage_text);
+
+unsigned int data_len = 1000000;
+float R = 1;
+float theta = 0;
+float real_delta = 0.0;
+float imag_delta = 0.0;
+unsigned char is_conjugated = 0;
+
+int main(int argc, char **argv)
+{
+    int opt;
+    sq_affine_state state;
+
+    while ((opt = getopt(argc, argv, "hl:s:t:r:i:c")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(usage_text, arrlen);
+                exit(EXIT_FAILURE);
+            case 'l':
+                sscanf(optarg, "%u", &data_len);
+                break;
+            case 's':
+                sscanf(optarg, "%f", &R);
+                break;
+            case 't':
+                sscanf(optarg, "%f", &theta);
+                break;
+            case 'r':
+                sscanf(optarg, "%f", &real_delta);
+                break;
+            case 'i':
+                sscanf(optarg, "%f", &imag_delta);
+                break;
+            case 'c':
+                is_conjugated = 1;
+                break;
+            default:
+                print_usage(usage_text, arrlen);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    sq_affine_init(&state, R, theta, real_delta, imag_delta, is_conjugated);
+    int status = sq_affine(stdin, stdout, data_len, &state);
+    
+    if(status < 0)
+    {
+        fprintf(stderr, "%s encountered a fatal error.", argv[0]);
+        sq_error_handle(status);
+        exit(EXIT_FAILURE);
+    }
+    
+    exit(EXIT_SUCCESS);
+}
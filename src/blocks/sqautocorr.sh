@@ -36,5 +36,7 @@ else
     WINDOW_BLOCK="sqwindow -w $WINDOW"
 fi
 
-cat | $WINDOW_BLOCK -l $length | sqfft -l $length | sqpower -l $length | sqfft -l $length -i
+# the power spectrum is real, so it is passed as a compact real stream and
+# the inverse runs as a real-input transform
+cat | $WINDOW_BLOCK -l $length | sqfft -l $length | sqpower -l $length -r | sqfft -l $length -i -r
 
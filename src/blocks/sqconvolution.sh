@@ -9,12 +9,6 @@ while getopts l: OPTION
 esac
 done
 
-mkfifo fft1
-mkfifo fft2
+shift $((OPTIND - 1))
 
-cat $3 | sqsample -l $length | sqwindow -l $length | sqfft -l $length > fft1 &
-cat $4 | sqsample -l $length | sqwindow -l $length | sqfft -l $length > fft2 &
-
-sqcrossmultiply fft1 fft2 -l $length | sqfft -l $length -i
-
-rm fft1 fft2
+exec sqxcorr -v -l $length "$1" "$2"
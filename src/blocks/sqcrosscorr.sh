@@ -10,10 +10,10 @@ usage () {
   echo "  sqcrosscorr [OPTIONS] file1 file2                                     " >&2
   echo "OPTIONS                                                                 " >&2
   echo "  -l FFT length integer (required)                                      " >&2
-  echo "  -w window type [wola, hann]; default is wola                          " >&2
+  echo "  -w window type [wola, hann]; default is hann                          " >&2
   echo "  -h show help (this)                                                   " >&2
   echo "EXAMPLE                                                                 " >&2
-  echo "  sqcrosscorr -c 1420.0 time-frequency-power.dat                        " >&2
+  echo "  sqcrosscorr -l 4096 signal1.dat signal2.dat                           " >&2
   echo "                                                                        " >&2
 }
 
@@ -27,19 +27,8 @@ do
     esac
 done
 
-# Choose block
-if [ "$WINDOW" == "wola" ]; then
-    WINDOW_BLOCK="sqwola -f 9 -o 0"
-else
-    WINDOW_BLOCK="sqwindow -w $WINDOW"
-fi
+shift $((OPTIND - 1))
 
-mkfifo fft1
-mkfifo fft2
-
-cat $5 | sqsample -l $length | $WINDOW_BLOCK -l $length | sqfft -l $length > fft1 &
-cat $6 | sqsample -l $length | $WINDOW_BLOCK -l $length | sqfft -l $length | sqconjugate -l $length > fft2 &
-
-sqcrossmultiply fft1 fft2 -l $length | sqfft -l $length -i
-
-rm fft1 fft2
+# one process reads and transforms both files, so no named pipes are made
+# in the current directory
+exec sqxcorr -l $length -w $WINDOW "$1" "$2"
@@ -59,6 +59,16 @@ char *usage_text[] =
     "  -m  measure plan instead of estimate.  This will cause an initial     ",
     "      delay but should result in an optimized transform.                ",
     "  -i inverse transform                                                  ",
+    "  -W  wisdom file; wisdom is loaded from it before planning (if it      ",
+    "      exists) and saved to it afterwards.  Use with -m, or see sqwisdom.",
+    "  -t  integer number of threads per transform; default is 1             ",
+    "  -b  integer number of rasters transformed per read (batched plan);    ",
+    "      default is 1                                                      ",
+    "  -r  real input: samples are single floats, as written by sqreal;      ",
+    "      the transform does half the work of a complex one.  Output is     ",
+    "      the full complex spectrum.  -c is ignored.                        ",
+    "  -R  real output (with -i): the input spectrum is taken to be that of  ",
+    "      a real signal, and one float per sample is written                ",
     "                                                                        "
 };
 int arrlen = sizeof(usage_text)/sizeof(*usage_text);
@@ -67,12 +77,16 @@ unsigned char is_conjugated = 0;
 unsigned char is_measured = 0;
 unsigned int fft_len = 0;
 unsigned char inverse = 0;
+unsigned int nthreads = 1;
+char* wisdom_file = NULL;
+unsigned int batch = 1;
+unsigned char real_mode = 0;
 
 int main(int argc, char *argv[])
 {
     int opt;
 
-    while ((opt = getopt(argc, argv, "hl:cmi")) != -1)
+    while ((opt = getopt(argc, argv, "hl:cmit:b:W:rR")) != -1)
     {
         switch (opt)
         {
@@ -92,14 +106,47 @@ int main(int argc, char *argv[])
             case 'i':
                 inverse = 1;
                 break;
+            case 't':
+                sscanf(optarg, "%u", &nthreads);
+                break;
+            case 'W':
+                wisdom_file = optarg;
+                break;
+            case 'b':
+                sscanf(optarg, "%u", &batch);
+                break;
+            case 'r':
+                real_mode |= SQ_FFT_REAL_INPUT;
+                break;
+            case 'R':
+                real_mode |= SQ_FFT_REAL_OUTPUT;
+                break;
             default:
                 print_usage(usage_text, arrlen);
                 exit(EXIT_SUCCESS);
         }
     }
 
-    int status = sq_fft(stdin, stdout, fft_len, is_conjugated, is_measured, inverse);
+    // threads first: FFTW rejects wisdom made with other solvers registered
+    int status = sq_fft_set_threads(nthreads);
+
+    // a missing wisdom file is fine, it is created below; one FFTW cannot
+    // read is not overwritten with the wisdom of this run alone
+    if ((status == 0) && (wisdom_file != NULL) &&
+        (sq_fft_import_wisdom(wisdom_file) == ERR_STREAM_READ))
+    {
+        fprintf(stderr, "Could not load wisdom from %s, it is left unchanged\n", wisdom_file);
+        wisdom_file = NULL;
+    }
+
+    if ((status == 0) && real_mode)
+        status = sq_fft_real(stdin, stdout, fft_len, is_measured, inverse, real_mode, nthreads, batch);
+    else if (status == 0)
+        status = sq_fft_batch(stdin, stdout, fft_len, is_conjugated, is_measured, inverse, nthreads, batch);
     
+    if ((status == 0) && (wisdom_file != NULL) && (sq_fft_export_wisdom(wisdom_file) < 0))
+        fprintf(stderr, "Could not save wisdom to %s\n", wisdom_file);
+
     if(status < 0)
     {
         fprintf(stderr, "%s encountered a fatal error.", argv[0]);
@@ -54,6 +54,11 @@ char* usage_text[] =
     "   -a Length of a cycle in terms of number of samples                  ",
     "   -w Wavelength of the sinusoid                                       ",
     "   -n The SNR (Signal to Noise Ratio)                                  ",
+    "   -H Start the output with a stream header (see sqheader)             ",
+    "   -r Sample rate in Hz, recorded in the header; implies -H            ",
+    "   -f Center frequency in Hz, recorded in the header; implies -H       ",
+    "   -t Time of the first sample in seconds since the epoch, recorded    ",
+    "      in the header; implies -H                                        ",
     "                                                                       "
 };
 int arrlen = sizeof(usage_text)/sizeof(*usage_text);
@@ -64,12 +69,16 @@ unsigned int length = 16777216;
 unsigned int sine_array_length = 128;
 float wavelength = 2.4f;
 float SNR = 0.01;
+unsigned char is_headed = 0;
+sq_stream_header header;
 
 int main(int argc, char *argv[])
 {
     int opt;
+
+    sq_header_init(&header, SQ_SAMPLE_COMPLEX, 0, 0);
     
-    while ((opt = getopt(argc, argv, "hl:s:a:w:n:")) != -1)
+    while ((opt = getopt(argc, argv, "hl:s:a:w:n:Hr:f:t:")) != -1)
     {
         switch (opt)
         {
@@ -91,13 +100,29 @@ int main(int argc, char *argv[])
             case 'n':
                 sscanf(optarg, "%f", &SNR);
                 break;
+            case 'H':
+                is_headed = 1;
+                break;
+            case 'r':
+                sscanf(optarg, "%lf", &header.sample_rate);
+                is_headed = 1;
+                break;
+            case 'f':
+                sscanf(optarg, "%lf", &header.center_freq);
+                is_headed = 1;
+                break;
+            case 't':
+                sscanf(optarg, "%lf", &header.timestamp);
+                is_headed = 1;
+                break;
             default:
                 print_usage(usage_text, arrlen);
                 exit(EXIT_SUCCESS);
         }
     }
     
-    int status = sq_gen_sine(stdout, nsamples, length, sine_array_length, wavelength, SNR);
+    int status = sq_gen_sine_header(stdout, nsamples, length, sine_array_length, wavelength, SNR,
+                                    is_headed ? &header : NULL);
     
     if(status < 0)
     {
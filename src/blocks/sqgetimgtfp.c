@@ -35,10 +35,12 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <inttypes.h>
+#include <string.h>
 #include <math.h>
 
 #include <sq_utils.h>
 #include <sq_imaging.h>
+#include <sq_tiled.h>
 #include <sq_constants.h>
 #define MAXVAL MAX_PIXEL_VAL
 
@@ -47,19 +49,25 @@
 char *usage_text[] = {
     "                                                                        ",
     "NAME                                                                    ",
-    "  sqgetimgtfp - internal utility called by sqwaterfalls                 ",
+    "  sqgetimgtfp - cuts one waterfall image strip out of a TFP file;       ",
+    "                sqwaterfalls renders all of them in one pass            ",
     "SYNOPSIS                                                                ",
     "  sqgetimgtfp [OPTIONS] -time-freq-pwr.dat                              ",
     "DESCRIPTION                                                             ",
     "  -c  integer (required), channel                                       ",
     "  -o  integer (required), offset (0 through 7)                          ",
+    "                                                                        ",
+    "  The file is either flat TFP data of 8388608 columns and 4096 channels ",
+    "  or a tiled TFP file (see sqtfptile), which records its own sizes.     ",
+    "  Flat data may start with a stream header (see sqheader), which then   ",
+    "  gives the number of columns.                                          ",
     "                                                                        "
 };
 int arrlen = sizeof(usage_text)/sizeof(*usage_text);
 
+// sizes of a flat TFP file, which has no header
 #define TFPW 8388608
-#define CHANW (TFPW / 4096)
-#define IMGW (CHANW / 8)
+#define NCHANNELS 4096
 
 #define STATW 5
 
@@ -70,7 +78,8 @@ unsigned int ofst = 0;
 
 FILE *tfp;
 
-float imgd[MAXROWS*(STATW*IMGW)];
+unsigned int IMGW;
+float *imgd;
 
 void power_scale(unsigned int rowN);
 
@@ -78,6 +87,14 @@ int main(int argc, char *argv[]) {
     unsigned int rowi, rowN;
 
     uint64_t rowofst;
+    uint64_t dataofst = 0;
+    sq_stream_header header;
+
+    unsigned int tfpw = TFPW;
+    unsigned int chanw;
+
+    sq_tiled tiled;
+    int64_t nrows;
 
     int opt;
 
@@ -101,29 +118,69 @@ int main(int argc, char *argv[]) {
         exit(EXIT_FAILURE);
     }
 
-    tfp = fopen(argv[optind], "rb");
-    if (!(tfp)) {
+    int status = sq_tiled_open(&tiled, argv[optind]);
+    if (status == 0) {
+        tfpw = tiled.header.fft_len;
+        chanw = tfpw / tiled.header.nchannels;
+    } else if (status == ERR_BAD_FORMAT) {
+        tfp = fopen(argv[optind], "rb");
+        if (tfp && (fread(&header, sizeof(header), 1, tfp) == 1) &&
+                (memcmp(header.magic, SQ_STREAM_MAGIC, sizeof(header.magic)) == 0)) {
+            dataofst = sizeof(header);
+            tfpw = header.raster_length;
+        }
+        if (tfp)
+            fclose(tfp);
+        chanw = tfpw / NCHANNELS;
+    } else {
         fprintf(stderr, "unable to open file %s", argv[optind]);
         exit(EXIT_FAILURE);
     }
+    IMGW = chanw / 8;
 
-    rowi = 0;
-    rowofst = (TFPW/2)+(-(CHANW/2))+(chan*CHANW)+(ofst*IMGW)+(-((STATW/2)*IMGW));
-    for (rowi = 0; rowi < MAXROWS; rowi++) 
-    {
-        if (!(fseek(tfp, ((((uint64_t)(rowi*TFPW))+rowofst)*sizeof(float)), SEEK_SET) == 0))
-        {
-            fprintf(stderr, "Could not seek anymore.\n");
-            break;
+    imgd = malloc((size_t) MAXROWS * (STATW*IMGW) * sizeof(float));
+    if (imgd == NULL) {
+        sq_error_handle(ERR_MALLOC);
+        exit(EXIT_FAILURE);
+    }
+
+    rowofst = (tfpw/2)+(-(chanw/2))+(chan*chanw)+(ofst*IMGW)+(-((STATW/2)*IMGW));
+
+    if (status == 0) {
+        // a tiled file gives the whole strip in one read per band of rows
+        nrows = sq_tiled_read(&tiled, 0, MAXROWS, rowofst, STATW*IMGW, imgd);
+        if (nrows < 0) {
+            fprintf(stderr, "%s encountered a fatal error.", argv[0]);
+            sq_error_handle(nrows);
+            exit(EXIT_FAILURE);
+        }
+        rowN = nrows;
+        sq_tiled_close(&tiled);
+    } else {
+        tfp = fopen(argv[optind], "rb");
+        if (!(tfp)) {
+            fprintf(stderr, "unable to open file %s", argv[optind]);
+            exit(EXIT_FAILURE);
         }
-            
-        if (!(fread(&imgd[rowi*(STATW*IMGW)], sizeof(float), (STATW*IMGW), tfp) == (STATW*IMGW)))
+
+        rowi = 0;
+        for (rowi = 0; rowi < MAXROWS; rowi++) 
         {
-            fprintf(stderr, "Could not read anymore, on row %d.\n", rowi);
-            break;
+            if (!(fseek(tfp, dataofst+((((uint64_t)rowi*tfpw)+rowofst)*sizeof(float)), SEEK_SET) == 0))
+            {
+                fprintf(stderr, "Could not seek anymore.\n");
+                break;
+            }
+                
+            if (!(fread(&imgd[rowi*(STATW*IMGW)], sizeof(float), (STATW*IMGW), tfp) == (STATW*IMGW)))
+            {
+                fprintf(stderr, "Could not read anymore, on row %d.\n", rowi);
+                break;
+            }
         }
+        rowN = rowi;
+        fclose(tfp);
     }
-    rowN = rowi;
 
     power_scale(rowN);
 
@@ -141,18 +198,13 @@ void power_scale(unsigned int rowN) {
 
     float mean, stddev;
     float min, max;
+    sq_img_stats stats;
 
     unsigned int imgN = rowN*(STATW*IMGW);
 
-    mean = 0.0;
-    for (imgi = 0; imgi < imgN; imgi++)
-        mean += sqrt(imgd[imgi]);
-    mean /= (float) imgN;
-
-    stddev = 0.0;
-    for (imgi = 0; imgi < imgN; imgi++)
-        stddev += (sqrt(imgd[imgi]) - mean) * (sqrt(imgd[imgi]) - mean);
-    stddev = sqrt(stddev / (float) imgN);
+    sq_amp_stats(imgd, rowN, STATW*IMGW, STATW*IMGW, 0.0, &stats);
+    mean = stats.mean;
+    stddev = stats.stddev;
 
     min = mean - stddev;
     if (min < 0.0) min = 0.0;
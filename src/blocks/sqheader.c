@@ -0,0 +1,117 @@
+/*******************************************************************************
+
+  File:    sqheader.c
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+#ifndef __x86_64__
+#   define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sq_utils.h>
+
+//          1         2         3         4         5         6         7
+// 123456789012345678901234567890123456789012345678901234567890123456789012
+char *usage_text[] =
+{
+    "                                                                        ",
+    "NAME                                                                    ",
+    "  sqheader - prints the stream header of a block-to-block stream (see   ",
+    "             sqsample -H) as shell variable assignments:                ",
+    "             SQ_SAMPLE_TYPE, SQ_RASTER_LENGTH, SQ_RASTERED,             ",
+    "             SQ_SAMPLE_RATE, SQ_CENTER_FREQ and SQ_TIMESTAMP.           ",
+    "             Exits with status 1 if the stream has no header.           ",
+    "SYNOPSIS                                                                ",
+    "  sqheader [OPTIONS] [FILE]                                             ",
+    "  Reads FILE if given, else the input stream.                           ",
+    "DESCRIPTION                                                             ",
+    "  -s  strip: write the samples without the header to the output stream, ",
+    "      for programs that do not read headers                             ",
+    "EXAMPLE                                                                 ",
+    "  eval $(sqheader obs-tfp.dat)                                          ",
+    "                                                                        "
+};
+int arrlen = sizeof(usage_text)/sizeof(*usage_text);
+
+unsigned char is_stripping = 0;
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    sq_input input;
+    sq_stream_header header;
+    const void *bfr;
+    size_t nbytes;
+
+    while ((opt = getopt(argc, argv, "hs")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(usage_text, arrlen);
+                exit(EXIT_SUCCESS);
+            case 's':
+                is_stripping = 1;
+                break;
+            default:
+                print_usage(usage_text, arrlen);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    int status = sq_input_open_path(&input, (optind < argc) ? argv[optind] : "-");
+    if (status == 0)
+        status = sq_input_header(&input, &header);
+
+    if (status < 0)
+    {
+        fprintf(stderr, "%s encountered a fatal error.", argv[0]);
+        sq_error_handle(status);
+        exit(EXIT_FAILURE);
+    }
+
+    if (is_stripping)
+    {
+        while ((nbytes = sq_input_view(&input, &bfr, 1, SMPLS_PER_READ)) > 0)
+            fwrite(bfr, 1, nbytes, stdout);
+    }
+    else if (status > 0)
+    {
+        printf("SQ_SAMPLE_TYPE=%s\n", (header.sample_type == SQ_SAMPLE_REAL) ? "real" : "complex");
+        printf("SQ_RASTER_LENGTH=%u\n", header.raster_length);
+        printf("SQ_RASTERED=%u\n", (header.flags & SQ_STREAM_RASTERED) ? 1 : 0);
+        printf("SQ_SAMPLE_RATE=%.6f\n", header.sample_rate);
+        printf("SQ_CENTER_FREQ=%.6f\n", header.center_freq);
+        printf("SQ_TIMESTAMP=%.6f\n", header.timestamp);
+    }
+    sq_input_close(&input);
+
+    exit(((status > 0) || is_stripping) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -51,24 +51,31 @@ char *usage_text[] =
     "  sqmaxhold [OPTIONS] ...                                               ",
     "DESCRIPTION                                                             ",
     "  -l  Input number of samples per operation                             ",
-    "  -o  Number of samples in the output for the given input number        ",
+    "  -o  Number of samples in the output for the given input number; it    ",
+    "      need not divide the input number evenly                           ",
+    "  -r  input and output are compact real streams (one float per sample), ",
+    "      as written by sqpower -r, sqtfp or sqreal                         ",
     "                                                                        "
 };
 int arrlen = sizeof(usage_text)/sizeof(*usage_text);
 
 unsigned int in_length = SMPLS_PER_READ;
 unsigned int out_length = SMPLS_PER_READ;
+unsigned char is_real = 0;
 
 int main(int argc, char *argv[])
 {
     int opt;
-    while ((opt = getopt(argc, argv, "hl:o:")) != -1)
+    while ((opt = getopt(argc, argv, "hl:o:r")) != -1)
     {
         switch (opt)
         {
             case 'h':
                 print_usage(usage_text, arrlen);
                 exit(EXIT_FAILURE);
+            case 'r':
+                is_real = 1;
+                break;
             case 'l':
                 sscanf(optarg, "%u", &in_length);
                 break;
@@ -81,7 +88,8 @@ int main(int argc, char *argv[])
         }
     }
 
-    int status = sq_maxhold(stdin, stdout, in_length, out_length);
+    int status = is_real ? sq_maxhold_real(stdin, stdout, in_length, out_length)
+                         : sq_maxhold(stdin, stdout, in_length, out_length);
     
     if(status < 0)
     {
@@ -57,9 +57,9 @@ char* usage_text[] =
 int arrlen = sizeof(usage_text)/sizeof(*usage_text);
 
 unsigned int data_len = 1000000;
-float channel = 0.0;
-float rad_per_sample = 0.0;
-const float TWO_PI = 2.0 * M_PI;
+double channel = 0.0;
+double rad_per_sample = 0.0;
+const double TWO_PI = 2.0 * M_PI;
 
 int main(int argc, char **argv)
 {
@@ -76,11 +76,11 @@ int main(int argc, char **argv)
                 sscanf(optarg, "%u", &data_len);
                 break;
             case 'r':
-                sscanf(optarg, "%f", &rad_per_sample);
+                sscanf(optarg, "%lf", &rad_per_sample);
                 break;
             case 'c':
-                sscanf(optarg, "%f", &channel);
-                rad_per_sample = TWO_PI * (channel / (float) SQ_STAGE1_FFT_LEN);  
+                sscanf(optarg, "%lf", &channel);
+                rad_per_sample = TWO_PI * (channel / (double) SQ_STAGE1_FFT_LEN);  
                 break;
             default:
                 print_usage(usage_text, arrlen);
@@ -50,6 +50,8 @@ char* usage_text[] =
     "   -l number of samples to read in one go.                         ",
     "   -r real offset                                                  ",
     "   -i imaginary offset                                             ",
+    "   -R input and output are compact real streams (one float per     ",
+    "      sample), as written by sqpower -r or sqreal; -i is ignored   ",
     "                                                                   "
 };
 int arrlen = sizeof(usage_text)/sizeof(*usage_text);
@@ -57,11 +59,12 @@ int arrlen = sizeof(usage_text)/sizeof(*usage_text);
 unsigned int smpls_len = 1000000;
 float real_delta = 0.0;
 float imag_delta = 0.0;
+unsigned char is_real = 0;
 
 int main(int argc, char **argv)
 {
     int opt;
-    while ((opt = getopt(argc, argv, "hr:i:l:")) != -1)
+    while ((opt = getopt(argc, argv, "hr:i:l:R")) != -1)
     {
         switch (opt)
         {
@@ -74,6 +77,9 @@ int main(int argc, char **argv)
             case 'i':
                 sscanf(optarg, "%f", &imag_delta);
                 break;
+            case 'R':
+                is_real = 1;
+                break;
             case 'l':
                 sscanf(optarg, "%u", &smpls_len);
                 break;
@@ -83,7 +89,8 @@ int main(int argc, char **argv)
         }
     }
 
-    int status = sq_offset(stdin, stdout, smpls_len, real_delta, imag_delta);
+    int status = is_real ? sq_offset_real(stdin, stdout, smpls_len, real_delta)
+                         : sq_offset(stdin, stdout, smpls_len, real_delta, imag_delta);
     
     if(status < 0)
     {
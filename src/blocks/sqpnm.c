@@ -53,7 +53,7 @@ char *usage_text[] =
     "SYNOPSIS                                                                ",
     "  sqpnm [OPTIONS] ...                                                   ",
     "DESCRIPTION                                                             ",
-    "  -r  pos. integer (required), image rows                               ",
+    "  -r  pos. integer, image rows - default is all rows of the input       ",
     "  -c  pos. integer (required), image columns                            ",
     "  -a  Number of lines to average                                        ",
     "  -m  flag, use a regular 0-maxpix scale, where 0 -> 0 and maxpix -> 255",
@@ -64,26 +64,46 @@ char *usage_text[] =
     "  -s  flag, very similar to -p, except the image is plotted as          ",
     "      sqrt(power) = amp, which highlights lower values more             ",
     "  -x  flag, power values not scaled                                     ",
+    "  -q  flag, percentile scale: the low percentile (default 1) is scaled  ",
+    "      to 0 and the high percentile (default 99.5) to MAX_PIXEL_VAL, so  ",
+    "      strong RFI does not darken the image.  Values outside of range    ",
+    "      are clipped.                                                      ",
+    "  -L  real, low percentile for -q                                       ",
+    "  -H  real, high percentile for -q                                      ",
+    "  -F  lo:hi, fixed scale, lo scaled to 0 and hi to MAX_PIXEL_VAL        ",
+    "  -k  pos. integer, rows a pipe is scaled from - default value is 256   ",
+    "  -P  flag, write a PNG image instead of a PGM image                    ",
+    "  -f  flag, flip the image so that the last row is on top               ",
+    "  -g  real, gamma correction of the pixels - default value is 1.0       ",
+    "                                                                        ",
+    "  The image is read a row at a time.  A file given as the input (sqpnm  ",
+    "  < file) is read once for the scale statistics and again to write the ",
+    "  image; a pipe is read once, scaled by the statistics of its first -k ",
+    "  rows.  -x and -F need no statistics.                                 ",
     "                                                                        "
 };
 int arrlen = sizeof(usage_text)/sizeof(*usage_text);
 
-float *imgbfr;
-float* imgbfr_avg;
 unsigned int rows = 0;
 unsigned int cols = 0;
 unsigned int averagelines = 0;
-float chop_fraction = 0.0;
-
-int (*scale_fnctn)(float* img_buf, int rows, int cols);
+unsigned int scale_mode = SQ_SCALE_LINEAR;
+double low = 0.0;
+double high = 0.0;
+double low_pct = SQ_PCTL_LOW;
+double high_pct = SQ_PCTL_HIGH;
+float fixed_low = 0.0;
+float fixed_high = MAX_PIXEL_VAL;
+unsigned int sketch_rows = SQ_SKETCH_ROWS;
+unsigned int format = SQ_IMAGE_PGM;
+unsigned char is_flipped = 0;
+float gamma_corr = 1.0;
 
 int main(int argc, char *argv[])
 {
     int opt;
 
-    scale_fnctn = sq_linear_scale;
-
-    while ((opt = getopt(argc, argv, "hr:c:a:psx")) != -1)
+    while ((opt = getopt(argc, argv, "hr:c:a:mpsxqL:H:F:k:Pfg:")) != -1)
     {
         switch (opt)
         {
@@ -100,16 +120,41 @@ int main(int argc, char *argv[])
                 sscanf(optarg, "%u", &averagelines);
                 break;
             case 'm':
-		scale_fnctn = sq_linear_scale;
-		break;
+                scale_mode = SQ_SCALE_LINEAR;
+                break;
             case 'p':
-                scale_fnctn = sq_power_scale;
+                scale_mode = SQ_SCALE_POWER;
                 break;
             case 's':
-		scale_fnctn = sq_amp_scale;
-		break;
+                scale_mode = SQ_SCALE_AMP;
+                break;
             case 'x':
-                scale_fnctn = sq_no_scale;
+                scale_mode = SQ_SCALE_NONE;
+                break;
+            case 'q':
+                scale_mode = SQ_SCALE_PERCENTILE;
+                break;
+            case 'L':
+                sscanf(optarg, "%lf", &low_pct);
+                break;
+            case 'H':
+                sscanf(optarg, "%lf", &high_pct);
+                break;
+            case 'F':
+                sscanf(optarg, "%f:%f", &fixed_low, &fixed_high);
+                scale_mode = SQ_SCALE_FIXED;
+                break;
+            case 'k':
+                sscanf(optarg, "%u", &sketch_rows);
+                break;
+            case 'P':
+                format = SQ_IMAGE_PNG;
+                break;
+            case 'f':
+                is_flipped = 1;
+                break;
+            case 'g':
+                sscanf(optarg, "%f", &gamma_corr);
                 break;
             default:
                 print_usage(usage_text, arrlen);
@@ -117,49 +162,30 @@ int main(int argc, char *argv[])
         }
     }
 
-    //fprintf(stderr, "Allocating image\n");
-    
-    imgbfr = malloc(sizeof(float) * rows * cols);
-
-    //fprintf(stderr, "Allocated image\n");
-    if(imgbfr == NULL)
+    if (cols == 0)
     {
-        sq_error_handle(ERR_MALLOC);
+        print_usage(usage_text, arrlen);
         exit(EXIT_FAILURE);
     }
-    
-    //fprintf(stderr, "reading image\n");
-    rows = sq_read_img(stdin, imgbfr, rows, cols);
 
-    // Check the number of rows and deal
-    if (!(rows > 0))
+    if (scale_mode == SQ_SCALE_PERCENTILE)
     {
-        free(imgbfr); 
-        sq_error_handle(ERR_STREAM_READ);
-        exit(EXIT_FAILURE);
+        low = low_pct;
+        high = high_pct;
     }
-
-    //fprintf(stderr, "Scaling image\n");
-
-    scale_fnctn(imgbfr, rows, cols);
-    
-    //fprintf(stderr, "Scaled image\n");
-    // Now optionally average the lines as desired
-    if(averagelines > 0)
+    else if (scale_mode == SQ_SCALE_FIXED)
     {
-        imgbfr_avg = malloc(sizeof(float) * rows/averagelines * cols);
-        sq_average_lines(imgbfr, rows, cols, imgbfr_avg, averagelines);
-        sq_write_pnm(stdout, imgbfr_avg, rows/averagelines, cols);
-        scale_fnctn(imgbfr_avg, rows/averagelines, cols);
-        free(imgbfr_avg);
+        low = fixed_low;
+        high = fixed_high;
     }
-    else
+
+    int status = sq_image_stream(stdin, stdout, rows, cols, averagelines, scale_mode, low, high,
+                                 sketch_rows, format, is_flipped, gamma_corr);
+    if (status < 0)
     {
-        sq_write_pnm(stdout, imgbfr, rows, cols);
+        sq_error_handle(status);
+        exit(EXIT_FAILURE);
     }
 
-    free(imgbfr);
-
-    //fprintf(stderr, "Exiting image\n");
     exit(EXIT_SUCCESS);
 }
@@ -48,24 +48,30 @@ char* usage_text[] =
     "   sqpower [OPTIONS] ...                                           ",
     "DESCRIPTION                                                        ",
     "   -l number of samples to read in one go.                         ",
+    "   -r write one float per sample (compact real stream) instead of  ",
+    "      complex samples with a zero imaginary part                   ",
     "                                                                   "
 };
 int arrlen = sizeof(usage_text)/sizeof(*usage_text);
 
 unsigned int smpls_len = 100000;
+unsigned char is_real = 0;
 
 int main(int argc, char **argv)
 {
 
     int opt;
 
-    while ((opt = getopt(argc, argv, "hl:")) != -1)
+    while ((opt = getopt(argc, argv, "hl:r")) != -1)
     {
         switch (opt)
         {
             case 'h':
                 print_usage(usage_text, arrlen);
                 exit(EXIT_FAILURE);
+            case 'r':
+                is_real = 1;
+                break;
             case 'l':
                 sscanf(optarg, "%u", &smpls_len);
                 break;
@@ -75,7 +81,8 @@ int main(int argc, char **argv)
         }
     }
 
-    int status = sq_power(stdin, stdout, smpls_len);
+    int status = is_real ? sq_power_real(stdin, stdout, smpls_len)
+                         : sq_power(stdin, stdout, smpls_len);
     
     if(status < 0)
     {
@@ -0,0 +1,179 @@
+/*******************************************************************************
+
+  File:    sqpyramid.c
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+#ifndef __x86_64__
+#   define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sq_dsp.h>
+#include <sq_utils.h>
+
+//          1         2         3         4         5         6         7
+// 123456789012345678901234567890123456789012345678901234567890123456789012
+char *usage_text[] =
+{
+    "                                                                        ",
+    "NAME                                                                    ",
+    "  sqpyramid - bins each power spectrum into a pyramid of coarser        ",
+    "              spectra (/2, /4, ... /N) in one pass, both averaged (as   ",
+    "              sqbin) and max-held (as sqmaxhold), each level written to ",
+    "              a file of its own                                         ",
+    "SYNOPSIS                                                                ",
+    "  sqpyramid [OPTIONS] ...                                               ",
+    "DESCRIPTION                                                             ",
+    "  -l  integer (required), input number of samples                       ",
+    "  -f  integer, coarsest binning factor N, a power of 2 that divides the ",
+    "      input length - default value is 16                                ",
+    "  -o  output file prefix (required); level /K is written to             ",
+    "      PREFIX-avgK.dat and PREFIX-maxK.dat                               ",
+    "  -a  flag, only write the averaged levels                              ",
+    "  -x  flag, only write the max-held levels                              ",
+    "  -c  input and output are complex streams, as written by sqpower       ",
+    "      without -r; default is compact real streams (sqtfp, sqpower -r)   ",
+    "EXAMPLE                                                                 ",
+    "  sqtfp -l 65536 < raw.dat | sqpyramid -l 65536 -f 64 -o tfp            ",
+    "                                                                        "
+};
+int arrlen = sizeof(usage_text)/sizeof(*usage_text);
+
+unsigned int in_length = 0;
+unsigned int factor = 16;
+char* prefix = NULL;
+unsigned char is_avg = 1;
+unsigned char is_max = 1;
+unsigned char is_real = 1;
+
+// opens the files of one kind of level; returns NULL if it fails
+static FILE** open_levels(const char* kind, unsigned int nlevels)
+{
+    FILE** streams = calloc(nlevels, sizeof(FILE*));
+    char path[4096];
+    unsigned int leveli;
+
+    if (streams == NULL)
+        return NULL;
+
+    for (leveli = 0; leveli < nlevels; leveli++)
+    {
+        snprintf(path, sizeof(path), "%s-%s%u.dat", prefix, kind, 2U << leveli);
+        streams[leveli] = fopen(path, "wb");
+        if (streams[leveli] == NULL)
+        {
+            fprintf(stderr, "Could not open %s\n", path);
+            return NULL;
+        }
+    }
+
+    return streams;
+}
+
+static void close_levels(FILE** streams, unsigned int nlevels)
+{
+    unsigned int leveli;
+
+    if (streams == NULL)
+        return;
+    for (leveli = 0; leveli < nlevels; leveli++)
+        fclose(streams[leveli]);
+    free(streams);
+}
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    unsigned int nlevels = 0;
+    FILE** avgstreams = NULL;
+    FILE** maxstreams = NULL;
+
+    while ((opt = getopt(argc, argv, "hl:f:o:axc")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(usage_text, arrlen);
+                exit(EXIT_SUCCESS);
+            case 'l':
+                sscanf(optarg, "%u", &in_length);
+                break;
+            case 'f':
+                sscanf(optarg, "%u", &factor);
+                break;
+            case 'o':
+                prefix = optarg;
+                break;
+            case 'a':
+                is_max = 0;
+                break;
+            case 'x':
+                is_avg = 0;
+                break;
+            case 'c':
+                is_real = 0;
+                break;
+            default:
+                print_usage(usage_text, arrlen);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    while ((2U << nlevels) <= factor)
+        nlevels++;
+
+    if ((in_length == 0) || (prefix == NULL) || (nlevels == 0) || ((1U << nlevels) != factor))
+    {
+        print_usage(usage_text, arrlen);
+        exit(EXIT_FAILURE);
+    }
+
+    int status = 0;
+    if (is_avg && ((avgstreams = open_levels("avg", nlevels)) == NULL))
+        status = ERR_STREAM_OPEN;
+    if (is_max && (status == 0) && ((maxstreams = open_levels("max", nlevels)) == NULL))
+        status = ERR_STREAM_OPEN;
+
+    if (status == 0)
+        status = sq_pyramid(stdin, avgstreams, maxstreams, in_length, nlevels, is_real);
+
+    close_levels(avgstreams, nlevels);
+    close_levels(maxstreams, nlevels);
+
+    if(status < 0)
+    {
+        fprintf(stderr, "%s encountered a fatal error.", argv[0]);
+        sq_error_handle(status);
+        print_usage(usage_text, arrlen);
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
@@ -42,6 +42,10 @@
 
 unsigned int samples_len = SMPLS_PER_READ;
 uint64_t filesize = 0;
+unsigned int bits = 8;
+unsigned char is_negated = 1;
+unsigned char is_headed = 0;
+sq_stream_header header;
 
 char* usage_text[] = 
 {
@@ -51,10 +55,21 @@ char* usage_text[] =
     "               and writes samples in the form of floats to the output stream,",
     "               in chunks of a given number of samples.                       ",
     "SYNOPSIS                                                                     ",
-    "   sqsample [OPTIONS] ...                                                    ",
+    "   sqsample [OPTIONS] ... [FILE]                                             ",
+    "   Reads FILE if given (memory-mapped), else the input stream.               ",
     "   -l number of samples to read in one go.                                   ",
     "   -s (optional) size of input - if this is passed, the percentage progress  ",
     "      will be printed.                                                       ",
+    "   -b (optional) bits per channel: 4, 8 or 16; default is 8. 4-bit samples   ",
+    "      take one byte (real in the upper nibble), 16-bit ones are host order.  ",
+    "   -n (optional) flag, keep the sign of the imaginary part instead of        ",
+    "      negating it (the setiQuest convention).                                ",
+    "   -H (optional) flag, start the output with a stream header, which later    ",
+    "      blocks check and pass on (see sqheader).                               ",
+    "   -r (optional) sample rate in Hz, recorded in the header; implies -H       ",
+    "   -f (optional) center frequency in Hz, recorded in the header; implies -H  ",
+    "   -t (optional) time of the first sample in seconds since the epoch,        ",
+    "      recorded in the header; implies -H                                     ",
     "                                                                             "
 };
 int arrlen = sizeof(usage_text)/sizeof(*usage_text);
@@ -62,8 +77,10 @@ int arrlen = sizeof(usage_text)/sizeof(*usage_text);
 int main(int argc, char **argv)
 {
     int opt;
+
+    sq_header_init(&header, SQ_SAMPLE_COMPLEX, 0, 0);
     
-    while ((opt = getopt(argc, argv, "hl:s:")) != -1)
+    while ((opt = getopt(argc, argv, "hl:s:b:nHr:f:t:")) != -1)
     {
         switch (opt)
         {
@@ -74,7 +91,28 @@ int main(int argc, char **argv)
                 sscanf(optarg, "%u", &samples_len);
                 break; 
             case 's':
-                sscanf(optarg, "%u", &filesize);
+                sscanf(optarg, "%" SCNu64, &filesize);
+                break;
+            case 'b':
+                sscanf(optarg, "%u", &bits);
+                break;
+            case 'n':
+                is_negated = 0;
+                break;
+            case 'H':
+                is_headed = 1;
+                break;
+            case 'r':
+                sscanf(optarg, "%lf", &header.sample_rate);
+                is_headed = 1;
+                break;
+            case 'f':
+                sscanf(optarg, "%lf", &header.center_freq);
+                is_headed = 1;
+                break;
+            case 't':
+                sscanf(optarg, "%lf", &header.timestamp);
+                is_headed = 1;
                 break;
             default:
                 print_usage(usage_text, arrlen);
@@ -82,7 +120,19 @@ int main(int argc, char **argv)
         }
     }
     
-    int status = sq_sample(stdin, stdout, samples_len, filesize);
+    FILE* instream = stdin;
+    if (optind < argc)
+    {
+        instream = fopen(argv[optind], "rb");
+        if (instream == NULL)
+        {
+            fprintf(stderr, "%s: could not open %s\n", argv[0], argv[optind]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    int status = sq_sample_header(instream, stdout, samples_len, filesize, bits, is_negated,
+                                  is_headed ? &header : NULL);
     
     if(status < 0)
     {
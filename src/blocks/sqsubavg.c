@@ -47,23 +47,29 @@ char* usage_text[] =
     "   sqsubavg [OPTIONS] ...                                          ",
     "DESCRIPTION                                                        ",
     "   -l number of samples to read in one go.                         ",
+    "   -r input and output are compact real streams (one float per     ",
+    "      sample), as written by sqpower -r or sqreal                  ",
     "                                                                   "
 };
 int arrlen = sizeof(usage_text)/sizeof(*usage_text);
 
 unsigned int data_len = 1000000;
+unsigned char is_real = 0;
 
 int main(int argc, char **argv)
 {
     int opt;
 
-    while ((opt = getopt(argc, argv, "hl:")) != -1)
+    while ((opt = getopt(argc, argv, "hl:r")) != -1)
     {
         switch (opt)
         {
             case 'h':
                 print_usage(usage_text, arrlen);
                 exit(EXIT_SUCCESS);
+            case 'r':
+                is_real = 1;
+                break;
             case 'l':
                 sscanf(optarg, "%u", &data_len);
                 break;
@@ -73,7 +79,8 @@ int main(int argc, char **argv)
         }
     }
     
-    int status = sq_subavg(stdin, stdout, data_len);
+    int status = is_real ? sq_subavg_real(stdin, stdout, data_len)
+                         : sq_subavg(stdin, stdout, data_len);
     
     if(status < 0)
     {
@@ -33,6 +33,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <inttypes.h>
 
@@ -53,6 +54,19 @@ char *usage_text[] =
     "DESCRIPTION                                                             ",
     "  -l  Input number of samples                                           ",
     "  -n  Number of input lines to sum before generating output line        ",
+    "  -r  input and output are compact real streams (one float per sample), ",
+    "      as written by sqpower -r or sqreal                                ",
+    "  -m  integration mode - default is block:                              ",
+    "        block   sum each N lines into one output line                   ",
+    "        boxcar  sliding sum: one output line per input line, the sum of ",
+    "                the last N lines (from the Nth line on); keeps N lines  ",
+    "                in memory                                               ",
+    "        ema     exponential moving average, scaled to the level of an N ",
+    "                line sum: one output line per input line, in constant   ",
+    "                memory                                                  ",
+    "  -k  compensated (Kahan) summation, for block and boxcar; sums are     ",
+    "      always kept in double precision                                   ",
+    "  -p  also write the sum of a short last block                          ",
     "  -h Print usage                                                        ",
     "                                                                        "
 };
@@ -63,10 +77,13 @@ int main(int argc, char **argv)
 {
     unsigned int nsamples = SMPLS_PER_READ;
     unsigned int num_to_sum = 256;
+    unsigned char is_real = 0;
+    unsigned int mode = SQ_SUM_BLOCK;
+    unsigned int flags = 0;
 
     int opt;
 
-    while ((opt = getopt(argc, argv, "hl:n:")) != -1)
+    while ((opt = getopt(argc, argv, "hl:n:rm:kp")) != -1)
     {
         switch (opt)
         {
@@ -79,11 +96,33 @@ int main(int argc, char **argv)
 	    case 'n':
 		sscanf(optarg, "%u", &num_to_sum);
                 break;
+            case 'r':
+                is_real = 1;
+                break;
+            case 'm':
+                if (!strcmp(optarg, "block"))
+                    mode = SQ_SUM_BLOCK;
+                else if (!strcmp(optarg, "boxcar"))
+                    mode = SQ_SUM_BOXCAR;
+                else if (!strcmp(optarg, "ema"))
+                    mode = SQ_SUM_EMA;
+                else
+                {
+                    print_usage(usage_text, arrlen);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'k':
+                flags |= SQ_SUM_KAHAN;
+                break;
+            case 'p':
+                flags |= SQ_SUM_PARTIAL;
+                break;
         }
     }
 
     //fprintf(stderr, "nsamples, num_to_sum: %i %i\n", nsamples, num_to_sum);
-    int status = sq_sum(stdin, stdout, nsamples, num_to_sum);
+    int status = sq_integrate(stdin, stdout, nsamples, num_to_sum, mode, flags, is_real);
     
     if(status < 0)
     {
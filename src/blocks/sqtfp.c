@@ -0,0 +1,154 @@
+/*******************************************************************************
+
+  File:    sqtfp.c
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+
+#ifndef __x86_64__
+#   define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include <sq_dsp.h>
+#include <sq_pipeline.h>
+#include <sq_utils.h>
+
+//          1         2         3         4         5         6         7
+// 123456789012345678901234567890123456789012345678901234567890123456789012
+char *usage_text[] =
+{
+    "                                                                        ",
+    "NAME                                                                    ",
+    "  sqtfp - creates time-frequency-power data from 2-channel 8-bit data.  ",
+    "          Same output as sqsample | sqwola | sqfft | sqpower | sqreal,  ",
+    "          computed in one process without pipes between the stages.    ",
+    "SYNOPSIS                                                                ",
+    "  sqtfp [OPTIONS] ... [FILE]                                            ",
+    "  Reads FILE if given (memory-mapped), else the input stream.           ",
+    "DESCRIPTION                                                             ",
+    "  -l  integer length of transform; default value is 8388608             ",
+    "  -w  window type [wola, hann, ...]; default is wola                    ",
+    "  -f  pos. odd integer, number of WOLA folds; default value is 9        ",
+    "  -W  wisdom file; wisdom is loaded from it before planning (if it      ",
+    "      exists) and saved to it afterwards.  Use with -m, or see sqwisdom.",
+    "  -m  measure plan instead of estimate.                                 ",
+    "  -t  integer number of threads per FFT; default is 1                   ",
+    "  -s  (optional) size of input - if this is passed, the percentage      ",
+    "      progress will be printed.                                         ",
+    "                                                                        "
+};
+int arrlen = sizeof(usage_text)/sizeof(*usage_text);
+
+unsigned int fft_len = 8388608;
+unsigned int folds = 9;
+unsigned char is_measured = 0;
+unsigned int nthreads = 1;
+char* wisdom_file = NULL;
+char window_name[16] = "wola";
+uint64_t filesize = 0;
+
+int main(int argc, char *argv[])
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "hl:w:f:mt:s:W:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(usage_text, arrlen);
+                exit(EXIT_SUCCESS);
+            case 'l':
+                sscanf(optarg, "%u", &fft_len);
+                break;
+            case 'w':
+                sscanf(optarg, "%15s", window_name);
+                break;
+            case 'f':
+                sscanf(optarg, "%u", &folds);
+                break;
+            case 'm':
+                is_measured = 1;
+                break;
+            case 't':
+                sscanf(optarg, "%u", &nthreads);
+                break;
+            case 'W':
+                wisdom_file = optarg;
+                break;
+            case 's':
+                sscanf(optarg, "%" SCNu64, &filesize);
+                break;
+            default:
+                print_usage(usage_text, arrlen);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    FILE* instream = stdin;
+    if (optind < argc)
+    {
+        instream = fopen(argv[optind], "rb");
+        if (instream == NULL)
+        {
+            fprintf(stderr, "%s: could not open %s\n", argv[0], argv[optind]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // threads first: FFTW rejects wisdom made with other solvers registered
+    int status = sq_fft_set_threads(nthreads);
+
+    // a missing wisdom file is fine, it is created below; one FFTW cannot
+    // read is not overwritten with the wisdom of this run alone
+    if ((status == 0) && (wisdom_file != NULL) &&
+        (sq_fft_import_wisdom(wisdom_file) == ERR_STREAM_READ))
+    {
+        fprintf(stderr, "Could not load wisdom from %s, it is left unchanged\n", wisdom_file);
+        wisdom_file = NULL;
+    }
+
+    if (status == 0)
+        status = sq_tfp(instream, stdout, fft_len, window_name, folds, is_measured, filesize);
+
+    if ((status == 0) && (wisdom_file != NULL) && (sq_fft_export_wisdom(wisdom_file) < 0))
+        fprintf(stderr, "Could not save wisdom to %s\n", wisdom_file);
+
+    if(status < 0)
+    {
+        fprintf(stderr, "%s encountered a fatal error.", argv[0]);
+        sq_error_handle(status);
+        print_usage(usage_text, arrlen);
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
@@ -17,18 +17,21 @@ usage ()
     echo "  -l integer (optional), FFT length; default value is 8388608           " >&2
     echo "  -w window type [wola, hann]; default is wola                          " >&2
     echo "  -p show progress                                                      " >&2
+    echo "  -P run the stages as a chain of piped processes instead of the fused  " >&2
+    echo "     sqtfp program (same output; useful for timing comparisons)         " >&2
     echo "  -h show help(this)                                                    " >&2
     echo "EXAMPLE                                                                 " >&2
     echo "  sqtfp -l 4194304 -w hann -p 2010-10-15-crab_1420_1-8bit-{01,02,03}.dat" >&2
     echo "                                                                        " >&2
 }
 
-while getopts l:w:ph OPT
+while getopts l:w:pPh OPT
     do
         case $OPT in
         l) FFTLEN=$OPTARG;;
         w) WINDOW=$OPTARG;;
         p) SHOW_PROGRESS=1;;
+        P) PIPE_CHAIN=1;;
         h) usage && exit 1;;
     esac
 done
@@ -42,13 +45,6 @@ if [ ! "$FILES" ]; then
     exit 1
 fi
 
-# Process data to a time-frequency-power file
-if [ "$WINDOW" == "wola" ]; then
-    WINDOW_BLOCK="sqwola -f 9 -o 0"
-else
-    WINDOW_BLOCK="sqwindow -w $WINDOW"
-fi
-
 FILESIZE=0
 if [ "$SHOW_PROGRESS" == 1 ]; then
     for filename in $FILES
@@ -57,4 +53,17 @@ if [ "$SHOW_PROGRESS" == 1 ]; then
     done
 fi
 
-cat $FILES | sqsample -l $FFTLEN -s $FILESIZE 2>&2 | $WINDOW_BLOCK -l $FFTLEN | sqfft -l $FFTLEN | sqpower -l $FFTLEN | sqreal -l $FFTLEN
\ No newline at end of file
+# Process data to a time-frequency-power file
+if [ "$PIPE_CHAIN" == 1 ]; then
+    if [ "$WINDOW" == "wola" ]; then
+        WINDOW_BLOCK="sqwola -f 9 -o 0"
+    else
+        WINDOW_BLOCK="sqwindow -w $WINDOW"
+    fi
+    cat $FILES | sqsample -l $FFTLEN -s $FILESIZE 2>&2 | $WINDOW_BLOCK -l $FFTLEN | sqfft -l $FFTLEN | sqpower -l $FFTLEN -r
+elif [ $(echo $FILES | wc -w) == 1 ]; then
+    # a single file is memory-mapped by sqtfp itself
+    sqtfp -l $FFTLEN -w $WINDOW -f 9 -s $FILESIZE $FILES
+else
+    cat $FILES | sqtfp -l $FFTLEN -w $WINDOW -f 9 -s $FILESIZE
+fi
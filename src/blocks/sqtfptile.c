@@ -0,0 +1,124 @@
+/*******************************************************************************
+
+  File:    sqtfptile.c
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+
+#ifndef __x86_64__
+#   define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sq_tiled.h>
+#include <sq_utils.h>
+
+//          1         2         3         4         5         6         7
+// 123456789012345678901234567890123456789012345678901234567890123456789012
+char *usage_text[] =
+{
+    "                                                                        ",
+    "NAME                                                                    ",
+    "  sqtfptile - converts time-frequency-power data (as written by sqtfp)  ",
+    "              from the input stream into a tiled TFP file, which        ",
+    "              sqgetimgtfp reads with a few contiguous reads per image.  ",
+    "SYNOPSIS                                                                ",
+    "  sqtfptile [OPTIONS] tiled-file                                        ",
+    "DESCRIPTION                                                             ",
+    "  -l  integer length of the TFP rows (FFT); default value is 8388608    ",
+    "  -n  integer number of channels; default value is 4096                 ",
+    "  -r  integer rows per tile; default value is 16                        ",
+    "  -c  integer columns per tile; default value is 256                    ",
+    "EXAMPLE                                                                 ",
+    "  sqtfp -l 8388608 obs.dat | sqtfptile -l 8388608 obs-tfp.tiled         ",
+    "                                                                        "
+};
+int arrlen = sizeof(usage_text)/sizeof(*usage_text);
+
+unsigned int fft_len = 8388608;
+unsigned int nchannels = 4096;
+unsigned int tile_rows = 16;
+unsigned int tile_cols = 256;
+
+int main(int argc, char *argv[])
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "hl:n:r:c:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(usage_text, arrlen);
+                exit(EXIT_SUCCESS);
+            case 'l':
+                sscanf(optarg, "%u", &fft_len);
+                break;
+            case 'n':
+                sscanf(optarg, "%u", &nchannels);
+                break;
+            case 'r':
+                sscanf(optarg, "%u", &tile_rows);
+                break;
+            case 'c':
+                sscanf(optarg, "%u", &tile_cols);
+                break;
+            default:
+                print_usage(usage_text, arrlen);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if (!((argc - optind) == 1))
+    {
+        print_usage(usage_text, arrlen);
+        exit(EXIT_FAILURE);
+    }
+
+    FILE* outstream = fopen(argv[optind], "wb");
+    if (outstream == NULL)
+    {
+        fprintf(stderr, "unable to open file %s\n", argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+
+    int status = sq_tiled_convert(stdin, outstream, fft_len, nchannels, tile_rows, tile_cols);
+
+    if ((fclose(outstream) != 0) && (status == 0))
+        status = ERR_STREAM_CLOSE;
+
+    if(status < 0)
+    {
+        fprintf(stderr, "%s encountered a fatal error.", argv[0]);
+        sq_error_handle(status);
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,142 @@
+/*******************************************************************************
+
+  File:    sqwaterfalls.c
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+#ifndef __x86_64__
+#   define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sq_imaging.h>
+#include <sq_pipeline.h>
+#include <sq_utils.h>
+
+//          1         2         3         4         5         6         7
+// 123456789012345678901234567890123456789012345678901234567890123456789012
+char *usage_text[] =
+{
+    "                                                                        ",
+    "NAME                                                                    ",
+    "  sqwaterfalls - create waterfall images for setiQuest observation      ",
+    "SYNOPSIS                                                                ",
+    "  sqwaterfalls [OPTIONS] file                                           ",
+    "OPTIONS                                                                 ",
+    "  -c real (required), observation center frequency (MHz); may be left   ",
+    "     out if the file starts with a stream header that records it        ",
+    "  -b real, bandwidth (MHz) - default value is 8.738 MHz, or the sample  ",
+    "     rate recorded in the stream header                                 ",
+    "  -n integer, number of channels - default value is 4096, or the number ",
+    "     recorded in a tiled file (see sqtfptile)                           ",
+    "  -o output directory name (required)                                   ",
+    "  -g real, gamma correction of the images - default value is 1.2        ",
+    "  -p flag, write PGM images instead of PNG images                       ",
+    "  -t integer, number of rendering threads - default is one per CPU      ",
+    "                                                                        ",
+    "  The file is read once, in bands of channels. Every offset of every    ",
+    "  usable channel gives one image, scaled as sqgetimgtfp | sqpnm -x      ",
+    "  would scale it, flipped so that time runs upwards, and written as     ",
+    "  chanCCCC/chanCCCC-OFFSET-LFREQ-RFREQ.png in the output directory.     ",
+    "EXAMPLE                                                                 ",
+    "  sqwaterfalls -c 1420.0 -o images time-frequency-power.dat             ",
+    "                                                                        "
+};
+int arrlen = sizeof(usage_text)/sizeof(*usage_text);
+
+double cfreq = 0.0;
+double bw = 0.0;
+unsigned int nchannels = 0;
+unsigned int format = SQ_IMAGE_PNG;
+float gamma_corr = 1.2;
+unsigned int nthreads = 0;
+char* imagedir = NULL;
+
+int main(int argc, char *argv[])
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "hc:b:n:o:g:pt:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(usage_text, arrlen);
+                exit(EXIT_SUCCESS);
+            case 'c':
+                sscanf(optarg, "%lf", &cfreq);
+                break;
+            case 'b':
+                sscanf(optarg, "%lf", &bw);
+                break;
+            case 'n':
+                sscanf(optarg, "%u", &nchannels);
+                break;
+            case 'o':
+                imagedir = optarg;
+                break;
+            case 'g':
+                sscanf(optarg, "%f", &gamma_corr);
+                break;
+            case 'p':
+                format = SQ_IMAGE_PGM;
+                break;
+            case 't':
+                sscanf(optarg, "%u", &nthreads);
+                break;
+            default:
+                print_usage(usage_text, arrlen);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if ((imagedir == NULL) || ((argc - optind) != 1))
+    {
+        print_usage(usage_text, arrlen);
+        exit(EXIT_FAILURE);
+    }
+
+    if (nthreads == 0)
+    {
+        long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = (ncpus > 0) ? ncpus : 1;
+    }
+
+    int status = sq_waterfalls(argv[optind], imagedir, cfreq, bw, nchannels, format, gamma_corr, nthreads);
+
+    if(status < 0)
+    {
+        fprintf(stderr, "%s encountered a fatal error.", argv[0]);
+        sq_error_handle(status);
+        print_usage(usage_text, arrlen);
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
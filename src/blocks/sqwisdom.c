@@ -0,0 +1,144 @@
+/*******************************************************************************
+
+  File:    sqwisdom.c
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+
+#ifndef __x86_64__
+#   define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sq_dsp.h>
+#include <sq_utils.h>
+
+//          1         2         3         4         5         6         7
+// 123456789012345678901234567890123456789012345678901234567890123456789012
+char *usage_text[] =
+{
+    "                                                                        ",
+    "NAME                                                                    ",
+    "  sqwisdom - measures FFT plans for the power-of-two lengths used by    ",
+    "             the blocks and saves them as FFTW wisdom, so that sqfft -W ",
+    "             and sqtfp -W start with measured plans and no delay.       ",
+    "SYNOPSIS                                                                ",
+    "  sqwisdom [OPTIONS] wisdom-file                                        ",
+    "DESCRIPTION                                                             ",
+    "  -n  integer smallest FFT length; default value is 4096                ",
+    "  -x  integer largest FFT length; default value is 8388608              ",
+    "  -t  integer number of threads the plans are made for; must match the  ",
+    "      -t given to sqfft/sqtfp. Default is 1                             ",
+    "  -b  integer number of rasters per batch; also plans the batched shape ",
+    "      for every length, for sqfft -b with the same value. Default is 1  ",
+    "  -r  also plan the real-input and real-output transforms of sqfft -r   ",
+    "      and -R (with -b, batched as well)                                 ",
+    "  -p  plan with FFTW_PATIENT instead of FFTW_MEASURE (much slower)      ",
+    "                                                                        ",
+    "  Wisdom already in the file is kept and added to. A file FFTW cannot   ",
+    "  read (e.g. made by a build with or without FFTW threads) is an error  ",
+    "  and is left unchanged.                                                ",
+    "                                                                        "
+};
+int arrlen = sizeof(usage_text)/sizeof(*usage_text);
+
+unsigned int min_len = 4096;
+unsigned int max_len = 8388608;
+unsigned int nthreads = 1;
+unsigned int batch = 1;
+unsigned char is_real = 0;
+unsigned char is_patient = 0;
+
+int main(int argc, char *argv[])
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "hn:x:t:b:rp")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(usage_text, arrlen);
+                exit(EXIT_SUCCESS);
+            case 'n':
+                sscanf(optarg, "%u", &min_len);
+                break;
+            case 'x':
+                sscanf(optarg, "%u", &max_len);
+                break;
+            case 't':
+                sscanf(optarg, "%u", &nthreads);
+                break;
+            case 'b':
+                sscanf(optarg, "%u", &batch);
+                break;
+            case 'r':
+                is_real = 1;
+                break;
+            case 'p':
+                is_patient = 1;
+                break;
+            default:
+                print_usage(usage_text, arrlen);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if (!((argc - optind) == 1))
+    {
+        print_usage(usage_text, arrlen);
+        exit(EXIT_FAILURE);
+    }
+
+    // threads first: FFTW rejects wisdom made with other solvers registered
+    int status = sq_fft_set_threads(nthreads);
+
+    // a missing file is created, but one FFTW cannot read is left alone
+    if (status == 0)
+    {
+        status = sq_fft_import_wisdom(argv[optind]);
+        if (status == ERR_STREAM_OPEN)
+            status = 0;
+        else if (status < 0)
+            fprintf(stderr, "Could not load wisdom from %s\n", argv[optind]);
+    }
+    if (status == 0)
+        status = sq_fft_plan_lengths(min_len, max_len, batch, is_real, is_patient);
+    if (status == 0)
+        status = sq_fft_export_wisdom(argv[optind]);
+
+    if(status < 0)
+    {
+        fprintf(stderr, "%s encountered a fatal error.", argv[0]);
+        sq_error_handle(status);
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
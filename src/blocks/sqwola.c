@@ -54,7 +54,7 @@ char *usage_text[] =
     "DESCRIPTION                                                             ",
     "  -l  pos. integer (required), samples length of subsequent FFT         ",
     "  -f  pos. odd integer (required), number of folds                      ",
-    "  -o  pos. integer (required), overlap percentage: 0, 25, or 50         ",
+    "  -o  pos. integer (required), overlap percentage in [0, 100)           ",
     "  -w  flag, dump window coefficients to stdout and then exit            ",
     "                                                                        "
 };
@@ -0,0 +1,155 @@
+/*******************************************************************************
+
+  File:    sqxcorr.c
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+#ifndef __x86_64__
+#   define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sq_dsp.h>
+#include <sq_pipeline.h>
+#include <sq_utils.h>
+
+//          1         2         3         4         5         6         7
+// 123456789012345678901234567890123456789012345678901234567890123456789012
+char *usage_text[] =
+{
+    "                                                                        ",
+    "NAME                                                                    ",
+    "  sqxcorr - cross-correlates (or convolves) two signal files in one     ",
+    "            process.  Each file is 2-channel 8-bit data, as read by     ",
+    "            sqsample; the output is one raster of complex floats per    ",
+    "            transform, as sqcrosscorr.sh writes it.  With -n, it is an  ",
+    "            FX correlator of any number of files instead.               ",
+    "SYNOPSIS                                                                ",
+    "  sqxcorr [OPTIONS] file1 file2                                         ",
+    "  sqxcorr -n integer [OPTIONS] file1 file2 ... fileN                    ",
+    "OPTIONS                                                                 ",
+    "  -l integer (required), FFT length                                     ",
+    "  -w window type [wola, hann, ...]; default is hann                     ",
+    "  -f integer, number of WOLA folds - default value is 9                 ",
+    "  -v flag, convolve instead of correlating (sqconvolution.sh)           ",
+    "  -m flag, measure the FFT plans instead of estimating them             ",
+    "  -b integer, number of rasters transformed at a time - default is as   ",
+    "     many as fit in 65536 samples                                       ",
+    "  -n integer, FX correlator: number of spectra summed into one          ",
+    "     integration.  Every file is transformed once, and for every pair   ",
+    "     i <= j (autocorrelations included) the spectra of file i times the ",
+    "     conjugate spectra of file j are summed, as sqcrossmultiply | sqsum ",
+    "     -n would sum them.  One visibility matrix is written per           ",
+    "     integration: the baselines (1,1), (1,2), ... (1,N), (2,2), ...     ",
+    "     (N,N) in turn, each a raster of FFT length complex floats in the   ",
+    "     channel order of sqfft.                                            ",
+    "                                                                        ",
+    "  Without -n, the two files are read and transformed by two threads.    ",
+    "  Any file may be - for stdin.  Output stops at the end of the shortest ",
+    "  file.                                                                 ",
+    "EXAMPLE                                                                 ",
+    "  sqxcorr -l 4096 -w wola signal1.dat signal2.dat > xcorr.dat           ",
+    "  sqxcorr -l 1024 -n 256 ant1.dat ant2.dat ant3.dat ant4.dat > vis.dat  ",
+    "                                                                        "
+};
+int arrlen = sizeof(usage_text)/sizeof(*usage_text);
+
+unsigned int fft_len = 0;
+char* window_name = "hann";
+unsigned int folds = 9;
+unsigned char is_convolution = 0;
+unsigned char is_measured = 0;
+unsigned int batch = 0;
+unsigned int num_to_sum = 0;
+
+int main(int argc, char *argv[])
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "hl:w:f:vmb:n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(usage_text, arrlen);
+                exit(EXIT_SUCCESS);
+            case 'l':
+                sscanf(optarg, "%u", &fft_len);
+                break;
+            case 'w':
+                window_name = optarg;
+                break;
+            case 'f':
+                sscanf(optarg, "%u", &folds);
+                break;
+            case 'v':
+                is_convolution = 1;
+                break;
+            case 'm':
+                is_measured = 1;
+                break;
+            case 'b':
+                sscanf(optarg, "%u", &batch);
+                break;
+            case 'n':
+                sscanf(optarg, "%u", &num_to_sum);
+                break;
+            default:
+                print_usage(usage_text, arrlen);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if ((fft_len == 0) || ((argc - optind) < 2) || ((num_to_sum == 0) && ((argc - optind) != 2)))
+    {
+        print_usage(usage_text, arrlen);
+        exit(EXIT_FAILURE);
+    }
+
+    if (batch == 0)
+        batch = (fft_len < 65536) ? (65536 / fft_len) : 1;
+
+    int status;
+    if (num_to_sum > 0)
+        status = sq_fxcorr(&argv[optind], argc - optind, stdout, fft_len, batch,
+                           window_name, folds, num_to_sum, is_measured);
+    else
+        status = sq_xcorr(argv[optind], argv[optind + 1], stdout, fft_len, batch,
+                          window_name, folds, is_convolution, is_measured);
+
+    if(status < 0)
+    {
+        fprintf(stderr, "%s encountered a fatal error.", argv[0]);
+        sq_error_handle(status);
+        print_usage(usage_text, arrlen);
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
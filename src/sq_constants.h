@@ -48,6 +48,7 @@ typedef unsigned int boolean;
 #define ERR_MALLOC -6
 #define ERR_UNKNOWN_OPTION -7
 #define ERR_UNKNOWN_WINDOW -8
+#define ERR_BAD_FORMAT -9
 
 // Some constants
 #define MAX_SMPLS_LEN 134217728
@@ -58,6 +59,8 @@ typedef unsigned int boolean;
 #define MAX_ZOOM_LEN 134217728
 #define ZOOM_OUTPUT_BFR_LEN 1024
 #define STD_THRESH 4
+#define PROGRESS_INTERVAL_MS 1000
+#define SQ_INPUT_RELEASE_BYTES 67108864
 
 // Math constants
 #define PI 3.1415926535897932384626433832795
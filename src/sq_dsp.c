@@ -37,13 +37,47 @@
 
 #include "sq_constants.h"
 #include "sq_dsp.h"
+#include "sq_simd.h"
 #include "sq_utils.h"
 #include "sq_windows.h"
 
+// samples of an oscillator generated from each sin/cos (see sq_mix_buf)
+#define NCO_BLOCK 1024
+
+// Like sq_header_pass, for stages that have a real and a complex form and
+// write the same sample type they read: if there is a header, it picks the
+// form, whatever the caller asked for.
+static int pass_header_either(sq_input* input, FILE* outstream, unsigned char* is_real,
+                              unsigned int in_length, unsigned int out_length,
+                              unsigned char is_rastering)
+{
+    sq_stream_header header;
+
+    int status = sq_input_header(input, &header);
+    if (status <= 0)
+        return status;
+
+    *is_real = (header.sample_type == SQ_SAMPLE_REAL);
+    status = sq_header_check(&header, header.sample_type, in_length);
+    if (status < 0)
+        return status;
+
+    header.raster_length = out_length;
+    if (is_rastering)
+        header.flags |= SQ_STREAM_RASTERED;
+
+    status = sq_header_write(outstream, &header);
+    if (status < 0)
+        return status;
+
+    return 1;
+}
+
 int sq_abs(FILE* instream, FILE* outstream, unsigned int in_length)
 {
-    float *in_buffer;
-    unsigned int smpli;
+    sq_input input;
+    const cmplx *in_buffer;
+    cmplx *out_buffer;
 
     if ((in_length < 2) || (in_length >= MAX_SMPLS_LEN))
     {
@@ -51,31 +85,28 @@ int sq_abs(FILE* instream, FILE* outstream, unsigned int in_length)
         return ERR_ARG_BOUNDS;
     }
 
-    in_buffer = malloc(in_length * sizeof(cmplx));
-    if (in_buffer == NULL) return ERR_MALLOC;
+    out_buffer = malloc(in_length * sizeof(cmplx));
+    if (out_buffer == NULL) return ERR_MALLOC;
 
-    while (fread(in_buffer, sizeof(cmplx), in_length, instream) == in_length)
+    sq_input_open(&input, instream);
+    int status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_COMPLEX, in_length, 0);
+    while ((status >= 0) && (sq_input_view(&input, (const void**) &in_buffer, sizeof(cmplx), in_length) == in_length))
     {
-        for (smpli = 0; smpli < in_length ; smpli++)
-        {
-            in_buffer[(smpli<<1)+0] =
-                sqrt(  (in_buffer[(smpli<<1)+0] * in_buffer[(smpli<<1)+0]) +
-                       (in_buffer[(smpli<<1)+1] * in_buffer[(smpli<<1)+1])   );
-            in_buffer[(smpli<<1)+1] = 0.0;
-        }
-
-        fwrite(in_buffer, sizeof(cmplx), in_length, outstream);
+        sq_abs_cmplx_buf(in_buffer, out_buffer, in_length);
+        fwrite(out_buffer, sizeof(cmplx), in_length, outstream);
     }
+    sq_input_close(&input);
 
-    free(in_buffer);
+    free(out_buffer);
 
-    return 0;
+    return (status < 0) ? status : 0;
 }
 
 int sq_power(FILE* instream, FILE* outstream, unsigned int in_length)
 {
-    float *in_buffer;
-    unsigned int smpli;
+    sq_input input;
+    const cmplx *in_buffer;
+    cmplx *out_buffer;
 
     if ((in_length < 2) || (in_length >= MAX_SMPLS_LEN))
     {
@@ -83,33 +114,29 @@ int sq_power(FILE* instream, FILE* outstream, unsigned int in_length)
         return ERR_ARG_BOUNDS;
     }
 
-    in_buffer = malloc(in_length * sizeof(cmplx));
-    if (in_buffer == NULL) return ERR_MALLOC;
+    out_buffer = malloc(in_length * sizeof(cmplx));
+    if (out_buffer == NULL) return ERR_MALLOC;
 
-    while (fread(in_buffer, sizeof(cmplx), in_length, instream) == in_length)
+    sq_input_open(&input, instream);
+    int status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_COMPLEX, in_length, 0);
+    while ((status >= 0) && (sq_input_view(&input, (const void**) &in_buffer, sizeof(cmplx), in_length) == in_length))
     {
-        for (smpli = 0; smpli < in_length ; smpli++)
-        {
-            in_buffer[(smpli<<1)+0] =
-                (in_buffer[(smpli<<1)+0] * in_buffer[(smpli<<1)+0]) +
-                (in_buffer[(smpli<<1)+1] * in_buffer[(smpli<<1)+1]);
-            in_buffer[(smpli<<1)+1] = 0.0;
-        }
-
-        fwrite(in_buffer, sizeof(cmplx), in_length, outstream);
+        sq_power_cmplx_buf(in_buffer, out_buffer, in_length);
+        fwrite(out_buffer, sizeof(cmplx), in_length, outstream);
     }
+    sq_input_close(&input);
 
-    free(in_buffer);
+    free(out_buffer);
 
-    return 0;
+    return (status < 0) ? status : 0;
 }
 
 int sq_crossmultiply(FILE* instream1, FILE* instream2, FILE* outstream, unsigned int in_length) 
 {
-    float *bfr1, *bfr2;
-    float real = 0, imag = 0;
-    unsigned int smpli;
-    unsigned int buf_count = 0;
+    sq_input input1, input2;
+    sq_stream_header header2;
+    const cmplx *bfr1, *bfr2;
+    cmplx *out_bfr;
 
     if ((in_length < 2) || (in_length >= MAX_SMPLS_LEN))
     {
@@ -117,114 +144,181 @@ int sq_crossmultiply(FILE* instream1, FILE* instream2, FILE* outstream, unsigned
         return ERR_ARG_BOUNDS;
     }
 
-    bfr1 = malloc(in_length * sizeof(cmplx));
-    if (bfr1 == NULL) return ERR_MALLOC;
+    out_bfr = malloc(in_length * sizeof(cmplx));
+    if (out_bfr == NULL) return ERR_MALLOC;
+
+    sq_input_open(&input1, instream1);
+    sq_input_open(&input2, instream2);
 
-    bfr2 = malloc(in_length * sizeof(cmplx));
-    if (bfr2 == NULL) return ERR_MALLOC;
+    // the header of the first signal is passed on; the second one only
+    // has to agree with it
+    int status = sq_header_pass(&input1, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_COMPLEX, in_length, 0);
+    if ((status >= 0) && (sq_input_header(&input2, &header2) > 0))
+        status = sq_header_check(&header2, SQ_SAMPLE_COMPLEX, in_length);
 
     while (
-        (fread(bfr1, sizeof(cmplx), in_length, instream1) == in_length) &&
-        (fread(bfr2, sizeof(cmplx), in_length, instream2) == in_length)
+        (status >= 0) &&
+        (sq_input_view(&input1, (const void**) &bfr1, sizeof(cmplx), in_length) == in_length) &&
+        (sq_input_view(&input2, (const void**) &bfr2, sizeof(cmplx), in_length) == in_length)
     )
     {
-        ++buf_count;
+        sq_crossmultiply_buf(bfr1, bfr2, out_bfr, in_length);
 
-        for (smpli = 0; smpli < in_length; smpli++)
-        {
-            real =
-                (bfr1[(smpli<<1)+0]*bfr2[(smpli<<1)+0]) -
-                (bfr1[(smpli<<1)+1]*bfr2[(smpli<<1)+1]);
+        fwrite(out_bfr, sizeof(cmplx), in_length, outstream);
+    }
+    sq_input_close(&input1);
+    sq_input_close(&input2);
 
-            imag =
-                (bfr1[(smpli<<1)+0]*bfr2[(smpli<<1)+1]) +
-                (bfr2[(smpli<<1)+1]*bfr1[(smpli<<1)+0]);
+    free(out_bfr);
 
-            // re-use a buffer to save memory
-            bfr1[(smpli<<1)+0] = real;
-            bfr1[(smpli<<1)+1] = imag;
-        }
+    return (status < 0) ? status : 0;
+}
 
-        fwrite(bfr1, sizeof(cmplx), in_length, outstream);
+// converts the double sums to floats and writes them
+static int sum_write(const double* sum_bfr, float* out_bfr, unsigned int nvals, FILE* outstream)
+{
+    unsigned int vali;
 
-//        if (buf_count%10000 == 1) fprintf(stderr, "Cross multiply completed cycle %i\n", buf_count);
-    }
+    for (vali = 0; vali < nvals; vali++)
+        out_bfr[vali] = (float) sum_bfr[vali];
 
-    free(bfr1);
-    free(bfr2);
+    if (fwrite(out_bfr, sizeof(float), nvals, outstream) != nvals)
+        return ERR_STREAM_WRITE;
 
     return 0;
 }
 
-int sq_sum(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int num_to_sum)
+// sq_sum, sq_sum_real and sq_integrate; is_real selects the stream format
+static int sum_stream(FILE* instream, FILE* outstream, unsigned int in_length,
+                      unsigned int num_to_sum, unsigned int mode, unsigned int flags,
+                      unsigned char is_real)
 {
     if (!((in_length >= 2) && (in_length <= MAX_SMPLS_LEN)))
     {
         fprintf(stderr, "Array lengths must be between 2 and %u\n", MAX_SMPLS_LEN);
         return ERR_ARG_BOUNDS;
     }
+    if (num_to_sum < 1)
+    {
+        sq_error_print("At least 1 raster must be summed.\n");
+        return ERR_ARG_BOUNDS;
+    }
 
-    float *in_buffer;
-    float *sum_bfr;
-    unsigned int rasteri;
-    unsigned int smpli;
-    unsigned int raster_count;
-    int first_time = 1;
-    int schedule_shutdown = 0;
+    sq_input input;
+    const void *in_buffer;
+    double *sum_bfr;
+    double *comp_bfr = NULL;
+    float *out_bfr;
+    float *ring_bfr = NULL;
+    float *slot;
+    size_t smpl_size;
+    unsigned int nvals;
+    unsigned int nsummed = 0;
+    uint64_t rasteri = 0;
+    unsigned char is_written = 0;
+    // a leaky sum with this decay settles at num_to_sum times the mean
+    double decay = 1.0 - (1.0 / num_to_sum);
+
+    sq_input_open(&input, instream);
+    int status = pass_header_either(&input, outstream, &is_real, in_length, in_length, 1);
+    if (status < 0)
+    {
+        sq_input_close(&input);
+        return status;
+    }
 
-    in_buffer = malloc(in_length * sizeof(cmplx));
-    if (in_buffer == NULL) return ERR_MALLOC;
+    // the kernels work on the floats of a raster, whatever the sample type
+    smpl_size = is_real ? sizeof(float) : sizeof(cmplx);
+    nvals = is_real ? in_length : (in_length * 2);
 
-    sum_bfr = malloc(in_length * sizeof(cmplx));
+    sum_bfr = calloc(nvals, sizeof(double));
     if (sum_bfr == NULL) return ERR_MALLOC;
+    out_bfr = malloc(nvals * sizeof(float));
+    if (out_bfr == NULL) return ERR_MALLOC;
 
-    for (;;) // loop until break
+    if ((flags & SQ_SUM_KAHAN) && (mode != SQ_SUM_EMA))
     {
-        raster_count = 0;
+        comp_bfr = calloc(nvals, sizeof(double));
+        if (comp_bfr == NULL) return ERR_MALLOC;
+    }
 
-        // zero the array containing sum
-        for (smpli = 0; smpli < in_length; ++smpli)
-        {
-            sum_bfr[(smpli<<1)+0] = 0.0;
-            sum_bfr[(smpli<<1)+1] = 0.0;
-        }
+    // the boxcar keeps its window of rasters, to take the oldest one back out
+    if (mode == SQ_SUM_BOXCAR)
+    {
+        ring_bfr = malloc((size_t) num_to_sum * nvals * sizeof(float));
+        if (ring_bfr == NULL) return ERR_MALLOC;
+    }
 
-        for (rasteri = 0; rasteri < num_to_sum; ++rasteri)
+    status = 0;
+    while ((status >= 0) && (sq_input_view(&input, &in_buffer, smpl_size, in_length) == in_length))
+    {
+        switch (mode)
         {
-            // read a new raster line of data
-            if (fread(in_buffer, sizeof(cmplx), in_length, instream) == in_length)
-            {
-                ++raster_count;
-
-                // sum this raster with previous
-                for (smpli = 0; smpli < in_length; smpli++)
+            case SQ_SUM_EMA:
+                sq_leaky_accumulate_buf(in_buffer, sum_bfr, nvals, decay);
+                status = sum_write(sum_bfr, out_bfr, nvals, outstream);
+                is_written = 1;
+                break;
+
+            case SQ_SUM_BOXCAR:
+                slot = &ring_bfr[(size_t) (rasteri % num_to_sum) * nvals];
+                if (rasteri >= num_to_sum)
+                    sq_accumulate_buf(slot, sum_bfr, comp_bfr, nvals, -1.0);
+                sq_accumulate_buf(in_buffer, sum_bfr, comp_bfr, nvals, 1.0);
+                memcpy(slot, in_buffer, nvals * sizeof(float));
+
+                if (rasteri + 1 >= num_to_sum)
                 {
-                    sum_bfr[(smpli<<1)+0] += in_buffer[(smpli<<1)+0];
-                    sum_bfr[(smpli<<1)+1] += in_buffer[(smpli<<1)+1];
+                    status = sum_write(sum_bfr, out_bfr, nvals, outstream);
+                    is_written = 1;
                 }
-            }
-            else
-            {
-                // we are out of data, get ready to shut down
-                schedule_shutdown = 1;
-            }
-        }
+                break;
 
-        // if there is only one output raster, send it no matter what
-        // if there have been other output rasters before, don't send unless
-        // this one is complete
-        if (first_time || raster_count == num_to_sum)
-            fwrite(sum_bfr, sizeof(cmplx), in_length, outstream);
-        first_time = 0;
+            default:
+                sq_accumulate_buf(in_buffer, sum_bfr, comp_bfr, nvals, 1.0);
+                if (++nsummed == num_to_sum)
+                {
+                    status = sum_write(sum_bfr, out_bfr, nvals, outstream);
+                    is_written = 1;
 
-        // if we are out of data, then break
-        if (schedule_shutdown) break;
+                    nsummed = 0;
+                    memset(sum_bfr, 0, nvals * sizeof(double));
+                    if (comp_bfr != NULL)
+                        memset(comp_bfr, 0, nvals * sizeof(double));
+                }
+                break;
+        }
+        rasteri++;
     }
 
+    // if there is only one output raster, send it no matter what; a short
+    // last block is only sent after others if asked for
+    if ((status >= 0) && (!is_written || ((nsummed > 0) && (flags & SQ_SUM_PARTIAL))))
+        status = sum_write(sum_bfr, out_bfr, nvals, outstream);
+
+    sq_input_close(&input);
     free(sum_bfr);
-    free(in_buffer);
+    free(comp_bfr);
+    free(out_bfr);
+    free(ring_bfr);
 
-    return 0;
+    return (status < 0) ? status : 0;
+}
+
+int sq_sum(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int num_to_sum)
+{
+    return sum_stream(instream, outstream, in_length, num_to_sum, SQ_SUM_BLOCK, 0, 0);
+}
+
+int sq_sum_real(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int num_to_sum)
+{
+    return sum_stream(instream, outstream, in_length, num_to_sum, SQ_SUM_BLOCK, 0, 1);
+}
+
+int sq_integrate(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int num_to_sum,
+                 unsigned int mode, unsigned int flags, unsigned char is_real)
+{
+    return sum_stream(instream, outstream, in_length, num_to_sum, mode, flags, is_real);
 }
 
 int sq_bandpass( FILE* instream, FILE* outstream, unsigned int in_length, char bp_file[])
@@ -289,8 +383,10 @@ return -1;
 // NOTE: This function does NOT do overlaps!
 int sq_window( FILE* instream, FILE* outstream, unsigned int in_length, char* window_name)
 {
+    sq_input input;
     float *wndw_bfr;
-    float *in_buffer;
+    const cmplx *in_buffer;
+    cmplx *out_buffer;
 
     if (!((in_length >= 2) && (in_length <= MAX_WNDW_LEN)))
     {
@@ -301,30 +397,27 @@ int sq_window( FILE* instream, FILE* outstream, unsigned int in_length, char* wi
     wndw_bfr = malloc(in_length * sizeof(float));
     if (wndw_bfr == NULL) return ERR_MALLOC;
 
-    in_buffer = malloc(in_length * sizeof(cmplx));
-    if (in_buffer == NULL) return ERR_MALLOC;
+    out_buffer = malloc(in_length * sizeof(cmplx));
+    if (out_buffer == NULL) return ERR_MALLOC;
 
     // Make window 
     int status = sq_make_window_from_name(wndw_bfr, in_length, window_name);
     if (status < 0)
         return status;
 
-    unsigned int bfri;
-    // remember that in_buffer is declared as floats, but read as complex
-    while (fread(in_buffer, sizeof(cmplx), in_length, instream) == in_length)
+    sq_input_open(&input, instream);
+    status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_COMPLEX, in_length, 1);
+    while ((status >= 0) && (sq_input_view(&input, (const void**) &in_buffer, sizeof(cmplx), in_length) == in_length))
     {
-        for (bfri = 0; bfri < in_length; bfri++)
-        {
-            in_buffer[(bfri<<1)+0] *= wndw_bfr[bfri];
-            in_buffer[(bfri<<1)+1] *= wndw_bfr[bfri];
-        }
-        fwrite(in_buffer, sizeof(cmplx), in_length, outstream);
+        sq_window_buf(wndw_bfr, in_buffer, out_buffer, in_length);
+        fwrite(out_buffer, sizeof(cmplx), in_length, outstream);
     }
+    sq_input_close(&input);
 
     free(wndw_bfr);
-    free(in_buffer);
+    free(out_buffer);
 
-    return 0;
+    return (status < 0) ? status : 0;
 }
 
 int sq_component(FILE* instream, FILE* outstream, unsigned int in_length, int component)
@@ -340,27 +433,25 @@ int sq_component(FILE* instream, FILE* outstream, unsigned int in_length, int co
         return ERR_ARG_BOUNDS;
     }
 
-    int i;
-    cmplx *in_buffer;
+    sq_input input;
+    const cmplx *in_buffer;
     float *out_buffer;
 
-    in_buffer = malloc(in_length * sizeof(cmplx));
-    if (in_buffer == NULL) return ERR_MALLOC;
-
     out_buffer = malloc(in_length * sizeof(float));
     if (out_buffer == NULL) return ERR_MALLOC;
 
-    while (fread(in_buffer, sizeof(cmplx), in_length, instream) == in_length)
+    sq_input_open(&input, instream);
+    int status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_REAL, in_length, 0);
+    while ((status >= 0) && (sq_input_view(&input, (const void**) &in_buffer, sizeof(cmplx), in_length) == in_length))
     {
-        for (i = 0; i < in_length; i++)
-            out_buffer[i] = in_buffer[i][component];
+        sq_component_buf(in_buffer, out_buffer, in_length, component);
         fwrite(out_buffer, sizeof(float), in_length, outstream);
     }
+    sq_input_close(&input);
 
     free(out_buffer);
-    free(in_buffer);
 
-    return 0;
+    return (status < 0) ? status : 0;
 }
 
 int sq_real(FILE* instream, FILE* outstream, unsigned int in_length)
@@ -377,68 +468,106 @@ int sq_fft(FILE* instream, FILE* outstream, unsigned int in_length,
            unsigned char is_conjugated, unsigned char is_measured,
            unsigned char inverse)
 {
-    if (!((in_length >= 2) && (in_length <= MAX_SMPLS_LEN)))
-    {
-        fprintf(stderr, "Array lengths must be between 2 and %u\n", MAX_SMPLS_LEN);
-        return ERR_ARG_BOUNDS;
-    }
-
-    fftwf_complex *fft_bfr;
-    fftwf_plan plan;
+    return sq_fft_batch(instream, outstream, in_length, is_conjugated, is_measured, inverse, 1, 1);
+}
 
-    int i;
+// sq_fft_batch and sq_fft_real; a header saying the input is real selects
+// the real-input transform
+static int fft_stream(FILE* instream, FILE* outstream, unsigned int in_length,
+                      unsigned char is_conjugated, unsigned char is_measured,
+                      unsigned char inverse, unsigned char real_mode,
+                      unsigned int nthreads, unsigned int batch)
+{
+    sq_fft_state fft;
+    sq_input input;
+    sq_stream_header header;
+    size_t nrasters;
 
-    fft_bfr = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * in_length);
+    int status = sq_fft_set_threads(nthreads);
+    if (status < 0)
+        return status;
 
-    plan = fftwf_plan_dft_1d(in_length,
-                             (fft_bfr),
-                             (fft_bfr),
-                             (inverse ? FFTW_BACKWARD : FFTW_FORWARD),
-                             (is_measured ? FFTW_MEASURE : FFTW_ESTIMATE));
+    sq_input_open(&input, instream);
+    status = sq_input_header(&input, &header);
+    if (status > 0)
+    {
+        if ((header.sample_type == SQ_SAMPLE_REAL) && (real_mode == 0))
+            real_mode = SQ_FFT_REAL_INPUT;
+        status = sq_header_check(&header, (real_mode == SQ_FFT_REAL_INPUT) ? SQ_SAMPLE_REAL : SQ_SAMPLE_COMPLEX,
+                                 in_length);
+        header.sample_type = (real_mode == SQ_FFT_REAL_OUTPUT) ? SQ_SAMPLE_REAL : SQ_SAMPLE_COMPLEX;
+        header.raster_length = in_length;
+        header.flags |= SQ_STREAM_RASTERED;
+        if (status == 0)
+            status = sq_header_write(outstream, &header);
+    }
+    if (status < 0)
+    {
+        sq_input_close(&input);
+        return status;
+    }
 
-    while (fread(fft_bfr, sizeof(fftwf_complex), in_length, instream) == in_length)
+    if (real_mode)
+        status = sq_fft_init_real(&fft, in_length, batch, is_measured, inverse, real_mode);
+    else
+        status = sq_fft_init_many(&fft, in_length, batch, is_conjugated, is_measured, inverse);
+    if (status < 0)
     {
-        if (is_conjugated)
-            for (i = 0; i < in_length; i++)
-                fft_bfr[i][1] = -fft_bfr[i][1];  // conjugate
+        sq_input_close(&input);
+        return status;
+    }
 
-        if (inverse)
+    // a short read at the end of the stream still transforms the whole
+    // batch, but only the complete rasters that were read are written.
+    // The plan is bound to fft.bfr (fft.realbfr for real input), so the
+    // input is copied in.
+    if (real_mode == SQ_FFT_REAL_INPUT)
+    {
+        while ((nrasters = sq_input_read(&input, fft.realbfr, sizeof(float) * in_length, batch)) > 0)
         {
-            // move channels back to their original positions before the fft
-            // so  that ifft gets what it expects
-            sq_channelswap(fft_bfr, in_length);
-
-            // perform ifft
-            fftwf_execute(plan);
-
-            // fft (effectively) multiples output by N, so take this out
-            float norm = 1.0f / in_length; // multiplies are faster than divides
-            for (i = 0; i < in_length; i++)
-            {
-                fft_bfr[i][0] = fft_bfr[i][0] * norm;
-                fft_bfr[i][1] = fft_bfr[i][1] * norm;
-            }
+            sq_fft_buf(&fft);
+            fwrite(&fft.bfr[0], sizeof(fftwf_complex) * in_length, nrasters, outstream);
+            if (nrasters < batch)
+                break;
         }
-        else
+    }
+    else
+    {
+        while ((nrasters = sq_input_read(&input, fft.bfr, sizeof(fftwf_complex) * in_length, batch)) > 0)
         {
-            // perform fft
-            fftwf_execute(plan);
-
-            // write negative channels on the left, and then positive channels on the right
-            sq_channelswap(fft_bfr, in_length);
+            sq_fft_buf(&fft);
+            if (real_mode == SQ_FFT_REAL_OUTPUT)
+                fwrite(fft.realbfr, sizeof(float) * in_length, nrasters, outstream);
+            else
+                fwrite(&fft.bfr[0], sizeof(fftwf_complex) * in_length, nrasters, outstream);
+            if (nrasters < batch)
+                break;
         }
-
-        fwrite(&fft_bfr[0], sizeof(fftwf_complex), in_length , outstream);
     }
+    sq_input_close(&input);
 
-    fftwf_destroy_plan(plan);
-    fftwf_free(fft_bfr);
-
+    sq_fft_free(&fft);
 
     return 0;
 }
 
-int sq_offset(FILE* instream, FILE* outstream, unsigned int in_length, float real_delta, float imag_delta)
+int sq_fft_batch(FILE* instream, FILE* outstream, unsigned int in_length,
+                 unsigned char is_conjugated, unsigned char is_measured,
+                 unsigned char inverse, unsigned int nthreads, unsigned int batch)
+{
+    return fft_stream(instream, outstream, in_length, is_conjugated, is_measured, inverse, 0, nthreads, batch);
+}
+
+int sq_fft_real(FILE* instream, FILE* outstream, unsigned int in_length,
+                unsigned char is_measured, unsigned char inverse, unsigned char real_mode,
+                unsigned int nthreads, unsigned int batch)
+{
+    return fft_stream(instream, outstream, in_length, 0, is_measured, inverse, real_mode, nthreads, batch);
+}
+
+// sq_offset and sq_offset_real; is_real selects the stream format
+static int offset_stream(FILE* instream, FILE* outstream, unsigned int in_length,
+                         float real_delta, float imag_delta, unsigned char is_real)
 {
     if (!((in_length >= 2) && (in_length <= MAX_SMPLS_LEN)))
     {
@@ -446,29 +575,46 @@ int sq_offset(FILE* instream, FILE* outstream, unsigned int in_length, float rea
         return ERR_ARG_BOUNDS;
     }
 
-    unsigned int smpli;
-    float *in_buffer;
-
-    in_buffer = malloc(in_length * sizeof(cmplx));
-    if (in_buffer == NULL) return ERR_MALLOC;
+    sq_input input;
+    const void *in_buffer;
+    void *out_buffer;
+    size_t smpl_size;
 
-    while (fread(in_buffer, 8, in_length, instream) == in_length)
+    sq_input_open(&input, instream);
+    int status = pass_header_either(&input, outstream, &is_real, in_length, in_length, 0);
+    if (status < 0)
     {
-        for (smpli = 0; smpli < in_length; smpli++)
-        {
-            in_buffer[(smpli<<1)+0] += real_delta;
-            in_buffer[(smpli<<1)+1] += imag_delta;
-        }
+        sq_input_close(&input);
+        return status;
+    }
+
+    smpl_size = is_real ? sizeof(float) : sizeof(cmplx);
+    out_buffer = malloc(in_length * smpl_size);
+    if (out_buffer == NULL) return ERR_MALLOC;
 
-        fwrite(in_buffer, 8, in_length, outstream);
+    while (sq_input_view(&input, &in_buffer, smpl_size, in_length) == in_length)
+    {
+        if (is_real)
+            sq_offset_real_buf(in_buffer, out_buffer, in_length, real_delta);
+        else
+            sq_offset_buf(in_buffer, out_buffer, in_length, real_delta, imag_delta);
+        fwrite(out_buffer, smpl_size, in_length, outstream);
     }
+    sq_input_close(&input);
 
-    free(in_buffer);
+    free(out_buffer);
 
     return 0;
 }
 
-int sq_subavg(FILE* instream, FILE* outstream, unsigned int in_length)
+int sq_offset(FILE* instream, FILE* outstream, unsigned int in_length, float real_delta, float imag_delta)
+{
+    return offset_stream(instream, outstream, in_length, real_delta, imag_delta, 0);
+}
+
+// sq_subavg and sq_subavg_real; is_real selects the stream format
+static int subavg_stream(FILE* instream, FILE* outstream, unsigned int in_length,
+                         unsigned char is_real)
 {
     if (!((in_length >= 2) && (in_length <= MAX_SMPLS_LEN)))
     {
@@ -476,41 +622,44 @@ int sq_subavg(FILE* instream, FILE* outstream, unsigned int in_length)
         return ERR_ARG_BOUNDS;
     }
 
-    float *in_buffer;
-    unsigned int smpli;
-
-    in_buffer = malloc(in_length * sizeof(cmplx));
-    if (in_buffer == NULL) return ERR_MALLOC;
+    sq_input input;
+    const void *in_buffer;
+    void *out_buffer;
+    size_t smpl_size;
 
-    while (fread(in_buffer, 8, in_length, instream) == in_length)
+    sq_input_open(&input, instream);
+    int status = pass_header_either(&input, outstream, &is_real, in_length, in_length, 1);
+    if (status < 0)
     {
-        // compute average value
-        double sumr = 0;
-        double sumi = 0;
-        for (smpli = 0; smpli < in_length; smpli += 1)
-        {
-            sumr += in_buffer[(smpli<<1)+0];
-            sumi += in_buffer[(smpli<<1)+1];
-        }
-        float favgr = (float)(sumr/in_length);
-        float favgi = (float)(sumi/in_length);
+        sq_input_close(&input);
+        return status;
+    }
 
-        // subtract it off
-        for (smpli = 0; smpli < in_length; smpli += 1)
-        {
-            in_buffer[(smpli<<1)+0] -= favgr;
-            in_buffer[(smpli<<1)+1] -= favgi;
-        }
+    smpl_size = is_real ? sizeof(float) : sizeof(cmplx);
+    out_buffer = malloc(in_length * smpl_size);
+    if (out_buffer == NULL) return ERR_MALLOC;
 
-        fwrite(in_buffer, sizeof(cmplx), in_length, outstream);
+    while (sq_input_view(&input, &in_buffer, smpl_size, in_length) == in_length)
+    {
+        if (is_real)
+            sq_subavg_real_buf(in_buffer, out_buffer, in_length);
+        else
+            sq_subavg_buf(in_buffer, out_buffer, in_length);
+        fwrite(out_buffer, smpl_size, in_length, outstream);
     }
+    sq_input_close(&input);
 
-    free(in_buffer);
+    free(out_buffer);
 
     return 0;
 }
 
-int sq_conjugate(FILE* instream, FILE* outstream, unsigned int in_length)
+int sq_subavg(FILE* instream, FILE* outstream, unsigned int in_length)
+{
+    return subavg_stream(instream, outstream, in_length, 0);
+}
+
+int sq_affine(FILE* instream, FILE* outstream, unsigned int in_length, const sq_affine_state* state)
 {
     if (!((in_length >= 2) && (in_length <= MAX_SMPLS_LEN)))
     {
@@ -518,56 +667,41 @@ int sq_conjugate(FILE* instream, FILE* outstream, unsigned int in_length)
         return ERR_ARG_BOUNDS;
     }
 
-    float *in_buffer;
-    unsigned int smpli;
+    sq_input input;
+    const cmplx *in_buffer;
+    cmplx *out_buffer;
 
-    in_buffer = malloc(in_length * sizeof(cmplx));
-    if (in_buffer == NULL) return ERR_MALLOC;
+    out_buffer = malloc(in_length * sizeof(cmplx));
+    if (out_buffer == NULL) return ERR_MALLOC;
 
-    while (fread(in_buffer, 8, in_length, instream) == in_length)
+    sq_input_open(&input, instream);
+    int status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_COMPLEX, in_length, 0);
+    while ((status >= 0) && (sq_input_view(&input, (const void**) &in_buffer, sizeof(cmplx), in_length) == in_length))
     {
-        for (smpli = 0; smpli < in_length; smpli += 1)
-            in_buffer[(smpli<<1)+1] *= -1.0;
-
-        fwrite(in_buffer, sizeof(cmplx), in_length, outstream);
+        sq_affine_buf(state, in_buffer, out_buffer, in_length);
+        fwrite(out_buffer, sizeof(cmplx), in_length, outstream);
     }
+    sq_input_close(&input);
 
-    free(in_buffer);
+    free(out_buffer);
 
-    return 0;
+    return (status < 0) ? status : 0;
 }
 
-int sq_scaleandrotate(FILE* instream, FILE* outstream, unsigned int in_length, float scale_factor, float radians)
+int sq_conjugate(FILE* instream, FILE* outstream, unsigned int in_length)
 {
-    if (in_length <= 0)
-    {
-        fprintf(stderr, "Array lengths must be between 2 and %u\n", MAX_SMPLS_LEN);
-        return ERR_ARG_BOUNDS;
-    }
-
-    unsigned int smpli;
-    float *in_buffer;
-
-    in_buffer = malloc(in_length * sizeof(cmplx));
-    if (in_buffer == NULL) return ERR_MALLOC;
-
-    float re, im;
-    while (fread(in_buffer, 8, in_length, instream) == in_length)
-    {
-        for (smpli = 0; smpli < in_length; smpli++)
-        {
-            re = in_buffer[(smpli<<1)+0];
-            im = in_buffer[(smpli<<1)+1];
-            in_buffer[(smpli<<1)+0] = scale_factor * (re * cos(radians) - im * sin(radians));
-            in_buffer[(smpli<<1)+1] = scale_factor * (im * cos(radians) + re * sin(radians));
-        }
+    sq_affine_state state;
 
-        fwrite(in_buffer, 8, in_length, outstream);
-    }
+    sq_affine_init(&state, 1.0, 0.0, 0.0, 0.0, 1);
+    return sq_affine(instream, outstream, in_length, &state);
+}
 
-    free(in_buffer);
+int sq_scaleandrotate(FILE* instream, FILE* outstream, unsigned int in_length, float scale_factor, float radians)
+{
+    sq_affine_state state;
 
-    return 0;
+    sq_affine_init(&state, scale_factor, radians, 0.0, 0.0, 0);
+    return sq_affine(instream, outstream, in_length, &state);
 }
 
 int sq_scale(FILE* instream, FILE* outstream, unsigned int in_length, float scale_factor)
@@ -580,50 +714,52 @@ int sq_rotate(FILE* instream, FILE* outstream, unsigned int in_length, float rad
     return sq_scaleandrotate(instream, outstream, in_length, 1.0, radians);
 }
 
-int sq_mix(FILE* instream, FILE* outstream, unsigned int in_length, float radians)
+int sq_mix(FILE* instream, FILE* outstream, unsigned int in_length, double radians)
 {
     if (in_length <= 0)
     {
         fprintf(stderr, "Array lengths must be between 2 and %u\n", MAX_SMPLS_LEN);
         return ERR_ARG_BOUNDS;
     }
-    if (abs(radians) > 2.0 * M_PI)
+    if (fabs(radians) > 2.0 * M_PI)
     {
         sq_error_print("Warning: |Radians| > 2*PI, aliasing will occur.\n");
     }
 
-    unsigned int smpli;
-    float *in_buffer;
-    float angle = 0.0;
-
-    const float TWO_PI = 2.0 * M_PI;
+    sq_input input;
+    const cmplx *in_buffer;
+    cmplx *out_buffer;
+    sq_nco_state nco;
 
-    radians = radians * -1.0;
-
-    in_buffer = malloc(in_length * sizeof(cmplx));
-    if (in_buffer == NULL) return ERR_MALLOC;
+    // the oscillator turns by -radians per sample, and the first sample is
+    // already one step along
+    int status = sq_nco_init(&nco, -radians, -radians);
+    if (status < 0)
+    {
+        sq_nco_free(&nco);
+        return status;
+    }
 
-    float re, im;
-    while (fread(in_buffer, 8, in_length, instream) == in_length)
+    out_buffer = malloc(in_length * sizeof(cmplx));
+    if (out_buffer == NULL)
     {
-        for (smpli = 0; smpli < in_length; smpli++)
-        {
-            angle += radians;
-            angle = (angle > TWO_PI) ? (angle - TWO_PI) : angle;
-            angle = (angle < -TWO_PI) ? (angle + TWO_PI) : angle;
-
-            re = in_buffer[(smpli<<1)+0];
-            im = in_buffer[(smpli<<1)+1];
-            in_buffer[(smpli<<1)+0] = (re * (float)cos(angle) - im * (float)sin(angle));
-            in_buffer[(smpli<<1)+1] = (im * (float)cos(angle) + re * (float)sin(angle));
-        }
+        sq_nco_free(&nco);
+        return ERR_MALLOC;
+    }
 
-        fwrite(in_buffer, 8, in_length, outstream);
+    sq_input_open(&input, instream);
+    status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_COMPLEX, in_length, 0);
+    while ((status >= 0) && (sq_input_view(&input, (const void**) &in_buffer, sizeof(cmplx), in_length) == in_length))
+    {
+        sq_mix_buf(&nco, in_buffer, out_buffer, in_length);
+        fwrite(out_buffer, 8, in_length, outstream);
     }
+    sq_input_close(&input);
 
-    free(in_buffer);
+    free(out_buffer);
+    sq_nco_free(&nco);
 
-    return 0;
+    return (status < 0) ? status : 0;
 }
 
 void init_window(float* wndwbfr, unsigned int wndwlen, unsigned int folds)
@@ -650,105 +786,54 @@ void init_window(float* wndwbfr, unsigned int wndwlen, unsigned int folds)
 int sq_wola(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int folds,
             unsigned int overlap, unsigned char is_window_dump)
 {
-    if (!((in_length >= 2) && (in_length <= MAX_ZOOM_LEN)))
-    {
-        fprintf(stderr, "Zoom length must be between 2 and %u\n", MAX_SMPLS_LEN);
-        return ERR_ARG_BOUNDS;
-    }
-    if (folds < 1)
-    {
-        sq_error_print("Number of folds must be greater than 1.\n");
-        return ERR_ARG_BOUNDS;
-    }
-    if (!((overlap < 1) && (overlap >= in_length)))
-    {
-        sq_error_print("Overlap must be in range (1, in_length).\n");
-        return ERR_ARG_BOUNDS;
-    }
-
-    unsigned int wndwlen;
-
-    float *wndwbfr;
-    cmplx *readbfr;
-    cmplx *smplbfr;
+    sq_wola_state wola;
+    sq_input input;
+    const cmplx *readbfr;
     cmplx *fftbfr;
 
-    unsigned int wndwi, readi, smpli, ffti;
-    unsigned int readlen;
-
-    wndwlen = folds * in_length;
-    wndwbfr = malloc(wndwlen * sizeof(float));
-    if (wndwbfr == NULL) return ERR_MALLOC;
-
-    init_window(wndwbfr, wndwlen, folds);
+    unsigned int wndwi;
 
+    int status = sq_wola_init(&wola, in_length, folds, overlap);
+    if (status < 0)
+        return status;
 
     if (is_window_dump)
     {
-        for (wndwi = 0; wndwi < wndwlen; wndwi++)
-            fprintf(outstream, "%e\n", wndwbfr[wndwi]);
-        free(wndwbfr);
+        for (wndwi = 0; wndwi < wola.wndwlen; wndwi++)
+            fprintf(outstream, "%e\n", wola.wndwbfr[wndwi]);
+        sq_wola_free(&wola);
         return 0;
     }
 
-    readlen = in_length;
-    if (overlap == 25)
-        readlen = (in_length * 3) / 4;
-    if (overlap == 50)
-        readlen = (in_length * 2) / 4;
-
-    readbfr = malloc(readlen * sizeof(cmplx));
-    if (readbfr == NULL) return ERR_MALLOC;
-
-    smplbfr = malloc(wndwlen * sizeof(cmplx));
-    if (smplbfr == NULL) return ERR_MALLOC;
-
     fftbfr = malloc(in_length * sizeof(cmplx));
     if (fftbfr == NULL) return ERR_MALLOC;
 
     // initially fill the sample buffer to satisfy the first weight,
     // overlap, and add
-    if (!(fread(smplbfr, sizeof(cmplx), wndwlen, instream) == wndwlen))
+    sq_input_open(&input, instream);
+    status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_COMPLEX, in_length, 1);
+    if ((status < 0) || !(sq_input_read(&input, wola.smplbfr, sizeof(cmplx), wola.wndwlen) == wola.wndwlen))
     {
+        sq_input_close(&input);
         free(fftbfr);
-        free(smplbfr);
-        free(readbfr);
-        free(wndwbfr);
-        return ERR_STREAM_READ;
+        sq_wola_free(&wola);
+        return (status < 0) ? status : ERR_STREAM_READ;
     }
-
-    smpli = 0;
+    wola.smpli = 0;
+    wola.filled = wola.wndwlen;
 
     for (;;)
     {
-        for (ffti = 0; ffti < in_length; ffti++)
-            fftbfr[ffti][0] = fftbfr[ffti][1] = 0.0;
-        ffti = 0;
-        for (wndwi = 0; wndwi < wndwlen; wndwi++)
-        {
-            fftbfr[ffti][0] += wndwbfr[wndwi] * smplbfr[smpli][0];
-            fftbfr[ffti][1] += wndwbfr[wndwi] * smplbfr[smpli][1];
-            smpli++;
-            if (!(smpli < wndwlen)) smpli = 0;
-            ffti++;
-            if (!(ffti < in_length)) ffti = 0;
-        }
+        sq_wola_buf(&wola, fftbfr);
         fwrite(fftbfr, sizeof(cmplx), in_length, outstream);
-        if (!(fread(readbfr, sizeof(cmplx), readlen, instream) == readlen))
+        if (!(sq_input_view(&input, (const void**) &readbfr, sizeof(cmplx), wola.readlen) == wola.readlen))
             break;
-        for (readi = 0; readi < readlen; readi++)
-        {
-            smplbfr[smpli][0] = readbfr[readi][0];
-            smplbfr[smpli][1] = readbfr[readi][1];
-            smpli++;
-            if (!(smpli < wndwlen)) smpli = 0;
-        }
+        sq_wola_push(&wola, readbfr, wola.readlen);
     }
+    sq_input_close(&input);
 
     free(fftbfr);
-    free(smplbfr);
-    free(readbfr);
-    free(wndwbfr);
+    sq_wola_free(&wola);
 
     return 0;
 }
@@ -767,31 +852,30 @@ int sq_pad(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int
         return ERR_ARG_BOUNDS;
     }
 
-    float *input_bfr;
-    float *output_bfr;
+    sq_input input;
+    cmplx *input_bfr;
+    cmplx *output_bfr;
 
     // create buffer and initize with zeros
     output_bfr = calloc(out_length, sizeof(cmplx));
     if (output_bfr == NULL) return ERR_MALLOC;
-    // make double-darn sure output array is all zeros
-    int i = 0;
-    for (i = 0; i < out_length*2; ++i) output_bfr[i] = 0.0f;
 
-    // find the insertion point for reading data
-    int offset = (out_length - in_length) / 2; 
+    // input_bfr points to the center section of the output buffer, so the
+    // data is read straight into place between the zeros
+    input_bfr = output_bfr + (out_length - in_length) / 2;
 
-    // input_bfr points to the center section of the output buffer
-    input_bfr = output_bfr + offset * 2; // each cmplx sample is 2 floats
-
-    while (fread(input_bfr, sizeof(cmplx), in_length, instream) == in_length)
+    sq_input_open(&input, instream);
+    int status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_COMPLEX, out_length, 1);
+    while ((status >= 0) && (sq_input_read(&input, input_bfr, sizeof(cmplx), in_length) == in_length))
     {
         // the input data is already surrounded by zeros, just write it out
         fwrite(output_bfr, sizeof(cmplx), out_length , outstream);
     }
+    sq_input_close(&input);
 
     free(output_bfr);
 
-    return 0;
+    return (status < 0) ? status : 0;
 }
 
 int sq_fftflip(FILE* instream, FILE* outstream, unsigned int in_length)
@@ -802,33 +886,31 @@ int sq_fftflip(FILE* instream, FILE* outstream, unsigned int in_length)
         return ERR_ARG_BOUNDS;
     }
 
-    float *input_bfr;
+    sq_input input;
+    const cmplx *input_bfr;
+    cmplx *output_bfr;
 
-    input_bfr = malloc(in_length * sizeof(cmplx));
-    if (input_bfr == NULL) return ERR_MALLOC;
+    output_bfr = malloc(in_length * sizeof(cmplx));
+    if (output_bfr == NULL) return ERR_MALLOC;
 
-    unsigned int smpli;
-    while (fread(input_bfr, sizeof(cmplx), in_length, instream) == in_length)
+    sq_input_open(&input, instream);
+    int status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_COMPLEX, in_length, 1);
+    while ((status >= 0) && (sq_input_view(&input, (const void**) &input_bfr, sizeof(cmplx), in_length) == in_length))
     {
-        for (smpli = 0; smpli < in_length/2; smpli++)
-        {
-            float temp0 = input_bfr[(smpli<<1) + 0];
-            float temp1 = input_bfr[(smpli<<1) + 1];
-            input_bfr[(smpli<<1) + 0] = input_bfr[(smpli<<1) + in_length + 0];
-            input_bfr[(smpli<<1) + 1] = input_bfr[(smpli<<1) + in_length + 1];
-            input_bfr[(smpli<<1) + in_length + 0] = temp0;
-            input_bfr[(smpli<<1) + in_length + 1] = temp1;
-        }
- 
-        fwrite(input_bfr, sizeof(cmplx), in_length , outstream);
+        memcpy(output_bfr, input_bfr, in_length * sizeof(cmplx));
+        sq_fftflip_buf(output_bfr, in_length);
+        fwrite(output_bfr, sizeof(cmplx), in_length , outstream);
     }
+    sq_input_close(&input);
 
-    free(input_bfr);
+    free(output_bfr);
 
-    return 0;
+    return (status < 0) ? status : 0;
 }
 
-int sq_bin(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int out_length)
+// sq_bin and sq_bin_real; is_real selects the stream format
+static int bin_stream(FILE* instream, FILE* outstream, unsigned int in_length,
+                      unsigned int out_length, unsigned char is_real)
 {
     if (!((in_length >= 2) && (in_length <= MAX_SMPLS_LEN))
             && ((out_length >= 2) && (out_length <= MAX_SMPLS_LEN)))
@@ -842,49 +924,51 @@ int sq_bin(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int
         return ERR_ARG_BOUNDS;
     }
 
-    float *input_bfr;
-    float *output_bfr;
+    sq_input input;
+    const void *input_bfr;
+    void *output_bfr;
+    size_t smpl_size;
 
-    input_bfr = malloc(in_length * sizeof(cmplx));
-    if (input_bfr == NULL) return ERR_MALLOC;
+    sq_input_open(&input, instream);
+    int status = pass_header_either(&input, outstream, &is_real, in_length, out_length, 1);
+    if (status < 0)
+    {
+        sq_input_close(&input);
+        return status;
+    }
 
-    output_bfr = malloc(out_length * sizeof(cmplx));
+    smpl_size = is_real ? sizeof(float) : sizeof(cmplx);
+    output_bfr = malloc(out_length * smpl_size);
     if (output_bfr == NULL) return ERR_MALLOC;
 
-    // note bin_size is integer, so if in_length/out_length is not an integer
-    // it will be truncated
-    unsigned int bin_size;
-    bin_size = in_length / out_length;
-
-    unsigned int in_i = 0, out_i, start, stop;
-    while (fread(input_bfr, sizeof(cmplx), in_length, instream) == in_length)
+    while (sq_input_view(&input, &input_bfr, smpl_size, in_length) == in_length)
     {
-        // reinitialize output buffer to zero each iteration
-        memset(output_bfr, 0, out_length * sizeof(cmplx));
-
-        for (out_i = 0; out_i < out_length; out_i++)
-        {
-            start = out_i * bin_size;
-            stop = (out_i + 1) * bin_size;
-            for (in_i = start; in_i < stop; in_i++)
-            {
-                // it is ok to divide by integer at end because input_bfr are floats.
-                output_bfr[(out_i<<1) + REAL] += input_bfr[(in_i<<1) + REAL] / bin_size;
-                output_bfr[(out_i<<1) + IMAG] += input_bfr[(in_i<<1) + IMAG] / bin_size;
-            }
-        }
-
-        fwrite(output_bfr, sizeof(cmplx), out_length , outstream);
+        if (is_real)
+            sq_bin_real_buf(input_bfr, in_length, output_bfr, out_length);
+        else
+            sq_bin_buf(input_bfr, in_length, output_bfr, out_length);
+        fwrite(output_bfr, smpl_size, out_length, outstream);
     }
 
-    free(input_bfr);
+    sq_input_close(&input);
     free(output_bfr);
 
     return 0;
 }
 
-// Very much like sq_bin except that it keeps the max value in the bin rather than average val.
-int sq_maxhold(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int out_length)
+int sq_bin(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int out_length)
+{
+    return bin_stream(instream, outstream, in_length, out_length, 0);
+}
+
+int sq_bin_real(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int out_length)
+{
+    return bin_stream(instream, outstream, in_length, out_length, 1);
+}
+
+// sq_maxhold and sq_maxhold_real; is_real selects the stream format
+static int maxhold_stream(FILE* instream, FILE* outstream, unsigned int in_length,
+                          unsigned int out_length, unsigned char is_real)
 {
     if (!((in_length >= 2) && (in_length <= MAX_SMPLS_LEN))
             && ((out_length >= 2) && (out_length <= MAX_SMPLS_LEN)))
@@ -898,62 +982,158 @@ int sq_maxhold(FILE* instream, FILE* outstream, unsigned int in_length, unsigned
         return ERR_ARG_BOUNDS;
     }
 
-    float *input_bfr;
-    float *output_bfr;
+    sq_input input;
+    const void *input_bfr;
+    void *output_bfr;
+    size_t smpl_size;
 
-    input_bfr = malloc(in_length * sizeof(cmplx));
-    if (input_bfr == NULL) return ERR_MALLOC;
+    sq_input_open(&input, instream);
+    int status = pass_header_either(&input, outstream, &is_real, in_length, out_length, 1);
+    if (status < 0)
+    {
+        sq_input_close(&input);
+        return status;
+    }
 
-    output_bfr = malloc(out_length * sizeof(cmplx));
+    smpl_size = is_real ? sizeof(float) : sizeof(cmplx);
+    output_bfr = malloc(out_length * smpl_size);
     if (output_bfr == NULL) return ERR_MALLOC;
 
-    // note maxhold_size is integer, so if in_length/out_length is not an integer
-    // it will be truncated
-    unsigned int maxhold_size = in_length / out_length;
-
-    unsigned int in_i = 0, out_i, start, stop;
-    while (fread(input_bfr, sizeof(cmplx), in_length, instream) == in_length)
-    {
-        // reinitialize output buffer to zero each iteration
-        memset(output_bfr, 0, out_length * sizeof(cmplx));
-        for (out_i = 0; out_i < out_length; out_i++)
-        {   
-            // find maximum value in range
-            start = out_i * maxhold_size;
-            stop = (out_i + 1) * maxhold_size;
-            double max = 0;
-            unsigned int max_i = 0;
-            double min = -1;
-            double val = 0; 
-            float x = 0;
-            float y =0;
-            for (in_i = start; in_i < stop; in_i++)
-            {
-                x = input_bfr[(in_i<<1) + REAL];
-                y = input_bfr[(in_i<<1) + IMAG];
+    while (sq_input_view(&input, &input_bfr, smpl_size, in_length) == in_length)
+    {
+        if (is_real)
+            sq_maxhold_real_buf(input_bfr, in_length, output_bfr, out_length);
+        else
+            sq_maxhold_buf(input_bfr, in_length, output_bfr, out_length);
+        fwrite(output_bfr, smpl_size, out_length, outstream);
+    }
 
-                val = x*x + y*y;
-                if(min == -1) min = val;
-                if (val > max)
-                {
-                    max = val;
-                    max_i = in_i;
-                }
-		else if (val < min) min = val;
-            }
+    sq_input_close(&input);
+    free(output_bfr);
+
+    return 0;
+}
+
+// Very much like sq_bin except that it keeps the max value in the bin rather than average val.
+int sq_maxhold(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int out_length)
+{
+    return maxhold_stream(instream, outstream, in_length, out_length, 0);
+}
+
+int sq_maxhold_real(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int out_length)
+{
+    return maxhold_stream(instream, outstream, in_length, out_length, 1);
+}
+
+// writes one level of a pyramid, if it has a stream
+static int pyramid_write(FILE** streams, unsigned int leveli, const void* bfr,
+                         size_t smpl_size, unsigned int length)
+{
+    if ((streams == NULL) || (streams[leveli] == NULL))
+        return 0;
+    if (fwrite(bfr, smpl_size, length, streams[leveli]) != length)
+        return ERR_STREAM_WRITE;
+    return 0;
+}
+
+int sq_pyramid(FILE* instream, FILE** avgstreams, FILE** maxstreams,
+               unsigned int in_length, unsigned int nlevels, unsigned char is_real)
+{
+    if (!((in_length >= 2) && (in_length <= MAX_SMPLS_LEN)))
+    {
+        fprintf(stderr, "Array lengths must be between 2 and %u\n", MAX_SMPLS_LEN);
+        return ERR_ARG_BOUNDS;
+    }
+    if ((nlevels < 1) || (nlevels > 31) || ((in_length >> nlevels) < 1) ||
+        (in_length & ((1U << nlevels) - 1)))
+    {
+        sq_error_print("Input length must be a multiple of the coarsest binning factor.\n");
+        return ERR_ARG_BOUNDS;
+    }
 
-            // put max value into output buffer
-            output_bfr[(out_i<<1) + REAL] = input_bfr[(max_i<<1) + REAL];
-            output_bfr[(out_i<<1) + IMAG] = input_bfr[(max_i<<1) + IMAG];
+    sq_input input;
+    sq_stream_header header;
+    const void *input_bfr;
+    char *avg_bfr, *max_bfr;
+    const char *avg_prev, *max_prev;
+    char *avg_level, *max_level;
+    size_t smpl_size;
+    unsigned int leveli, length;
+    int status;
+
+    sq_input_open(&input, instream);
+
+    // every level gets a copy of the header, with its own raster length
+    status = sq_input_header(&input, &header);
+    if (status > 0)
+    {
+        is_real = (header.sample_type == SQ_SAMPLE_REAL);
+        status = sq_header_check(&header, header.sample_type, in_length);
+        header.flags |= SQ_STREAM_RASTERED;
+        for (leveli = 0; (status >= 0) && (leveli < nlevels); leveli++)
+        {
+            header.raster_length = in_length >> (leveli + 1);
+            if ((avgstreams != NULL) && (avgstreams[leveli] != NULL))
+                status = sq_header_write(avgstreams[leveli], &header);
+            if ((status >= 0) && (maxstreams != NULL) && (maxstreams[leveli] != NULL))
+                status = sq_header_write(maxstreams[leveli], &header);
         }
+    }
+    if (status < 0)
+    {
+        sq_input_close(&input);
+        return status;
+    }
 
-        fwrite(output_bfr, sizeof(cmplx), out_length , outstream);
+    // the levels are laid end to end: in_length/2 samples, then
+    // in_length/4, ..., so each one is made from the one before it
+    smpl_size = is_real ? sizeof(float) : sizeof(cmplx);
+    avg_bfr = malloc(in_length * smpl_size);
+    if (avg_bfr == NULL) return ERR_MALLOC;
+    max_bfr = malloc(in_length * smpl_size);
+    if (max_bfr == NULL) return ERR_MALLOC;
+
+    status = 0;
+    while ((status >= 0) && (sq_input_view(&input, &input_bfr, smpl_size, in_length) == in_length))
+    {
+        avg_prev = max_prev = input_bfr;
+        avg_level = avg_bfr;
+        max_level = max_bfr;
+
+        for (leveli = 0; (status >= 0) && (leveli < nlevels); leveli++)
+        {
+            length = in_length >> (leveli + 1);
+
+            // halving is exact for the maxima; an average of averages can
+            // differ from a direct average in the last bit
+            if (avgstreams != NULL)
+            {
+                if (is_real)
+                    sq_bin_real_buf((const float*) avg_prev, length * 2, (float*) avg_level, length);
+                else
+                    sq_bin_buf((const cmplx*) avg_prev, length * 2, (cmplx*) avg_level, length);
+                status = pyramid_write(avgstreams, leveli, avg_level, smpl_size, length);
+                avg_prev = avg_level;
+                avg_level += length * smpl_size;
+            }
+            if ((status >= 0) && (maxstreams != NULL))
+            {
+                if (is_real)
+                    sq_maxhold_real_buf((const float*) max_prev, length * 2, (float*) max_level, length);
+                else
+                    sq_maxhold_buf((const cmplx*) max_prev, length * 2, (cmplx*) max_level, length);
+                status = pyramid_write(maxstreams, leveli, max_level, smpl_size, length);
+                max_prev = max_level;
+                max_level += length * smpl_size;
+            }
+        }
     }
 
-    free(input_bfr);
-    free(output_bfr);
+    sq_input_close(&input);
+    free(avg_bfr);
+    free(max_bfr);
 
-    return 0;
+    return (status < 0) ? status : 0;
 }
 
 int sq_sidechop(FILE* instream, FILE* outstream, unsigned int in_length, 
@@ -966,61 +1146,35 @@ int sq_sidechop(FILE* instream, FILE* outstream, unsigned int in_length,
         fprintf(stderr, "Output length must be >= 2 and < Input length.\n");
         return ERR_ARG_BOUNDS;
     }
-
-    // check the direction of chop and compute indicies
-    unsigned int num_discard_samples = in_length - out_length;
-    unsigned int start;
-    if (side == 'r' || side == 'R')
-    {
-        side = 'R';
-        start = num_discard_samples;
-    }
-    else if (side == 'l' || side == 'L') 
-    {
-        side = 'L';
-        start = 0;
-    }
-    else
+    if (!(side == 'r' || side == 'R' || side == 'l' || side == 'L'))
     {
         fprintf(stderr, "Side = %c must indicate left or right side to chop.\n", side);
         return ERR_ARG_BOUNDS;
     }
 
-//    fprintf(stderr, "Deleting %u samples from %c side.\n", num_discard_samples, side);
-//    fprintf(stderr, "Start = %u, out_length = %u.\n", start, out_length);
-
     // allocate buffers
-    float *input_bfr;
-    float *output_bfr;
-
-    input_bfr = malloc(in_length * sizeof(cmplx));
-    if (input_bfr == NULL) return ERR_MALLOC;
+    sq_input input;
+    const cmplx *input_bfr;
+    cmplx *output_bfr;
 
     output_bfr = malloc(out_length * sizeof(cmplx));
     if (output_bfr == NULL) return ERR_MALLOC;
 
     // perform chopping
-    unsigned int in_i = 0;
-    while (fread(input_bfr, sizeof(cmplx), in_length, instream) == in_length)
+    sq_input_open(&input, instream);
+    int status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_COMPLEX, out_length, 1);
+    while ((status >= 0) && (sq_input_view(&input, (const void**) &input_bfr, sizeof(cmplx), in_length) == in_length))
     {
-        // reinitialize output buffer to zero each iteration
-        memset(output_bfr, 0, out_length * sizeof(cmplx));
-
-        unsigned int out_i = 0;
-        for (in_i = start; in_i < start + out_length; in_i++, out_i++)
-        {
-            output_bfr[(out_i<<1) + REAL] += input_bfr[(in_i<<1) + REAL];
-            output_bfr[(out_i<<1) + IMAG] += input_bfr[(in_i<<1) + IMAG];
-        }
+        sq_sidechop_buf(input_bfr, in_length, output_bfr, out_length, side);
 
         // write to output stream
         fwrite(output_bfr, sizeof(cmplx), out_length, outstream);
     }
 
-    free(input_bfr);
+    sq_input_close(&input);
     free(output_bfr);
 
-    return 0;
+    return (status < 0) ? status : 0;
 }
 
 
@@ -1037,22 +1191,29 @@ int sq_chop(FILE* instream, FILE* outstream, unsigned int in_length, float chop_
         return ERR_ARG_BOUNDS;
     }
 
-    float *input_bfr;
-    float *output_bfr;
+    sq_input input;
+    const cmplx *input_bfr;
+    cmplx *output_bfr;
+    unsigned int out_length;
 
-    int samples_to_discard = (int)((float)in_length * chop_fraction);
-    int out_length = in_length - 2 * samples_to_discard;
+    output_bfr = malloc(in_length * sizeof(cmplx));
+    if (output_bfr == NULL) return ERR_MALLOC;
 
-    input_bfr = malloc(in_length * sizeof(cmplx));
+    // as sq_chop_buf computes it
+    out_length = in_length - 2 * (unsigned int)((float)in_length * chop_fraction);
 
-    while (fread(input_bfr, sizeof(cmplx), in_length, instream) == in_length)
+    sq_input_open(&input, instream);
+    int status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_COMPLEX, out_length, 1);
+    while ((status >= 0) && (sq_input_view(&input, (const void**) &input_bfr, sizeof(cmplx), in_length) == in_length))
     {
+        out_length = sq_chop_buf(input_bfr, in_length, output_bfr, chop_fraction);
         fwrite(output_bfr, sizeof(cmplx), out_length , outstream);
     }
 
-    free(input_bfr);
+    sq_input_close(&input);
+    free(output_bfr);
 
-    return 0;
+    return (status < 0) ? status : 0;
 }
 
 int sq_overlap2x(FILE* instream, FILE* outstream, unsigned int in_length)
@@ -1069,47 +1230,35 @@ int sq_overlap2x(FILE* instream, FILE* outstream, unsigned int in_length)
     }
 
 
-    float *input_bfr1;
-    float *input_bfr2;
-    float *temp;
-    float *output_bfr;
-    float *offset_output_bfr;
+    sq_input input;
+    const cmplx *input_bfr;
+    cmplx *output_bfr;
+    cmplx *offset_output_bfr;
     unsigned int half_len = in_length/2;
 
-    input_bfr1 = malloc(half_len * sizeof(cmplx));
-    if (input_bfr1 == NULL) return ERR_MALLOC;
-
-    input_bfr2 = malloc(half_len * sizeof(cmplx));
-    if (input_bfr2 == NULL) return ERR_MALLOC;
-
     output_bfr = malloc(in_length * sizeof(cmplx));
     if (output_bfr == NULL) return ERR_MALLOC;
 
-    // even thought output_bfr is a complex array, it is declared as
-    // float. Hence we must count floats when computing memory offset
-    // adding in_length offsets to middle of array
-    offset_output_bfr = output_bfr + in_length;
+    offset_output_bfr = output_bfr + half_len;
 
-    // read first half-raster from stream -- assume it works, we'll check second read below
-    fread(input_bfr1, sizeof(cmplx), half_len, instream);
+    // read first half-raster into the second half of the output, where
+    // the loop expects the previous half-raster -- assume it works, we'll
+    // check the next read below
+    sq_input_open(&input, instream);
+    int status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_COMPLEX, in_length, 1);
+    sq_input_read(&input, offset_output_bfr, sizeof(cmplx), half_len);
 
-    while (fread(input_bfr2, sizeof(cmplx), half_len, instream) == half_len)
+    while ((status >= 0) && (sq_input_view(&input, (const void**) &input_bfr, sizeof(cmplx), half_len) == half_len))
     {
-        memcpy(output_bfr,        input_bfr1, half_len * sizeof(cmplx));
-        memcpy(offset_output_bfr, input_bfr2, half_len * sizeof(cmplx));
+        memcpy(output_bfr,        offset_output_bfr, half_len * sizeof(cmplx));
+        memcpy(offset_output_bfr, input_bfr,         half_len * sizeof(cmplx));
         fwrite(output_bfr, sizeof(cmplx), in_length , outstream);
-
-        // swap buffers
-        temp = input_bfr1;
-        input_bfr1 = input_bfr2;
-        input_bfr2 = temp;
     }
+    sq_input_close(&input);
 
-    free(input_bfr1);
-    free(input_bfr2);
     free(output_bfr);
 
-    return 0;
+    return (status < 0) ? status : 0;
 }
 
 
@@ -1122,13 +1271,16 @@ int sq_ascii(FILE* instream, FILE* outstream, unsigned int in_length)
     }
 
     int i;
-    float *input_bfr;
-    float *output_bfr;
-
-    input_bfr = malloc(in_length * sizeof(cmplx));
-    if (input_bfr == NULL) return ERR_MALLOC;
-
-    while (fread(input_bfr, sizeof(cmplx), in_length, instream) == in_length)
+    sq_input input;
+    sq_stream_header header;
+    const float *input_bfr;
+
+    // the output is text, so the header is checked but not passed on
+    sq_input_open(&input, instream);
+    int status = sq_input_header(&input, &header);
+    if (status > 0)
+        status = sq_header_check(&header, SQ_SAMPLE_COMPLEX, in_length);
+    while ((status >= 0) && (sq_input_view(&input, (const void**) &input_bfr, sizeof(cmplx), in_length) == in_length))
     {
         for (i = 0; i < in_length; ++i)
         {
@@ -1136,10 +1288,9 @@ int sq_ascii(FILE* instream, FILE* outstream, unsigned int in_length)
                     input_bfr[(i<<1) + 0], input_bfr[(i<<1) + 1]);
         }
     }
+    sq_input_close(&input);
 
-    free(input_bfr);
-
-    return 0;
+    return (status < 0) ? status : 0;
 }
 
 int sq_phase(FILE* instream, FILE* outstream, unsigned int in_length)
@@ -1150,36 +1301,1225 @@ int sq_phase(FILE* instream, FILE* outstream, unsigned int in_length)
         return ERR_ARG_BOUNDS;
     }
 
-    int i;
-    float *input_bfr;
-    float val;
+    sq_input input;
+    const cmplx *input_bfr;
+    cmplx *output_bfr;
 
-    input_bfr = malloc(in_length * sizeof(cmplx));
-    if (input_bfr == NULL) return ERR_MALLOC;
+    output_bfr = malloc(in_length * sizeof(cmplx));
+    if (output_bfr == NULL) return ERR_MALLOC;
 
-    while (fread(input_bfr, sizeof(cmplx), in_length, instream) == in_length)
+    sq_input_open(&input, instream);
+    int status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_COMPLEX, in_length, 0);
+    while ((status >= 0) && (sq_input_view(&input, (const void**) &input_bfr, sizeof(cmplx), in_length) == in_length))
     {
-        for (i = 0; i < in_length; ++i)
-        {
-            // compute absolute value of complex sample
-            val = input_bfr[(i<<1) + 0] * input_bfr[(i<<1) + 0] +
-                  input_bfr[(i<<1) + 1] * input_bfr[(i<<1) + 1];
-            val = sqrt(val);
-            //fprintf(stderr, "Abs value = %f.\n", val);
-
-            // divide each sample by its absolute value
-            // avoid divide by zero; phase is undefined if val = 0, just leave it
-            if (val > 0)
-            {
-                input_bfr[(i<<1) + 0] /= val;
-                input_bfr[(i<<1) + 1] /= val;
-            }
-        }
+        sq_phase_buf(input_bfr, output_bfr, in_length);
+        fwrite(output_bfr, sizeof(cmplx), in_length , outstream);
+    }
+    sq_input_close(&input);
 
-        fwrite(input_bfr, sizeof(cmplx), in_length , outstream);
+    free(output_bfr);
+
+    return (status < 0) ? status : 0;
+}
+
+int sq_power_real(FILE* instream, FILE* outstream, unsigned int in_length)
+{
+    sq_input input;
+    const cmplx *in_buffer;
+    float *pwr_buffer;
+
+    if ((in_length < 2) || (in_length >= MAX_SMPLS_LEN))
+    {
+        fprintf(stderr, "Array lengths must be between 2 and %u\n", MAX_SMPLS_LEN);
+        return ERR_ARG_BOUNDS;
     }
 
-    free(input_bfr);
+    pwr_buffer = malloc(in_length * sizeof(float));
+    if (pwr_buffer == NULL) return ERR_MALLOC;
 
-    return 0;
+    sq_input_open(&input, instream);
+    int status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_REAL, in_length, 0);
+    while ((status >= 0) && (sq_input_view(&input, (const void**) &in_buffer, sizeof(cmplx), in_length) == in_length))
+    {
+        sq_power_buf(in_buffer, pwr_buffer, in_length);
+        fwrite(pwr_buffer, sizeof(float), in_length, outstream);
+    }
+    sq_input_close(&input);
+
+    free(pwr_buffer);
+
+    return (status < 0) ? status : 0;
+}
+
+int sq_abs_real(FILE* instream, FILE* outstream, unsigned int in_length)
+{
+    sq_input input;
+    const cmplx *in_buffer;
+    float *abs_buffer;
+
+    if ((in_length < 2) || (in_length >= MAX_SMPLS_LEN))
+    {
+        fprintf(stderr, "Array lengths must be between 2 and %u\n", MAX_SMPLS_LEN);
+        return ERR_ARG_BOUNDS;
+    }
+
+    abs_buffer = malloc(in_length * sizeof(float));
+    if (abs_buffer == NULL) return ERR_MALLOC;
+
+    sq_input_open(&input, instream);
+    int status = sq_header_pass(&input, outstream, SQ_SAMPLE_COMPLEX, in_length, SQ_SAMPLE_REAL, in_length, 0);
+    while ((status >= 0) && (sq_input_view(&input, (const void**) &in_buffer, sizeof(cmplx), in_length) == in_length))
+    {
+        sq_abs_buf(in_buffer, abs_buffer, in_length);
+        fwrite(abs_buffer, sizeof(float), in_length, outstream);
+    }
+    sq_input_close(&input);
+
+    free(abs_buffer);
+
+    return (status < 0) ? status : 0;
+}
+
+int sq_offset_real(FILE* instream, FILE* outstream, unsigned int in_length, float delta)
+{
+    return offset_stream(instream, outstream, in_length, delta, 0.0, 1);
+}
+
+int sq_subavg_real(FILE* instream, FILE* outstream, unsigned int in_length)
+{
+    return subavg_stream(instream, outstream, in_length, 1);
+}
+
+void sq_power_buf(const cmplx* in, float* out, unsigned int n)
+{
+    unsigned int smpli;
+
+    for (smpli = sq_simd_power(in, out, n); smpli < n; smpli++)
+        out[smpli] = (in[smpli][REAL] * in[smpli][REAL]) +
+                     (in[smpli][IMAG] * in[smpli][IMAG]);
+}
+
+void sq_window_buf(const float* wndw, const cmplx* in, cmplx* out, unsigned int n)
+{
+    unsigned int smpli;
+
+    for (smpli = 0; smpli < n; smpli++)
+    {
+        out[smpli][REAL] = in[smpli][REAL] * wndw[smpli];
+        out[smpli][IMAG] = in[smpli][IMAG] * wndw[smpli];
+    }
+}
+
+void sq_component_buf(const cmplx* in, float* out, unsigned int n, int component)
+{
+    unsigned int smpli;
+
+    for (smpli = 0; smpli < n; smpli++)
+        out[smpli] = in[smpli][component];
+}
+
+void sq_abs_buf(const cmplx* in, float* out, unsigned int n)
+{
+    unsigned int smpli;
+
+    for (smpli = sq_simd_abs(in, out, n); smpli < n; smpli++)
+        out[smpli] = sqrt((in[smpli][REAL] * in[smpli][REAL]) +
+                          (in[smpli][IMAG] * in[smpli][IMAG]));
+}
+
+void sq_power_cmplx_buf(const cmplx* in, cmplx* out, unsigned int n)
+{
+    unsigned int smpli;
+
+    for (smpli = sq_simd_power_cmplx(in, out, n); smpli < n; smpli++)
+    {
+        out[smpli][REAL] = (in[smpli][REAL] * in[smpli][REAL]) +
+                           (in[smpli][IMAG] * in[smpli][IMAG]);
+        out[smpli][IMAG] = 0.0;
+    }
+}
+
+void sq_abs_cmplx_buf(const cmplx* in, cmplx* out, unsigned int n)
+{
+    unsigned int smpli;
+
+    for (smpli = sq_simd_abs_cmplx(in, out, n); smpli < n; smpli++)
+    {
+        out[smpli][REAL] = sqrt((in[smpli][REAL] * in[smpli][REAL]) +
+                                (in[smpli][IMAG] * in[smpli][IMAG]));
+        out[smpli][IMAG] = 0.0;
+    }
+}
+
+void sq_crossmultiply_buf(const cmplx* in1, const cmplx* in2, cmplx* out, unsigned int n)
+{
+    unsigned int smpli;
+    float real, imag;
+
+    for (smpli = sq_simd_crossmultiply(in1, in2, out, n); smpli < n; smpli++)
+    {
+        real = (in1[smpli][REAL] * in2[smpli][REAL]) - (in1[smpli][IMAG] * in2[smpli][IMAG]);
+        imag = (in1[smpli][REAL] * in2[smpli][IMAG]) + (in1[smpli][IMAG] * in2[smpli][REAL]);
+
+        out[smpli][REAL] = real;
+        out[smpli][IMAG] = imag;
+    }
+}
+
+void sq_crossmultiply_scale_buf(const cmplx* in1, const cmplx* in2, cmplx* out, unsigned int n,
+                                unsigned char is_conjugated, float scale)
+{
+    unsigned int smpli;
+    float real, imag, imag2;
+
+    for (smpli = sq_simd_crossmultiply_scale(in1, in2, out, n, is_conjugated, scale); smpli < n; smpli++)
+    {
+        imag2 = is_conjugated ? -in2[smpli][IMAG] : in2[smpli][IMAG];
+        real = (in1[smpli][REAL] * in2[smpli][REAL]) - (in1[smpli][IMAG] * imag2);
+        imag = (in1[smpli][REAL] * imag2) + (in1[smpli][IMAG] * in2[smpli][REAL]);
+
+        out[smpli][REAL] = real * scale;
+        out[smpli][IMAG] = imag * scale;
+    }
+}
+
+void sq_crossmultiply_sum_buf(const cmplx* in1, const cmplx* in2, cmplx* sum, unsigned int n)
+{
+    unsigned int smpli;
+    float real, imag;
+
+    for (smpli = sq_simd_crossmultiply_sum(in1, in2, sum, n); smpli < n; smpli++)
+    {
+        real = (in1[smpli][REAL] * in2[smpli][REAL]) - (in1[smpli][IMAG] * -in2[smpli][IMAG]);
+        imag = (in1[smpli][REAL] * -in2[smpli][IMAG]) + (in1[smpli][IMAG] * in2[smpli][REAL]);
+
+        sum[smpli][REAL] += real;
+        sum[smpli][IMAG] += imag;
+    }
+}
+
+void sq_accumulate_buf(const float* in, double* sum, double* comp, unsigned int n, double weight)
+{
+    unsigned int i;
+    double y, t;
+
+    if (comp == NULL)
+    {
+        for (i = sq_simd_accumulate(in, sum, n, weight); i < n; i++)
+            sum[i] += weight * in[i];
+        return;
+    }
+
+    // Kahan summation: comp holds what was lost to rounding the last time
+    for (i = sq_simd_accumulate_kahan(in, sum, comp, n, weight); i < n; i++)
+    {
+        y = (weight * in[i]) - comp[i];
+        t = sum[i] + y;
+        comp[i] = (t - sum[i]) - y;
+        sum[i] = t;
+    }
+}
+
+void sq_leaky_accumulate_buf(const float* in, double* sum, unsigned int n, double decay)
+{
+    unsigned int i;
+
+    for (i = sq_simd_leaky_accumulate(in, sum, n, decay); i < n; i++)
+        sum[i] = (decay * sum[i]) + in[i];
+}
+
+void sq_sum_buf(const cmplx* in, cmplx* sum, unsigned int n)
+{
+    unsigned int smpli;
+
+    for (smpli = 0; smpli < n; smpli++)
+    {
+        sum[smpli][REAL] += in[smpli][REAL];
+        sum[smpli][IMAG] += in[smpli][IMAG];
+    }
+}
+
+void sq_offset_buf(const cmplx* in, cmplx* out, unsigned int n, float real_delta, float imag_delta)
+{
+    unsigned int smpli;
+
+    for (smpli = sq_simd_offset(in, out, n, real_delta, imag_delta); smpli < n; smpli++)
+    {
+        out[smpli][REAL] = in[smpli][REAL] + real_delta;
+        out[smpli][IMAG] = in[smpli][IMAG] + imag_delta;
+    }
+}
+
+void sq_subavg_buf(const cmplx* in, cmplx* out, unsigned int n)
+{
+    unsigned int smpli;
+
+    // compute average value
+    double sumr = 0;
+    double sumi = 0;
+    for (smpli = sq_simd_sum(in, n, &sumr, &sumi); smpli < n; smpli++)
+    {
+        sumr += in[smpli][REAL];
+        sumi += in[smpli][IMAG];
+    }
+    float favgr = (float)(sumr/n);
+    float favgi = (float)(sumi/n);
+
+    // subtract it off; adding the negation rounds identically
+    sq_offset_buf(in, out, n, -favgr, -favgi);
+}
+
+void sq_conjugate_buf(const cmplx* in, cmplx* out, unsigned int n)
+{
+    unsigned int smpli;
+
+    for (smpli = sq_simd_conjugate(in, out, n); smpli < n; smpli++)
+    {
+        out[smpli][REAL] = in[smpli][REAL];
+        out[smpli][IMAG] = -in[smpli][IMAG];
+    }
+}
+
+void sq_scaleandrotate_buf(const cmplx* in, cmplx* out, unsigned int n, float scale_factor, float radians)
+{
+    sq_affine_state state;
+
+    sq_affine_init(&state, scale_factor, radians, 0.0, 0.0, 0);
+    sq_affine_buf(&state, in, out, n);
+}
+
+void sq_affine_init(sq_affine_state* state, float scale_factor, float radians,
+                    float real_delta, float imag_delta, unsigned char is_conjugated)
+{
+    state->a[REAL] = (float)(scale_factor * cos(radians));
+    state->a[IMAG] = (float)(scale_factor * sin(radians));
+    state->b[REAL] = real_delta;
+    state->b[IMAG] = imag_delta;
+    state->is_conjugated = is_conjugated;
+}
+
+void sq_affine_buf(const sq_affine_state* state, const cmplx* in, cmplx* out, unsigned int n)
+{
+    unsigned int smpli;
+    float re, im;
+    const float ar = state->a[REAL];
+    const float ai = state->a[IMAG];
+    const float br = state->b[REAL];
+    const float bi = state->b[IMAG];
+
+    // with a = 1 there is nothing to multiply, and an offset or a plain
+    // conjugate leaves every other bit of the sample as it was
+    if ((ar == 1.0f) && (ai == 0.0f))
+    {
+        if (!state->is_conjugated)
+        {
+            sq_offset_buf(in, out, n, br, bi);
+            return;
+        }
+        if ((br == 0.0f) && (bi == 0.0f))
+        {
+            sq_conjugate_buf(in, out, n);
+            return;
+        }
+    }
+
+    for (smpli = sq_simd_affine(in, out, n, ar, ai, br, bi, state->is_conjugated); smpli < n; smpli++)
+    {
+        re = in[smpli][REAL];
+        im = state->is_conjugated ? -in[smpli][IMAG] : in[smpli][IMAG];
+        out[smpli][REAL] = (ar * re - ai * im) + br;
+        out[smpli][IMAG] = (ar * im + ai * re) + bi;
+    }
+}
+
+void sq_mix_buf(sq_nco_state* state, const cmplx* in, cmplx* out, unsigned int n)
+{
+    unsigned int smpli, blocki, blocklen;
+    double angle, re, im;
+    const double* table = state->table;
+
+    for (smpli = 0; smpli < n; smpli += blocklen)
+    {
+        blocklen = (n - smpli < NCO_BLOCK) ? n - smpli : NCO_BLOCK;
+
+        // one sin/cos per block, from the exact phase
+        angle = ldexp((double) state->phase, -64) * 2.0 * M_PI;
+        re = cos(angle);
+        im = sin(angle);
+        for (blocki = 0; blocki < blocklen; blocki++)
+        {
+            state->phasors[blocki][REAL] = (float)(re * table[2*blocki] - im * table[2*blocki + 1]);
+            state->phasors[blocki][IMAG] = (float)(re * table[2*blocki + 1] + im * table[2*blocki]);
+        }
+
+        sq_crossmultiply_buf(&in[smpli], state->phasors, &out[smpli], blocklen);
+        state->phase += (uint64_t) blocklen * state->step;
+    }
+}
+
+void sq_pad_buf(const cmplx* in, unsigned int in_length, cmplx* out, unsigned int out_length)
+{
+    unsigned int offset = (out_length - in_length) / 2;
+
+    // memmove, since the input may already sit in the middle of the output
+    memmove(&out[offset], in, in_length * sizeof(cmplx));
+    memset(&out[0], 0, offset * sizeof(cmplx));
+    memset(&out[offset + in_length], 0, (out_length - offset - in_length) * sizeof(cmplx));
+}
+
+void sq_fftflip_buf(cmplx* bfr, unsigned int n)
+{
+    sq_channelswap(bfr, n);
+}
+
+// Bin edges fall every in_length/out_length input samples. Each edge is
+// kept exactly, as a sample index and a remainder in 1/out_length of a
+// sample; this advances one from the lower edge of a bin to the upper.
+static inline void bin_edge(unsigned int* smpli, unsigned int* frac, unsigned int in_length,
+                            unsigned int out_length)
+{
+    *smpli += in_length / out_length;
+    *frac += in_length % out_length;
+    if (*frac >= out_length)
+    {
+        (*smpli)++;
+        *frac -= out_length;
+    }
+}
+
+// narrower bins are not worth a call to a vector kernel
+#define BIN_SIMD_MIN 64
+
+// adds up n complex samples in double precision
+static inline void bin_sum(const cmplx* in, unsigned int n, double* sumr, double* sumi)
+{
+    unsigned int smpli = (n >= BIN_SIMD_MIN) ? sq_simd_sum(in, n, sumr, sumi) : 0;
+
+    for (; smpli < n; smpli++)
+    {
+        *sumr += in[smpli][REAL];
+        *sumi += in[smpli][IMAG];
+    }
+}
+
+// adds up n real samples in double precision
+static inline double bin_sum_real(const float* in, unsigned int n)
+{
+    unsigned int smpli;
+    double sumr = 0;
+    double sumi = 0;
+
+    // consecutive pairs of real samples go through the complex kernel
+    smpli = (n >= BIN_SIMD_MIN) ? 2 * sq_simd_sum((const cmplx*) in, n / 2, &sumr, &sumi) : 0;
+    for (; smpli < n; smpli++)
+        sumr += in[smpli];
+
+    return sumr + sumi;
+}
+
+// index of the first of n complex samples of largest power, or 0 if all
+// are zero
+static unsigned int bin_argmax(const cmplx* in, unsigned int n)
+{
+    unsigned int smpli, max_i = 0;
+    float max = 0;
+    float val;
+
+    if (n < BIN_SIMD_MIN)
+    {
+        for (smpli = 0; smpli < n; smpli++)
+        {
+            val = in[smpli][REAL]*in[smpli][REAL] + in[smpli][IMAG]*in[smpli][IMAG];
+            if (val > max)
+            {
+                max = val;
+                max_i = smpli;
+            }
+        }
+        return max_i;
+    }
+
+    // find the largest power with the vector kernel...
+    for (smpli = sq_simd_max_power(in, n, &max); smpli < n; smpli++)
+    {
+        val = in[smpli][REAL]*in[smpli][REAL] + in[smpli][IMAG]*in[smpli][IMAG];
+        if (val > max)
+            max = val;
+    }
+
+    // ...then the first sample that has it; the powers round identically
+    if (max > 0)
+        while (in[max_i][REAL]*in[max_i][REAL] + in[max_i][IMAG]*in[max_i][IMAG] != max)
+            max_i++;
+
+    return max_i;
+}
+
+// index of the first of n real samples of largest magnitude, or 0 if all
+// are zero
+static unsigned int bin_argmax_real(const float* in, unsigned int n)
+{
+    unsigned int smpli, max_i = 0;
+    float max = 0;
+    float val;
+
+    if (n < BIN_SIMD_MIN)
+    {
+        for (smpli = 0; smpli < n; smpli++)
+        {
+            val = fabsf(in[smpli]);
+            if (val > max)
+            {
+                max = val;
+                max_i = smpli;
+            }
+        }
+        return max_i;
+    }
+
+    for (smpli = sq_simd_max_abs(in, n, &max); smpli < n; smpli++)
+    {
+        val = fabsf(in[smpli]);
+        if (val > max)
+            max = val;
+    }
+
+    if (max > 0)
+        while (fabsf(in[max_i]) != max)
+            max_i++;
+
+    return max_i;
+}
+
+void sq_bin_buf(const cmplx* in, unsigned int in_length, cmplx* out, unsigned int out_length)
+{
+    // samples cut by a bin edge are weighted by the part inside the bin,
+    // and the weights of a bin add up to in_length/out_length
+    double unit = 1.0 / out_length;
+    double scale = (double) out_length / in_length;
+
+    unsigned int out_i;
+    unsigned int lo_i = 0, lo_f = 0, hi_i = 0, hi_f = 0;
+    double sumr, sumi, weight;
+
+    for (out_i = 0; out_i < out_length; out_i++, lo_i = hi_i, lo_f = hi_f)
+    {
+        bin_edge(&hi_i, &hi_f, in_length, out_length);
+        if (hi_i == lo_i)
+        {
+            // the bin lies within one input sample
+            out[out_i][REAL] = in[lo_i][REAL];
+            out[out_i][IMAG] = in[lo_i][IMAG];
+            continue;
+        }
+
+        sumr = 0;
+        sumi = 0;
+        if (lo_f > 0)
+        {
+            // the first sample is cut by the lower edge
+            weight = (out_length - lo_f) * unit;
+            sumr = weight * in[lo_i][REAL];
+            sumi = weight * in[lo_i][IMAG];
+            lo_i++;
+        }
+        bin_sum(&in[lo_i], hi_i - lo_i, &sumr, &sumi);
+        if (hi_f > 0)
+        {
+            weight = hi_f * unit;
+            sumr += weight * in[hi_i][REAL];
+            sumi += weight * in[hi_i][IMAG];
+        }
+
+        out[out_i][REAL] = (float)(sumr * scale);
+        out[out_i][IMAG] = (float)(sumi * scale);
+    }
+}
+
+void sq_maxhold_buf(const cmplx* in, unsigned int in_length, cmplx* out, unsigned int out_length)
+{
+    unsigned int out_i, max_i, stop;
+    unsigned int lo_i = 0, hi_i = 0, hi_f = 0;
+
+    for (out_i = 0; out_i < out_length; out_i++, lo_i = hi_i)
+    {
+        // a sample cut by a bin edge belongs to both bins
+        bin_edge(&hi_i, &hi_f, in_length, out_length);
+        stop = (hi_f > 0) ? hi_i + 1 : hi_i;
+
+        max_i = lo_i + bin_argmax(&in[lo_i], stop - lo_i);
+        out[out_i][REAL] = in[max_i][REAL];
+        out[out_i][IMAG] = in[max_i][IMAG];
+    }
+}
+
+void sq_sum_real_buf(const float* in, float* sum, unsigned int n)
+{
+    unsigned int smpli;
+
+    for (smpli = 0; smpli < n; smpli++)
+        sum[smpli] += in[smpli];
+}
+
+void sq_offset_real_buf(const float* in, float* out, unsigned int n, float delta)
+{
+    unsigned int smpli;
+
+    // consecutive pairs of real samples go through the complex kernel
+    for (smpli = 2 * sq_simd_offset((const cmplx*) in, (cmplx*) out, n / 2, delta, delta); smpli < n; smpli++)
+        out[smpli] = in[smpli] + delta;
+}
+
+void sq_subavg_real_buf(const float* in, float* out, unsigned int n)
+{
+    unsigned int smpli;
+
+    // compute average value
+    double sumr = 0;
+    double sumi = 0;
+    for (smpli = 2 * sq_simd_sum((const cmplx*) in, n / 2, &sumr, &sumi); smpli < n; smpli++)
+        sumr += in[smpli];
+    float favg = (float)((sumr + sumi)/n);
+
+    // subtract it off; adding the negation rounds identically
+    sq_offset_real_buf(in, out, n, -favg);
+}
+
+void sq_bin_real_buf(const float* in, unsigned int in_length, float* out, unsigned int out_length)
+{
+    // edges and weights as in sq_bin_buf
+    double unit = 1.0 / out_length;
+    double scale = (double) out_length / in_length;
+
+    unsigned int out_i;
+    unsigned int lo_i = 0, lo_f = 0, hi_i = 0, hi_f = 0;
+    double sum;
+
+    for (out_i = 0; out_i < out_length; out_i++, lo_i = hi_i, lo_f = hi_f)
+    {
+        bin_edge(&hi_i, &hi_f, in_length, out_length);
+        if (hi_i == lo_i)
+        {
+            out[out_i] = in[lo_i];
+            continue;
+        }
+
+        sum = 0;
+        if (lo_f > 0)
+            sum = (out_length - lo_f) * unit * in[lo_i++];
+        sum += bin_sum_real(&in[lo_i], hi_i - lo_i);
+        if (hi_f > 0)
+            sum += hi_f * unit * in[hi_i];
+
+        out[out_i] = (float)(sum * scale);
+    }
+}
+
+void sq_maxhold_real_buf(const float* in, unsigned int in_length, float* out, unsigned int out_length)
+{
+    unsigned int out_i, stop;
+    unsigned int lo_i = 0, hi_i = 0, hi_f = 0;
+
+    for (out_i = 0; out_i < out_length; out_i++, lo_i = hi_i)
+    {
+        // bins as in sq_maxhold_buf
+        bin_edge(&hi_i, &hi_f, in_length, out_length);
+        stop = (hi_f > 0) ? hi_i + 1 : hi_i;
+
+        out[out_i] = in[lo_i + bin_argmax_real(&in[lo_i], stop - lo_i)];
+    }
+}
+
+void sq_sidechop_buf(const cmplx* in, unsigned int in_length, cmplx* out, unsigned int out_length, char side)
+{
+    unsigned int start = (side == 'r' || side == 'R') ? (in_length - out_length) : 0;
+
+    memcpy(out, &in[start], out_length * sizeof(cmplx));
+}
+
+unsigned int sq_chop_buf(const cmplx* in, unsigned int in_length, cmplx* out, float chop_fraction)
+{
+    unsigned int samples_to_discard = (unsigned int)((float)in_length * chop_fraction);
+    unsigned int out_length = in_length - 2 * samples_to_discard;
+
+    memcpy(out, &in[samples_to_discard], out_length * sizeof(cmplx));
+
+    return out_length;
+}
+
+void sq_phase_buf(const cmplx* in, cmplx* out, unsigned int n)
+{
+    unsigned int smpli;
+    float val;
+
+    for (smpli = sq_simd_phase(in, out, n); smpli < n; smpli++)
+    {
+        // compute absolute value of complex sample
+        val = in[smpli][REAL] * in[smpli][REAL] +
+              in[smpli][IMAG] * in[smpli][IMAG];
+        val = sqrt(val);
+
+        // divide each sample by its absolute value
+        // avoid divide by zero; phase is undefined if val = 0, just leave it
+        if (val > 0)
+        {
+            out[smpli][REAL] = in[smpli][REAL] / val;
+            out[smpli][IMAG] = in[smpli][IMAG] / val;
+        }
+        else
+        {
+            out[smpli][REAL] = in[smpli][REAL];
+            out[smpli][IMAG] = in[smpli][IMAG];
+        }
+    }
+}
+
+int sq_fft_init(sq_fft_state* state, unsigned int fft_len,
+                unsigned char is_conjugated, unsigned char is_measured,
+                unsigned char inverse)
+{
+    return sq_fft_init_many(state, fft_len, 1, is_conjugated, is_measured, inverse);
+}
+
+int sq_fft_init_many(sq_fft_state* state, unsigned int fft_len, unsigned int howmany,
+                     unsigned char is_conjugated, unsigned char is_measured,
+                     unsigned char inverse)
+{
+    if (!((fft_len >= 2) && (fft_len <= MAX_SMPLS_LEN)))
+    {
+        fprintf(stderr, "Array lengths must be between 2 and %u\n", MAX_SMPLS_LEN);
+        return ERR_ARG_BOUNDS;
+    }
+    if (!((howmany >= 1) && ((uint64_t) howmany * fft_len <= MAX_SMPLS_LEN)))
+    {
+        fprintf(stderr, "Batch of rasters must hold between 1 and %u samples\n", MAX_SMPLS_LEN);
+        return ERR_ARG_BOUNDS;
+    }
+
+    int n = fft_len;
+
+    state->length = fft_len;
+    state->howmany = howmany;
+    state->is_conjugated = is_conjugated;
+    state->inverse = inverse;
+    state->premodulated = 0;
+    state->real_mode = 0;
+    state->realbfr = NULL;
+
+    state->bfr = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * fft_len * howmany);
+    if (state->bfr == NULL) return ERR_MALLOC;
+
+    if (howmany == 1)
+        state->plan = fftwf_plan_dft_1d(fft_len,
+                                        (state->bfr),
+                                        (state->bfr),
+                                        (inverse ? FFTW_BACKWARD : FFTW_FORWARD),
+                                        (is_measured ? FFTW_MEASURE : FFTW_ESTIMATE));
+    else
+        state->plan = fftwf_plan_many_dft(1, &n, howmany,
+                                          (state->bfr), NULL, 1, fft_len,
+                                          (state->bfr), NULL, 1, fft_len,
+                                          (inverse ? FFTW_BACKWARD : FFTW_FORWARD),
+                                          (is_measured ? FFTW_MEASURE : FFTW_ESTIMATE));
+
+    return 0;
+}
+
+int sq_fft_init_real(sq_fft_state* state, unsigned int fft_len, unsigned int howmany,
+                     unsigned char is_measured, unsigned char inverse, unsigned char real_mode)
+{
+    if (!((real_mode == SQ_FFT_REAL_INPUT) || ((real_mode == SQ_FFT_REAL_OUTPUT) && inverse)))
+    {
+        sq_error_print("Real output needs the inverse transform, and cannot be combined with real input.\n");
+        return ERR_ARG_BOUNDS;
+    }
+    if (!((fft_len >= 2) && (fft_len <= MAX_SMPLS_LEN)))
+    {
+        fprintf(stderr, "Array lengths must be between 2 and %u\n", MAX_SMPLS_LEN);
+        return ERR_ARG_BOUNDS;
+    }
+    if (!((howmany >= 1) && ((uint64_t) howmany * fft_len <= MAX_SMPLS_LEN)))
+    {
+        fprintf(stderr, "Batch of rasters must hold between 1 and %u samples\n", MAX_SMPLS_LEN);
+        return ERR_ARG_BOUNDS;
+    }
+
+    int n = fft_len;
+    unsigned int flags = (is_measured ? FFTW_MEASURE : FFTW_ESTIMATE);
+
+    state->length = fft_len;
+    state->howmany = howmany;
+    state->is_conjugated = 0;
+    state->inverse = inverse;
+    state->premodulated = 0;
+    state->real_mode = real_mode;
+
+    // the complex side keeps full rasters, so the spectrum can be completed
+    // in place; the transforms only touch the first fft_len/2 + 1 bins
+    state->bfr = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * fft_len * howmany);
+    if (state->bfr == NULL) return ERR_MALLOC;
+
+    state->realbfr = (float*) fftwf_malloc(sizeof(float) * fft_len * howmany);
+    if (state->realbfr == NULL) return ERR_MALLOC;
+
+    if (real_mode == SQ_FFT_REAL_INPUT)
+        state->plan = fftwf_plan_many_dft_r2c(1, &n, howmany,
+                                              state->realbfr, NULL, 1, fft_len,
+                                              state->bfr, NULL, 1, fft_len, flags);
+    else
+        state->plan = fftwf_plan_many_dft_c2r(1, &n, howmany,
+                                              state->bfr, NULL, 1, fft_len,
+                                              state->realbfr, NULL, 1, fft_len, flags);
+
+    return 0;
+}
+
+static void reverse_real(float* buffer, unsigned int first, unsigned int last)
+{
+    float temp;
+
+    while (first < last)
+    {
+        temp = buffer[first];
+        buffer[first] = buffer[last];
+        buffer[last] = temp;
+        first++;
+        last--;
+    }
+}
+
+// the real counterpart of sq_channelunswap
+static void channelunswap_real(float* buffer, unsigned int length)
+{
+    unsigned int half = length / 2;
+
+    reverse_real(buffer, 0, half - 1);
+    reverse_real(buffer, half, length - 1);
+    reverse_real(buffer, 0, length - 1);
+}
+
+static void fft_buf_real(sq_fft_state* state)
+{
+    unsigned int n = state->length;
+    unsigned int i, k, rasteri;
+    float norm = 1.0f / n;
+    fftwf_complex* raster;
+
+    if (state->real_mode == SQ_FFT_REAL_INPUT)
+    {
+        // the inverse takes its input with the negative channels on the left
+        if (state->inverse)
+            for (rasteri = 0; rasteri < state->howmany; rasteri++)
+                channelunswap_real(&state->realbfr[rasteri * n], n);
+
+        fftwf_execute(state->plan);
+
+        for (rasteri = 0; rasteri < state->howmany; rasteri++)
+        {
+            raster = &state->bfr[rasteri * n];
+
+            // the transform of real data is Hermitian: X[n - k] = conj(X[k]);
+            // the inverse is the conjugate of the forward transform, over n
+            if (state->inverse)
+            {
+                for (k = 0; k <= n / 2; k++)
+                {
+                    raster[k][0] =  raster[k][0] * norm;
+                    raster[k][1] = -raster[k][1] * norm;
+                }
+            }
+            for (k = n / 2 + 1; k < n; k++)
+            {
+                raster[k][0] =  raster[n - k][0];
+                raster[k][1] = -raster[n - k][1];
+            }
+
+            if (!state->inverse)
+                sq_channelswap(raster, n);
+        }
+    }
+    else
+    {
+        for (rasteri = 0; rasteri < state->howmany; rasteri++)
+            sq_channelunswap(&state->bfr[rasteri * n], n);
+
+        fftwf_execute(state->plan);
+
+        for (i = 0; i < n * state->howmany; i++)
+            state->realbfr[i] *= norm;
+    }
+}
+
+void sq_fft_buf(sq_fft_state* state)
+{
+    unsigned int in_length = state->length;
+    unsigned int total_length = state->length * state->howmany;
+    unsigned int i, rasteri;
+
+    if (state->real_mode)
+    {
+        fft_buf_real(state);
+        return;
+    }
+
+    // for even lengths, premodulated data needs no channel swap
+    unsigned char is_swapped = !(state->premodulated && !(in_length & 1));
+
+    if (state->is_conjugated)
+        for (i = 0; i < total_length; i++)
+            state->bfr[i][1] = -state->bfr[i][1];  // conjugate
+
+    if (state->inverse)
+    {
+        // move channels back to their original positions before the fft
+        // so  that ifft gets what it expects
+        if (is_swapped)
+            for (rasteri = 0; rasteri < state->howmany; rasteri++)
+                sq_channelunswap(&state->bfr[rasteri * in_length], in_length);
+
+        // perform ifft
+        fftwf_execute(state->plan);
+
+        // fft (effectively) multiples output by N, so take this out
+        float norm = 1.0f / in_length; // multiplies are faster than divides
+        for (i = 0; i < total_length; i++)
+        {
+            state->bfr[i][0] = state->bfr[i][0] * norm;
+            state->bfr[i][1] = state->bfr[i][1] * norm;
+        }
+
+        // swapping the input of the ifft is the same as premodulating its output
+        if (!is_swapped)
+            sq_premodulate(state->bfr, total_length);
+    }
+    else
+    {
+        // perform fft
+        fftwf_execute(state->plan);
+
+        // write negative channels on the left, and then positive channels on the right
+        if (is_swapped)
+            for (rasteri = 0; rasteri < state->howmany; rasteri++)
+                sq_channelswap(&state->bfr[rasteri * in_length], in_length);
+    }
+}
+
+int sq_fft_set_threads(unsigned int nthreads)
+{
+#ifdef HAVE_FFTW_THREADS
+    static int threads_initialized = 0;
+
+    if (!threads_initialized)
+    {
+        if (!fftwf_init_threads())
+            return ERR_UNKNOWN_OPTION;
+        threads_initialized = 1;
+    }
+    fftwf_plan_with_nthreads(nthreads < 1 ? 1 : nthreads);
+#else
+    if (nthreads > 1)
+        sq_error_print("Warning: built without FFTW threads, using 1 thread.\n");
+#endif
+    return 0;
+}
+
+int sq_fft_import_wisdom(const char* filename)
+{
+    FILE* stream;
+
+    // a file that is not there is not an error of the wisdom in it
+    stream = fopen(filename, "r");
+    if (stream == NULL)
+        return ERR_STREAM_OPEN;
+    fclose(stream);
+
+    if (!fftwf_import_wisdom_from_filename(filename))
+        return ERR_STREAM_READ;
+    return 0;
+}
+
+int sq_fft_export_wisdom(const char* filename)
+{
+    if (!fftwf_export_wisdom_to_filename(filename))
+        return ERR_STREAM_WRITE;
+    return 0;
+}
+
+// makes and drops the plans of one shape, as sq_fft_init (or with is_real,
+// sq_fft_init_real) would make them, in both directions
+static void plan_shape(fftwf_complex* fft_bfr, float* real_bfr, unsigned int fft_len,
+                       unsigned int howmany, unsigned char is_real, unsigned int flags)
+{
+    fftwf_plan plan;
+    int n = fft_len;
+
+    if (is_real)
+    {
+        plan = fftwf_plan_many_dft_r2c(1, &n, howmany,
+                                       real_bfr, NULL, 1, fft_len,
+                                       fft_bfr, NULL, 1, fft_len, flags);
+        fftwf_destroy_plan(plan);
+        plan = fftwf_plan_many_dft_c2r(1, &n, howmany,
+                                       fft_bfr, NULL, 1, fft_len,
+                                       real_bfr, NULL, 1, fft_len, flags);
+        fftwf_destroy_plan(plan);
+    }
+    else if (howmany == 1)
+    {
+        plan = fftwf_plan_dft_1d(fft_len, fft_bfr, fft_bfr, FFTW_FORWARD, flags);
+        fftwf_destroy_plan(plan);
+        plan = fftwf_plan_dft_1d(fft_len, fft_bfr, fft_bfr, FFTW_BACKWARD, flags);
+        fftwf_destroy_plan(plan);
+    }
+    else
+    {
+        plan = fftwf_plan_many_dft(1, &n, howmany,
+                                   fft_bfr, NULL, 1, fft_len,
+                                   fft_bfr, NULL, 1, fft_len,
+                                   FFTW_FORWARD, flags);
+        fftwf_destroy_plan(plan);
+        plan = fftwf_plan_many_dft(1, &n, howmany,
+                                   fft_bfr, NULL, 1, fft_len,
+                                   fft_bfr, NULL, 1, fft_len,
+                                   FFTW_BACKWARD, flags);
+        fftwf_destroy_plan(plan);
+    }
+}
+
+int sq_fft_plan_lengths(unsigned int min_len, unsigned int max_len, unsigned int howmany,
+                        unsigned char is_real, unsigned char is_patient)
+{
+    if (!((min_len >= 2) && (min_len <= max_len) && (max_len <= MAX_SMPLS_LEN)))
+    {
+        fprintf(stderr, "Array lengths must be between 2 and %u\n", MAX_SMPLS_LEN);
+        return ERR_ARG_BOUNDS;
+    }
+    if (!((howmany >= 1) && ((uint64_t) howmany * min_len <= MAX_SMPLS_LEN)))
+    {
+        fprintf(stderr, "Batch of rasters must hold between 1 and %u samples\n", MAX_SMPLS_LEN);
+        return ERR_ARG_BOUNDS;
+    }
+
+    fftwf_complex *fft_bfr;
+    float *real_bfr = NULL;
+    unsigned int fft_len;
+    unsigned int bfr_len = max_len;
+    unsigned int flags = (is_patient ? FFTW_PATIENT : FFTW_MEASURE);
+    unsigned char is_batched;
+    char message[64];
+
+    // the largest batch that fits decides the buffer size
+    for (fft_len = min_len; fft_len <= max_len; fft_len <<= 1)
+    {
+        if ((uint64_t) howmany * fft_len <= MAX_SMPLS_LEN)
+            bfr_len = (howmany * fft_len > bfr_len) ? (howmany * fft_len) : bfr_len;
+        if (fft_len > max_len / 2)
+            break;
+    }
+
+    fft_bfr = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * bfr_len);
+    if (fft_bfr == NULL) return ERR_MALLOC;
+
+    if (is_real)
+    {
+        real_bfr = (float*) fftwf_malloc(sizeof(float) * bfr_len);
+        if (real_bfr == NULL)
+        {
+            fftwf_free(fft_bfr);
+            return ERR_MALLOC;
+        }
+    }
+
+    // plans are in-place (out-of-place for real data), exactly as the blocks
+    // make them, so that the wisdom matches the plans they ask for
+    for (fft_len = min_len; fft_len <= max_len; fft_len <<= 1)
+    {
+        sprintf(message, "Planning length %u", fft_len);
+        write_log(message, stderr);
+
+        // batched shape of sqfft -b, for every length whose batch fits
+        is_batched = (howmany > 1) && ((uint64_t) howmany * fft_len <= MAX_SMPLS_LEN);
+
+        plan_shape(fft_bfr, real_bfr, fft_len, 1, 0, flags);
+        if (is_batched)
+            plan_shape(fft_bfr, real_bfr, fft_len, howmany, 0, flags);
+
+        // real input and output of sqfft -r/-R
+        if (is_real)
+        {
+            plan_shape(fft_bfr, real_bfr, fft_len, 1, 1, flags);
+            if (is_batched)
+                plan_shape(fft_bfr, real_bfr, fft_len, howmany, 1, flags);
+        }
+
+        if (fft_len > max_len / 2)
+            break;
+    }
+
+    fftwf_free(fft_bfr);
+    if (real_bfr != NULL)
+        fftwf_free(real_bfr);
+
+    return 0;
+}
+
+void sq_fft_free(sq_fft_state* state)
+{
+    fftwf_destroy_plan(state->plan);
+    fftwf_free(state->bfr);
+    if (state->realbfr != NULL)
+        fftwf_free(state->realbfr);
+}
+
+int sq_wola_init(sq_wola_state* state, unsigned int in_length, unsigned int folds, unsigned int overlap)
+{
+    if (!((in_length >= 2) && (in_length <= MAX_ZOOM_LEN)))
+    {
+        fprintf(stderr, "Zoom length must be between 2 and %u\n", MAX_ZOOM_LEN);
+        return ERR_ARG_BOUNDS;
+    }
+    if (folds < 1)
+    {
+        sq_error_print("Number of folds must be greater than 1.\n");
+        return ERR_ARG_BOUNDS;
+    }
+    if (overlap >= 100)
+    {
+        sq_error_print("Overlap must be a percentage in range [0, 100).\n");
+        return ERR_ARG_BOUNDS;
+    }
+
+    state->in_length = in_length;
+    state->wndwlen = folds * in_length;
+    state->smpli = 0;
+    state->filled = 0;
+
+    state->readlen = (unsigned int)(((uint64_t) in_length * (100 - overlap)) / 100);
+    if (state->readlen < 1)
+        state->readlen = 1;
+
+    // a second history's worth of room means the history slides back to the
+    // start once every wndwlen samples, i.e. one extra copy per sample
+    state->capacity = 2 * state->wndwlen;
+
+    state->wndwbfr = malloc(state->wndwlen * sizeof(float));
+    if (state->wndwbfr == NULL) return ERR_MALLOC;
+
+    state->smplbfr = malloc((size_t) state->capacity * sizeof(cmplx));
+    if (state->smplbfr == NULL) return ERR_MALLOC;
+
+    init_window(state->wndwbfr, state->wndwlen, folds);
+
+    return 0;
+}
+
+void sq_wola_push(sq_wola_state* state, const cmplx* in, unsigned int n)
+{
+    unsigned int keep;
+    unsigned int end = state->smpli + state->filled;
+
+    if (n >= state->wndwlen)
+    {
+        memcpy(state->smplbfr, &in[n - state->wndwlen], state->wndwlen * sizeof(cmplx));
+        state->smpli = 0;
+        state->filled = state->wndwlen;
+        return;
+    }
+
+    // out of room: slide the samples that stay in the history to the start
+    if (end + n > state->capacity)
+    {
+        keep = state->filled;
+        if (keep > state->wndwlen - n)
+            keep = state->wndwlen - n;
+        memmove(state->smplbfr, &state->smplbfr[end - keep], keep * sizeof(cmplx));
+        state->smpli = 0;
+        state->filled = keep;
+        end = keep;
+    }
+
+    memcpy(&state->smplbfr[end], in, n * sizeof(cmplx));
+    state->filled += n;
+    if (state->filled > state->wndwlen)
+    {
+        state->smpli += state->filled - state->wndwlen;
+        state->filled = state->wndwlen;
+    }
+}
+
+void sq_wola_buf(sq_wola_state* state, cmplx* out)
+{
+    unsigned int foldi, ffti;
+    unsigned int folds = state->wndwlen / state->in_length;
+    const cmplx* hist = &state->smplbfr[state->smpli];
+    const float* wndw;
+    float re, im;
+
+    // polyphase form: raster sample ffti is the sum over the folds of
+    // window[k] * history[k], for k = ffti, ffti + in_length, ...
+    for (ffti = sq_simd_wola_fold(state->wndwbfr, hist, out, state->in_length, folds);
+         ffti < state->in_length; ffti++)
+    {
+        wndw = &state->wndwbfr[ffti];
+        re = wndw[0] * hist[ffti][0];
+        im = wndw[0] * hist[ffti][1];
+        for (foldi = 1; foldi < folds; foldi++)
+        {
+            re += wndw[foldi * state->in_length] * hist[foldi * state->in_length + ffti][0];
+            im += wndw[foldi * state->in_length] * hist[foldi * state->in_length + ffti][1];
+        }
+        out[ffti][0] = re;
+        out[ffti][1] = im;
+    }
+}
+
+void sq_wola_free(sq_wola_state* state)
+{
+    free(state->smplbfr);
+    free(state->wndwbfr);
+}
+
+// converts radians to a fraction of a turn, in 2^-64 turns
+static uint64_t nco_turns(double radians)
+{
+    double turns = radians / (2.0 * M_PI);
+    double frac = ldexp(turns - floor(turns), 64);
+
+    // frac can round up to a whole turn
+    return (frac >= ldexp(1.0, 64)) ? 0 : (uint64_t) frac;
+}
+
+int sq_nco_init(sq_nco_state* state, double radians, double phase)
+{
+    unsigned int blocki;
+    double angle;
+
+    state->phase = nco_turns(phase);
+    state->step = nco_turns(radians);
+
+    state->phasors = NULL;
+    state->table = malloc(2 * NCO_BLOCK * sizeof(double));
+    if (state->table == NULL) return ERR_MALLOC;
+
+    state->phasors = malloc(NCO_BLOCK * sizeof(cmplx));
+    if (state->phasors == NULL) return ERR_MALLOC;
+
+    // each offset from its own integer phase, so the table has no
+    // accumulated error either
+    for (blocki = 0; blocki < NCO_BLOCK; blocki++)
+    {
+        angle = ldexp((double)((uint64_t) blocki * state->step), -64) * 2.0 * M_PI;
+        state->table[2*blocki] = cos(angle);
+        state->table[2*blocki + 1] = sin(angle);
+    }
+
+    return 0;
+}
+
+void sq_nco_free(sq_nco_state* state)
+{
+    free(state->table);
+    free(state->phasors);
+    state->table = NULL;
+    state->phasors = NULL;
 }
@@ -31,6 +31,95 @@
 #define SQ_DSP_H
 
 #include <stdio.h>
+#include <fftw3.h>
+
+#include "sq_constants.h"
+
+// integration modes of sq_integrate
+#define SQ_SUM_BLOCK 0
+#define SQ_SUM_BOXCAR 1
+#define SQ_SUM_EMA 2
+
+// flags of sq_integrate
+#define SQ_SUM_KAHAN 1
+#define SQ_SUM_PARTIAL 2
+
+// real_mode flags of an FFT stage
+#define SQ_FFT_REAL_INPUT 1
+#define SQ_FFT_REAL_OUTPUT 2
+
+/**
+ * State of an FFT stage; the plan is made once and reused for every batch
+ * of rasters that is transformed in the buffer.
+ */
+typedef struct
+{
+    fftwf_plan plan;
+    fftwf_complex* bfr;
+    unsigned int length;
+    unsigned int howmany;
+    unsigned char is_conjugated;
+    unsigned char inverse;
+    // set by the caller when sample n of the input has already been
+    // multiplied by (-1)^n (see sq_premodulate); for even lengths the
+    // channel swap is then skipped (forward) or folded into the
+    // normalization (inverse)
+    unsigned char premodulated;
+    // SQ_FFT_REAL_INPUT: rasters of fft_len real samples are taken from
+    // realbfr (r2c transform). SQ_FFT_REAL_OUTPUT: the inverse of a
+    // Hermitian spectrum in bfr is written to realbfr (c2r transform).
+    unsigned char real_mode;
+    float* realbfr;
+} sq_fft_state;
+
+/**
+ * State of a weighted overlap-add window stage. Samples are appended to a
+ * history of folds * in_length samples, kept contiguous (oldest first) at
+ * smplbfr[smpli]; once it is full, each call to sq_wola_buf folds it into
+ * one raster of in_length samples, as a polyphase sum over the folds.
+ */
+typedef struct
+{
+    float* wndwbfr;
+    cmplx* smplbfr;
+    unsigned int in_length;
+    unsigned int wndwlen;
+    unsigned int readlen;
+    unsigned int smpli;
+    unsigned int filled;
+    // room in smplbfr; the history slides back to the start when it runs out
+    unsigned int capacity;
+} sq_wola_state;
+
+/**
+ * State of a numerically controlled oscillator, e^(i * phase). The phase
+ * is kept as an integer fraction of a turn, so it does not drift however
+ * long the stream. The oscillator is generated a block at a time: a phasor
+ * for the start of the block, from the exact phase, times a table of the
+ * phasors of the offsets within the block.
+ */
+typedef struct
+{
+    // phase of the next sample, and its advance per sample, in 2^-64 turns
+    uint64_t phase;
+    uint64_t step;
+    // e^(i * k * step) for each offset k in a block, in double precision
+    double* table;
+    cmplx* phasors;
+} sq_nco_state;
+
+/**
+ * Coefficients of a complex affine stage, y = a * x + b, where x is the
+ * input sample or, if is_conjugated is set, its conjugate. Scaling,
+ * rotation, DC offset and conjugation are all special cases, so a chain
+ * of them can run as one pass over the samples.
+ */
+typedef struct
+{
+    cmplx a;
+    cmplx b;
+    unsigned char is_conjugated;
+} sq_affine_state;
 
 /**
  * Takes a stream of floats (alternating real, imaginary) as input signal
@@ -95,6 +184,91 @@ int sq_fft(FILE* instream, FILE* outstream,
            unsigned char inverse
           );
 
+/**
+ * Same as sq_fft, but transforms batch rasters per read with one plan and
+ * lets FFTW split each transform over nthreads threads.
+ * @param instream Input stream of float data in the time domain
+ * @param outstream Output stream of float data in the frequency domain
+ * @param fft_len The length of the FFT
+ * @param nthreads Number of threads FFTW may use; 1 for a single-threaded transform
+ * @param batch Number of rasters transformed per read
+ */
+int sq_fft_batch(FILE* instream, FILE* outstream,
+                 unsigned int fft_len,
+                 unsigned char is_inverted,
+                 unsigned char is_measured,
+                 unsigned char inverse,
+                 unsigned int nthreads,
+                 unsigned int batch
+                );
+
+/**
+ * Same as sq_fft_batch, for real data in the compact real stream format
+ * (one float per sample, as written by sqreal). With SQ_FFT_REAL_INPUT
+ * each raster of real samples is transformed with half the work of a
+ * complex FFT, and the full complex spectrum is written as sq_fft would.
+ * With SQ_FFT_REAL_OUTPUT (inverse only) the input spectrum is taken to be
+ * Hermitian, as that of a real signal, and the real result is written.
+ * @param instream Input stream
+ * @param outstream Output stream
+ * @param fft_len The length of the FFT
+ * @param is_measured If 1, measure the plan instead of estimating it
+ * @param inverse If 1, compute the inverse transform
+ * @param real_mode SQ_FFT_REAL_INPUT or SQ_FFT_REAL_OUTPUT
+ * @param nthreads Number of threads FFTW may use
+ * @param batch Number of rasters transformed per read
+ * @return Code; negative if error.
+ */
+int sq_fft_real(FILE* instream, FILE* outstream,
+                unsigned int fft_len,
+                unsigned char is_measured,
+                unsigned char inverse,
+                unsigned char real_mode,
+                unsigned int nthreads,
+                unsigned int batch
+               );
+
+/**
+ * Sets the number of threads used by FFT plans made from now on. This has
+ * no effect if SETIkit was built without the FFTW threads library.
+ * @param nthreads Number of threads
+ * @return Code; negative if error.
+ */
+int sq_fft_set_threads(unsigned int nthreads);
+
+/**
+ * Loads FFTW wisdom from a file, so that later FFT_MEASURE plans of the
+ * same lengths are made without measuring again. Call sq_fft_set_threads
+ * first: FFTW only accepts wisdom made with the same solvers registered.
+ * @param filename Path of the wisdom file
+ * @return Code; ERR_STREAM_OPEN if there is no such file, ERR_STREAM_READ
+ *         if FFTW rejected the wisdom in it.
+ */
+int sq_fft_import_wisdom(const char* filename);
+
+/**
+ * Saves the wisdom accumulated by all plans made so far to a file.
+ * @param filename Path of the wisdom file
+ * @return Code; negative if the file could not be written.
+ */
+int sq_fft_export_wisdom(const char* filename);
+
+/**
+ * Makes measured forward and inverse plans for every power-of-two length
+ * between min_len and max_len, so that their wisdom can be exported.
+ * @param min_len Smallest FFT length
+ * @param max_len Largest FFT length
+ * @param howmany If above 1, also plan batches of this many transforms,
+ *        as sq_fft_init does; lengths whose batch exceeds MAX_SMPLS_LEN
+ *        get only the single-transform plans
+ * @param is_real If 1, also plan the real-input and real-output
+ *        transforms of sq_fft_init_real
+ * @param is_patient If 1, plan with FFTW_PATIENT instead of FFTW_MEASURE
+ * @return Code; negative if error.
+ */
+int sq_fft_plan_lengths(unsigned int min_len, unsigned int max_len, unsigned int howmany,
+                        unsigned char is_real, unsigned char is_patient);
+
 /**
  * Takes a signal and adds a complex DC offset to it.
  * @param instream Input stream of float data
@@ -138,6 +312,17 @@ int sq_scaleandrotate(FILE* instream, FILE* outstream,
                       float scale_factor,
                       float radians );
 
+/**
+ * Maps each sample of a signal through a complex affine stage (see
+ * sq_affine_state).
+ * @param instream Input stream of float data
+ * @param outstream Output stream of float data
+ * @param in_length Number of samples to process at a time
+ * @param state Coefficients of the stage, e.g. from sq_affine_init
+ * @return Code; negative if error.
+ */
+int sq_affine(FILE* instream, FILE* outstream, unsigned int in_length, const sq_affine_state* state);
+
 /**
  * Scales the input signal by a given factor.
  * @param instream Input stream of float data
@@ -161,9 +346,9 @@ int sq_rotate(FILE* instream, FILE* outstream, unsigned int in_length, float rad
  * this routine is useful for shifting the signal to the left/right by a tunable amount.
  * @param instream Input stream of float data
  * @param outstream Output stream of float data
- * @param radians Frequency to be centered
+ * @param radians Frequency to be centered, in radians per sample
  */
-int sq_mix(FILE* instream, FILE* outstream, unsigned int in_length, float radians);
+int sq_mix(FILE* instream, FILE* outstream, unsigned int in_length, double radians);
 
 /**
  * Weighted Overlap-Add window
@@ -171,7 +356,8 @@ int sq_mix(FILE* instream, FILE* outstream, unsigned int in_length, float radian
  * @param outstream Output stream of float data
  * @param fftlen Length of FFT to be used
  * @param folds Number of folds
- * @param overlap Window overlap %
+ * @param overlap Window overlap %, in [0, 100); each raster advances by
+ *                fftlen * (100 - overlap) / 100 samples
  * @param is_window_dump If 1, writes the window itself to the output stream. If 0, proceeds to write the windowed data to the output stream.
  */
 int sq_wola(FILE* instream, FILE* outstream,
@@ -227,6 +413,7 @@ int sq_fftflip(FILE* instream, FILE* outstream, unsigned int in_length);
 
 /**
  * Bins the specified number of contiguous samples from the input stream into a new (smaller) specified number of samples
+ * by averaging them. The ratio of the lengths need not be an integer; see sq_bin_buf.
  * @param instream Input stream of float data
  * @param outstream Output stream of float data
  * @param in_length Number of samples given as input to one binning iteration
@@ -237,7 +424,8 @@ int sq_bin(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int
 /**
  * Finds the peak value from a specified number n (bin-size) of contiguous samples from the input 
  * stream, outputting a new stream containing with N/n samples containing the max value in each
- * bin. Modeled after "peak hold" function of a spectrum analyzer.
+ * bin. Modeled after "peak hold" function of a spectrum analyzer. The ratio of the lengths need not
+ * be an integer; see sq_maxhold_buf.
  * @param instream Input stream of float data
  * @param outstream Output stream of float data
  * @param in_length Number of samples given as input to one max hold (binning) iteration
@@ -245,6 +433,26 @@ int sq_bin(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int
  */
 int sq_maxhold(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int out_length);
 
+/**
+ * Bins each raster into a pyramid of coarser rasters in one pass: level k,
+ * for k = 1 .. nlevels, has in_length / 2^k samples, each the average (as
+ * sq_bin) or the max-hold (as sq_maxhold) of 2^k input samples. Each level
+ * is made from the one before it, so the work per raster is about twice
+ * that of one sq_bin. A stream header on the input is copied to every
+ * output, with the raster length of its level.
+ * @param instream Input stream of float data, e.g. power spectra
+ * @param avgstreams Output streams of the averaged levels 1 .. nlevels; an
+ *                   entry may be NULL to skip a level, or the array NULL
+ *                   to skip averaging
+ * @param maxstreams Output streams of the max-held levels, like avgstreams
+ * @param in_length Number of samples in each raster; a multiple of 2^nlevels
+ * @param nlevels Number of levels
+ * @param is_real If 1, the streams are compact real streams; a stream header overrides it
+ * @return Code; negative if error.
+ */
+int sq_pyramid(FILE* instream, FILE** avgstreams, FILE** maxstreams,
+               unsigned int in_length, unsigned int nlevels, unsigned char is_real);
+
 /**
  * Chops out samples from the left or right hand side of the specified number of 
  * contiguous samples from the input stream, delivering to a new (smaller) specified 
@@ -262,7 +470,7 @@ int sq_sidechop(FILE* instream, FILE* outstream, unsigned int in_length, unsigne
 /** 
  * Sum N raster lines into one. This function reduces the number
  * of rasters produced by a factor of N. Note that this does a
- * sum and not an average.
+ * sum and not an average. The sums are kept in double precision.
  * @param instream Input stream of float data
  * @param outstream Output stream of float data
  * @param in_length the usual in_length, length of one raster line
@@ -270,6 +478,29 @@ int sq_sidechop(FILE* instream, FILE* outstream, unsigned int in_length, unsigne
  */
 int sq_sum(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int num_to_sum);
 
+/**
+ * Integrates rasters in double precision. SQ_SUM_BLOCK sums each block of
+ * num_to_sum rasters into one, as sq_sum does. SQ_SUM_BOXCAR writes, for
+ * every raster from the num_to_sum-th on, the sum of the last num_to_sum
+ * rasters; it adds the new raster and takes the oldest one back out, so
+ * the work per raster does not grow with the window, but it keeps the
+ * window in memory. SQ_SUM_EMA writes a leaky sum for every raster,
+ * sum = (1 - 1/num_to_sum) * sum + raster, an exponential moving average
+ * scaled to the level of a num_to_sum raster sum, in constant memory.
+ * If no raster would be written otherwise, the sum so far is written once.
+ * @param instream Input stream of float data
+ * @param outstream Output stream of float data
+ * @param in_length Number of samples in each raster
+ * @param num_to_sum Block length, window length or time constant, in rasters
+ * @param mode SQ_SUM_BLOCK, SQ_SUM_BOXCAR or SQ_SUM_EMA
+ * @param flags SQ_SUM_KAHAN for compensated sums (block and boxcar), and
+ *              SQ_SUM_PARTIAL to also write a short last block
+ * @param is_real If 1, the streams are compact real streams; a stream header overrides it
+ * @return Code; negative if error.
+ */
+int sq_integrate(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int num_to_sum,
+                 unsigned int mode, unsigned int flags, unsigned char is_real);
+
 /**
  * Discard samples on left and right of spectrum
  * @param instream Input stream of float data
@@ -317,4 +548,494 @@ int sq_phase(FILE* instream, FILE* outstream, unsigned int in_length);
  */
 int sq_overlap2x(FILE* instream, FILE* outstream, unsigned int in_length);
 
+/*
+ * Compact real streams. Stages whose output has no imaginary part can write
+ * one float per sample instead of a complex sample with a zero imaginary
+ * part, as sqreal does; the stages below read and write that format, which
+ * halves the bytes moved by everything downstream of the power stage.
+ */
+
+/**
+ * Same as sq_power, but writes one float per sample.
+ * @param instream Input stream of float data
+ * @param outstream Output stream of real float data
+ * @param in_length Number of samples to process at a time
+ * @return Code; negative if error.
+ */
+int sq_power_real(FILE* instream, FILE* outstream, unsigned int in_length);
+
+/**
+ * Same as sq_abs, but writes one float per sample.
+ * @param instream Input stream of float data
+ * @param outstream Output stream of real float data
+ * @param in_length Number of samples to process at a time
+ * @return Code; negative if error.
+ */
+int sq_abs_real(FILE* instream, FILE* outstream, unsigned int in_length);
+
+/**
+ * Same as sq_sum, for a real stream.
+ * @param instream Input stream of real float data
+ * @param outstream Output stream of real float data
+ * @param in_length Number of samples in each raster
+ * @param num_to_sum Number of rasters to add together
+ * @return Code; negative if error.
+ */
+int sq_sum_real(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int num_to_sum);
+
+/**
+ * Same as sq_bin, for a real stream.
+ * @param instream Input stream of real float data
+ * @param outstream Output stream of real float data
+ * @param in_length Number of input samples in each raster
+ * @param out_length Number of output samples in each raster
+ * @return Code; negative if error.
+ */
+int sq_bin_real(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int out_length);
+
+/**
+ * Same as sq_maxhold, for a real stream.
+ * @param instream Input stream of real float data
+ * @param outstream Output stream of real float data
+ * @param in_length Number of input samples in each raster
+ * @param out_length Number of output samples in each raster
+ * @return Code; negative if error.
+ */
+int sq_maxhold_real(FILE* instream, FILE* outstream, unsigned int in_length, unsigned int out_length);
+
+/**
+ * Same as sq_subavg, for a real stream.
+ * @param instream Input stream of real float data
+ * @param outstream Output stream of real float data
+ * @param in_length Number of samples in each raster
+ * @return Code; negative if error.
+ */
+int sq_subavg_real(FILE* instream, FILE* outstream, unsigned int in_length);
+
+/**
+ * Same as sq_offset, for a real stream.
+ * @param instream Input stream of real float data
+ * @param outstream Output stream of real float data
+ * @param in_length Number of samples to process at a time
+ * @param delta The DC offset
+ * @return Code; negative if error.
+ */
+int sq_offset_real(FILE* instream, FILE* outstream, unsigned int in_length, float delta);
+
+/*
+ * Buffer kernels. These work on caller-owned buffers that are already in
+ * memory and are the building blocks of the stream functions above and of
+ * the fused pipelines in sq_pipeline.
+ */
+
+/**
+ * Computes the instantaneous power of each complex sample.
+ * @param in Input complex samples
+ * @param out Output power values, one float per sample
+ * @param n Number of samples
+ */
+void sq_power_buf(const cmplx* in, float* out, unsigned int n);
+
+/**
+ * Multiplies each complex sample by the corresponding window coefficient.
+ * @param wndw Window coefficients
+ * @param in Input complex samples
+ * @param out Output complex samples; may be the same buffer as in
+ * @param n Number of samples
+ */
+void sq_window_buf(const float* wndw, const cmplx* in, cmplx* out, unsigned int n);
+
+/**
+ * Extracts the real or imaginary component of each complex sample.
+ * @param in Input complex samples
+ * @param out Output component values, one float per sample
+ * @param n Number of samples
+ * @param component The REAL (0) or IMAGINARY (1) component
+ */
+void sq_component_buf(const cmplx* in, float* out, unsigned int n, int component);
+
+/**
+ * Computes the absolute value of each complex sample.
+ * @param in Input complex samples
+ * @param out Output absolute values, one float per sample
+ * @param n Number of samples
+ */
+void sq_abs_buf(const cmplx* in, float* out, unsigned int n);
+
+/**
+ * Computes the power of each complex sample into the real part of the
+ * output sample, and zeroes its imaginary part.
+ * @param in Input complex samples
+ * @param out Output samples; may be the same buffer as in
+ * @param n Number of samples
+ */
+void sq_power_cmplx_buf(const cmplx* in, cmplx* out, unsigned int n);
+
+/**
+ * Computes the absolute value of each complex sample into the real part
+ * of the output sample, and zeroes its imaginary part.
+ * @param in Input complex samples
+ * @param out Output samples; may be the same buffer as in
+ * @param n Number of samples
+ */
+void sq_abs_cmplx_buf(const cmplx* in, cmplx* out, unsigned int n);
+
+/**
+ * Multiplies the samples of two signals pairwise.
+ * @param in1 Input complex samples of signal #1
+ * @param in2 Input complex samples of signal #2
+ * @param out Output products; may be the same buffer as in1 or in2
+ * @param n Number of samples
+ */
+void sq_crossmultiply_buf(const cmplx* in1, const cmplx* in2, cmplx* out, unsigned int n);
+
+/**
+ * Multiplies the samples of two signals pairwise, conjugating the second
+ * signal first if asked, and scales the products. With the spectra of two
+ * signals this is the multiply of an FFT correlation (or convolution), and
+ * scale can take the place of the normalization of the inverse transform.
+ * @param in1 Input complex samples of signal #1
+ * @param in2 Input complex samples of signal #2
+ * @param out Output products; may be the same buffer as in1 or in2
+ * @param n Number of samples
+ * @param is_conjugated If 1, multiply by the conjugate of signal #2
+ * @param scale Factor applied to every product
+ */
+void sq_crossmultiply_scale_buf(const cmplx* in1, const cmplx* in2, cmplx* out, unsigned int n,
+                                unsigned char is_conjugated, float scale);
+
+/**
+ * Adds the products of the samples of signal #1 and the conjugates of the
+ * samples of signal #2 to a running sum; the multiply-accumulate of a
+ * correlator. The products round exactly as sq_crossmultiply_buf of signal
+ * #1 and the output of sq_conjugate_buf would.
+ * @param in1 Input complex samples of signal #1
+ * @param in2 Input complex samples of signal #2
+ * @param sum Running sum that the products are added to
+ * @param n Number of samples
+ */
+void sq_crossmultiply_sum_buf(const cmplx* in1, const cmplx* in2, cmplx* sum, unsigned int n);
+
+/**
+ * Adds weighted floats to running double sums.
+ * @param in Input values
+ * @param sum Running sums that weight * in is added to
+ * @param comp Kahan compensation of each sum, zeroed with it; NULL for plain sums
+ * @param n Number of values
+ * @param weight Weight of the input values, e.g. -1 to take values back out
+ */
+void sq_accumulate_buf(const float* in, double* sum, double* comp, unsigned int n, double weight);
+
+/**
+ * Decays running double sums and adds floats to them.
+ * @param in Input values
+ * @param sum Running sums, set to decay * sum + in
+ * @param n Number of values
+ * @param decay Factor applied to the sums before adding
+ */
+void sq_leaky_accumulate_buf(const float* in, double* sum, unsigned int n, double decay);
+
+/**
+ * Adds a raster to a running sum.
+ * @param in Input complex samples
+ * @param sum Running sum that in is added to
+ * @param n Number of samples
+ */
+void sq_sum_buf(const cmplx* in, cmplx* sum, unsigned int n);
+
+/**
+ * Adds a complex DC offset to each sample.
+ * @param in Input complex samples
+ * @param out Output complex samples; may be the same buffer as in
+ * @param n Number of samples
+ * @param real_delta The real part of the DC offset
+ * @param imag_delta The imaginary part of the DC offset
+ */
+void sq_offset_buf(const cmplx* in, cmplx* out, unsigned int n, float real_delta, float imag_delta);
+
+/**
+ * Subtracts the average value of the raster from each sample.
+ * @param in Input complex samples
+ * @param out Output complex samples; may be the same buffer as in
+ * @param n Number of samples
+ */
+void sq_subavg_buf(const cmplx* in, cmplx* out, unsigned int n);
+
+/**
+ * Computes the complex conjugate of each sample.
+ * @param in Input complex samples
+ * @param out Output complex samples; may be the same buffer as in
+ * @param n Number of samples
+ */
+void sq_conjugate_buf(const cmplx* in, cmplx* out, unsigned int n);
+
+/**
+ * Multiplies each sample by R*exp(j*Theta).
+ * @param in Input complex samples
+ * @param out Output complex samples; may be the same buffer as in
+ * @param n Number of samples
+ * @param scale_factor The scaling factor R
+ * @param radians The phase Theta
+ */
+void sq_scaleandrotate_buf(const cmplx* in, cmplx* out, unsigned int n, float scale_factor, float radians);
+
+/**
+ * Sets the coefficients of an affine stage that conjugates the sample if
+ * is_conjugated is set, then multiplies it by R*exp(j*Theta), then adds a
+ * complex DC offset. The trigonometry is done here, once.
+ * @param state Affine state to initialize
+ * @param scale_factor The scaling factor R
+ * @param radians The phase Theta
+ * @param real_delta The real part of the DC offset
+ * @param imag_delta The imaginary part of the DC offset
+ * @param is_conjugated Whether the input is conjugated first
+ */
+void sq_affine_init(sq_affine_state* state, float scale_factor, float radians,
+                    float real_delta, float imag_delta, unsigned char is_conjugated);
+
+/**
+ * Maps each sample through a complex affine stage.
+ * @param state Coefficients of the stage
+ * @param in Input complex samples
+ * @param out Output complex samples; may be the same buffer as in
+ * @param n Number of samples
+ */
+void sq_affine_buf(const sq_affine_state* state, const cmplx* in, cmplx* out, unsigned int n);
+
+/**
+ * Multiplies the samples by the oscillator and advances its phase, so that
+ * consecutive calls are continuous.
+ * @param state An initialized oscillator
+ * @param in Input complex samples
+ * @param out Output complex samples; may be the same buffer as in
+ * @param n Number of samples
+ */
+void sq_mix_buf(sq_nco_state* state, const cmplx* in, cmplx* out, unsigned int n);
+
+/**
+ * Centers a raster between zeros in a longer raster.
+ * @param in Input complex samples
+ * @param in_length Number of input samples
+ * @param out Output complex samples; in may already point to the center of out
+ * @param out_length Number of output samples, must be >= in_length
+ */
+void sq_pad_buf(const cmplx* in, unsigned int in_length, cmplx* out, unsigned int out_length);
+
+/**
+ * Swaps the top half of the samples with the bottom half, in place.
+ * @param bfr Complex samples
+ * @param n Number of samples
+ */
+void sq_fftflip_buf(cmplx* bfr, unsigned int n);
+
+/**
+ * Averages contiguous bins of samples into a smaller number of samples.
+ * Bins are in_length/out_length samples wide, which need not be a whole
+ * number: a sample cut by a bin edge counts in each bin by the fraction of
+ * it that lies inside.
+ * @param in Input complex samples
+ * @param in_length Number of input samples
+ * @param out Output complex samples
+ * @param out_length Number of output samples
+ */
+void sq_bin_buf(const cmplx* in, unsigned int in_length, cmplx* out, unsigned int out_length);
+
+/**
+ * Keeps the sample of largest power from each bin of contiguous samples.
+ * Bins are in_length/out_length samples wide, and a sample cut by a bin
+ * edge is a candidate in both bins. Ties go to the first sample.
+ * @param in Input complex samples
+ * @param in_length Number of input samples
+ * @param out Output complex samples
+ * @param out_length Number of output samples
+ */
+void sq_maxhold_buf(const cmplx* in, unsigned int in_length, cmplx* out, unsigned int out_length);
+
+/**
+ * Adds a raster of real samples to a running sum.
+ * @param in Input real samples
+ * @param sum Running sum that in is added to
+ * @param n Number of samples
+ */
+void sq_sum_real_buf(const float* in, float* sum, unsigned int n);
+
+/**
+ * Adds a DC offset to each real sample.
+ * @param in Input real samples
+ * @param out Output real samples; may be the same buffer as in
+ * @param n Number of samples
+ * @param delta The DC offset
+ */
+void sq_offset_real_buf(const float* in, float* out, unsigned int n, float delta);
+
+/**
+ * Subtracts the average value of the raster from each real sample.
+ * @param in Input real samples
+ * @param out Output real samples; may be the same buffer as in
+ * @param n Number of samples
+ */
+void sq_subavg_real_buf(const float* in, float* out, unsigned int n);
+
+/**
+ * Averages contiguous bins of real samples into a smaller number of
+ * samples, with fractional bin edges as in sq_bin_buf.
+ * @param in Input real samples
+ * @param in_length Number of input samples
+ * @param out Output real samples
+ * @param out_length Number of output samples
+ */
+void sq_bin_real_buf(const float* in, unsigned int in_length, float* out, unsigned int out_length);
+
+/**
+ * Keeps the real sample of largest magnitude from each bin of contiguous
+ * samples, with bins as in sq_maxhold_buf.
+ * @param in Input real samples
+ * @param in_length Number of input samples
+ * @param out Output real samples
+ * @param out_length Number of output samples
+ */
+void sq_maxhold_real_buf(const float* in, unsigned int in_length, float* out, unsigned int out_length);
+
+/**
+ * Chops in_length - out_length samples from one side of a raster.
+ * @param in Input complex samples
+ * @param in_length Number of input samples
+ * @param out Output complex samples
+ * @param out_length Number of output samples
+ * @param side Either 'r' or 'l' (case insensitive), as for sq_sidechop
+ */
+void sq_sidechop_buf(const cmplx* in, unsigned int in_length, cmplx* out, unsigned int out_length, char side);
+
+/**
+ * Discards a fraction of the samples on both edges of a raster.
+ * @param in Input complex samples
+ * @param in_length Number of input samples
+ * @param out Output complex samples
+ * @param chop_fraction Fraction of the raster to discard on each edge
+ * @return Number of output samples
+ */
+unsigned int sq_chop_buf(const cmplx* in, unsigned int in_length, cmplx* out, float chop_fraction);
+
+/**
+ * Divides each sample by its absolute value. Samples of zero magnitude are
+ * passed through.
+ * @param in Input complex samples
+ * @param out Output phasors; may be the same buffer as in
+ * @param n Number of samples
+ */
+void sq_phase_buf(const cmplx* in, cmplx* out, unsigned int n);
+
+/**
+ * Allocates the FFT buffer and makes the plan of an FFT stage.
+ * @param state FFT state to initialize
+ * @param fft_len The length of the FFT
+ * @param is_conjugated If 1, conjugate the input before transforming
+ * @param is_measured If 1, measure the plan instead of estimating it
+ * @param inverse If 1, compute the inverse transform
+ * @return Code; negative if error.
+ */
+int sq_fft_init(sq_fft_state* state,
+                unsigned int fft_len,
+                unsigned char is_conjugated,
+                unsigned char is_measured,
+                unsigned char inverse);
+
+/**
+ * Same as sq_fft_init, but plans howmany contiguous rasters as one batch.
+ * @param state FFT state to initialize
+ * @param fft_len The length of the FFT
+ * @param howmany Number of rasters in state->bfr
+ * @param is_conjugated If 1, conjugate the input before transforming
+ * @param is_measured If 1, measure the plan instead of estimating it
+ * @param inverse If 1, compute the inverse transform
+ * @return Code; negative if error.
+ */
+int sq_fft_init_many(sq_fft_state* state,
+                     unsigned int fft_len,
+                     unsigned int howmany,
+                     unsigned char is_conjugated,
+                     unsigned char is_measured,
+                     unsigned char inverse);
+
+/**
+ * Same as sq_fft_init_many, for a real-input or real-output transform
+ * (see sq_fft_real). Real samples go in or come out of state->realbfr,
+ * which holds howmany rasters of fft_len floats.
+ * @param state FFT state to initialize
+ * @param fft_len The length of the FFT
+ * @param howmany Number of rasters
+ * @param is_measured If 1, measure the plan instead of estimating it
+ * @param inverse If 1, compute the inverse transform
+ * @param real_mode SQ_FFT_REAL_INPUT or SQ_FFT_REAL_OUTPUT
+ * @return Code; negative if error.
+ */
+int sq_fft_init_real(sq_fft_state* state,
+                     unsigned int fft_len,
+                     unsigned int howmany,
+                     unsigned char is_measured,
+                     unsigned char inverse,
+                     unsigned char real_mode);
+
+/**
+ * Transforms the raster(s) held in state->bfr in place. Forward output is
+ * arranged with the negative channels on the left, as sq_fft writes it.
+ * In the real modes the real side of the transform is state->realbfr.
+ * @param state An initialized FFT state
+ */
+void sq_fft_buf(sq_fft_state* state);
+
+/**
+ * Destroys the plan and frees the buffer of an FFT stage.
+ * @param state FFT state
+ */
+void sq_fft_free(sq_fft_state* state);
+
+/**
+ * Allocates the window and history of a weighted overlap-add stage.
+ * @param state WOLA state to initialize
+ * @param fftlen Length of FFT to be used
+ * @param folds Number of folds
+ * @param overlap Window overlap %
+ * @return Code; negative if error.
+ */
+int sq_wola_init(sq_wola_state* state, unsigned int fftlen, unsigned int folds, unsigned int overlap);
+
+/**
+ * Appends samples to the history of a WOLA stage; only the newest
+ * state->wndwlen samples are kept.
+ * @param state An initialized WOLA state
+ * @param in Input complex samples
+ * @param n Number of samples; normally state->readlen once the history is full
+ */
+void sq_wola_push(sq_wola_state* state, const cmplx* in, unsigned int n);
+
+/**
+ * Weights and folds the current history into one raster. Only valid once
+ * state->filled has reached state->wndwlen.
+ * @param state An initialized WOLA state
+ * @param out Output raster of state->in_length complex samples
+ */
+void sq_wola_buf(sq_wola_state* state, cmplx* out);
+
+/**
+ * Frees the window and history of a WOLA stage.
+ * @param state WOLA state
+ */
+void sq_wola_free(sq_wola_state* state);
+
+/**
+ * Allocates the phasor tables of an oscillator.
+ * @param state Oscillator state to initialize
+ * @param radians Frequency, in radians per sample
+ * @param phase Phase of the first sample, in radians
+ * @return Code; negative if error.
+ */
+int sq_nco_init(sq_nco_state* state, double radians, double phase);
+
+/**
+ * Frees the phasor tables of an oscillator.
+ * @param state Oscillator state
+ */
+void sq_nco_free(sq_nco_state* state);
+
 #endif
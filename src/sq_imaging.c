@@ -31,9 +31,22 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 #include "sq_imaging.h"
 #include "sq_constants.h"
+#include "sq_simd.h"
+
+// values per block of sq_amp_stats; a block's moments are taken about its first amplitude
+#define AMP_STATS_BLOCK 1024
 
 int sq_alloc_img(float* img_buf, int rows, int cols)
 {
@@ -47,125 +60,347 @@ int sq_no_scale(float* img_buf, int rows, int cols)
 
 }
 
-int sq_linear_scale(float* img_buf, int rows, int cols)
+void sq_amp_stats_add(sq_img_stats* stats, const float* buf, unsigned int n, float offset)
 {
-    unsigned int imgi;
+    unsigned int smpli, blki, blkn;
+    const float* blk;
+    double shift, sum, sumsq, amp;
+    double blkmean, blkm2, delta;
 
-    float imgvalf;
+    if (n == 0)
+        return;
 
-    float min = img_buf[0];
-    float max = img_buf[0];
+    if (stats->count == 0)
+    {
+        stats->min = buf[0];
+        stats->max = buf[0];
+    }
 
-    for (imgi = 0; imgi < (rows * cols); imgi++)
+    for (blki = 0; blki < n; blki += blkn)
     {
-        if (img_buf[imgi] < min) min = img_buf[imgi];
-        if (img_buf[imgi] > max) max = img_buf[imgi];
+        blk = &buf[blki];
+        blkn = ((n - blki) < AMP_STATS_BLOCK) ? (n - blki) : AMP_STATS_BLOCK;
+
+        // shifted sums keep the block variance exact in double precision
+        shift = sqrtf(blk[0] - offset);
+        sum = 0.0;
+        sumsq = 0.0;
+        smpli = sq_simd_amp_moments(blk, blkn, offset, shift, &sum, &sumsq, &stats->min, &stats->max);
+        for (; smpli < blkn; smpli++)
+        {
+            if (blk[smpli] < stats->min) stats->min = blk[smpli];
+            if (blk[smpli] > stats->max) stats->max = blk[smpli];
+            amp = sqrtf(blk[smpli] - offset) - shift;
+            sum += amp;
+            sumsq += amp * amp;
+        }
+        blkmean = shift + (sum / blkn);
+        blkm2 = sumsq - ((sum * sum) / blkn);
+
+        // merge the block into the running mean and sum of squared deviations
+        stats->count += blkn;
+        delta = blkmean - stats->mean;
+        stats->mean += delta * blkn / stats->count;
+        stats->m2 += blkm2 + (delta * delta * ((double) (stats->count - blkn) * blkn / stats->count));
     }
 
-    for (imgi = 0; imgi < (rows * cols); imgi++)
+    stats->stddev = (stats->m2 > 0.0) ? sqrt(stats->m2 / stats->count) : 0.0;
+}
+
+void sq_amp_stats(const float* img_buf, int rows, int cols, int stride, float offset, sq_img_stats* stats)
+{
+    int rowi;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!((rows > 0) && (cols > 0)))
+        return;
+
+    for (rowi = 0; rowi < rows; rowi++)
+        sq_amp_stats_add(stats, &img_buf[(size_t) rowi * stride], cols, offset);
+}
+
+// maps the bits of a float to a key that sorts like the float, and back
+static uint32_t hist_order(float val)
+{
+    uint32_t bits;
+
+    memcpy(&bits, &val, sizeof(bits));
+    return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+}
+
+static float hist_value(uint32_t key)
+{
+    uint32_t bits = (key & 0x80000000) ? (key & 0x7fffffff) : ~key;
+    float val;
+
+    memcpy(&val, &bits, sizeof(val));
+    return val;
+}
+
+int sq_hist_init(sq_img_hist* hist)
+{
+    hist->count = 0;
+    hist->bins = calloc(SQ_HIST_BINS, sizeof(uint64_t));
+    if (hist->bins == NULL)
+        return ERR_MALLOC;
+    return 0;
+}
+
+void sq_hist_add(sq_img_hist* hist, const float* buf, unsigned int n)
+{
+    unsigned int smpli;
+
+    for (smpli = 0; smpli < n; smpli++)
     {
-        imgvalf = img_buf[imgi];
-        imgvalf -= min;
-        imgvalf *= ((float) MAX_PIXEL_VAL) / (max - min);
-        img_buf[imgi] = imgvalf;
+        if (buf[smpli] != buf[smpli])
+            continue;
+        hist->bins[hist_order(buf[smpli]) >> 16]++;
+        hist->count++;
     }
 }
 
-int sq_amp_scale(float* img_buf, int rows, int cols)
+float sq_hist_percentile(const sq_img_hist* hist, double pct)
 {
-    unsigned int imgi;
-    float imgvalf;
+    uint64_t cum = 0;
+    unsigned int bini;
+    double rank, frac;
+    float lo, hi;
 
-    float mean, stddev;
-    float min, max;
+    if (hist->count == 0)
+        return 0.0;
 
-    // note image comes in in the power domain
-    min = img_buf[0];
+    if (pct < 0.0) pct = 0.0;
+    if (pct > 100.0) pct = 100.0;
+    rank = (pct / 100.0) * (hist->count - 1);
 
-    // compute the minimum value
-    for (imgi = 0; imgi < (rows * cols); imgi++)
-        if (img_buf[imgi] < min) min = img_buf[imgi];
+    for (bini = 0; bini < SQ_HIST_BINS; bini++)
+    {
+        if ((cum + hist->bins[bini]) > rank)
+            break;
+        cum += hist->bins[bini];
+    }
+    if (bini == SQ_HIST_BINS)
+        bini = SQ_HIST_BINS - 1;
 
-    // don't want errors about taking sqrt of negative numbers! subtract off min
-    for (imgi = 0; imgi < (rows * cols); imgi++)
-       img_buf[imgi] -= min;
+    // spread the values of the bin evenly over its width
+    lo = hist_value(bini << 16);
+    hi = hist_value((bini << 16) | 0xffff);
+    frac = (rank - cum + 0.5) / hist->bins[bini];
+    if (frac > 1.0) frac = 1.0;
+    if (!isfinite(hi) || !isfinite(lo))
+        return lo;
 
-    // compute mean value of AMPLITUDE (not power)
-    mean = 0.0;
-    for (imgi = 0; imgi < (rows * cols); imgi++)
-        mean += sqrt(img_buf[imgi]);
-    mean /= (rows * cols);
+    return lo + ((hi - lo) * frac);
+}
 
-    // compute variance of Amplitude
-    stddev = 0.0;
-    for (imgi = 0; imgi < (rows * cols); imgi++)
-        stddev += (sqrt(img_buf[imgi]) - mean) * (sqrt(img_buf[imgi]) - mean);
-    stddev = sqrt(stddev / (rows * cols));
+void sq_hist_free(sq_img_hist* hist)
+{
+    free(hist->bins);
+    hist->bins = NULL;
+}
 
-    // convert min/max to power levels (is this the right way to go?)
-    min = mean - stddev;
-    if (min < 0.0) min = 0.0;
-    max = mean + (STD_THRESH * stddev);
+int sq_scaler_init(sq_img_scaler* scaler, unsigned int mode, double low, double high)
+{
+    memset(scaler, 0, sizeof(*scaler));
+    scaler->mode = mode;
+    scaler->low = low;
+    scaler->high = high;
 
-    // scale image to min=0, max=MAX_PIXEL_VAL
-    for (imgi = 0; imgi < (rows * cols); imgi++)
+    switch (mode)
     {
-        imgvalf = img_buf[imgi]; // convert to floating point
-	imgvalf = sqrt(imgvalf);
-        imgvalf -= min;
-        imgvalf *= ((float) MAX_PIXEL_VAL) / (max - min);
-        img_buf[imgi] = imgvalf;
+        case SQ_SCALE_NONE:
+            scaler->min = 0.0;
+            scaler->max = MAX_PIXEL_VAL;
+            scaler->is_ready = 1;
+            break;
+        case SQ_SCALE_FIXED:
+            scaler->min = low;
+            scaler->max = high;
+            scaler->is_ready = 1;
+            break;
+        case SQ_SCALE_PERCENTILE:
+            return sq_hist_init(&scaler->hist);
+        case SQ_SCALE_LINEAR:
+        case SQ_SCALE_AMP:
+        case SQ_SCALE_POWER:
+            break;
+        default:
+            return ERR_UNKNOWN_OPTION;
     }
+
+    return 0;
 }
 
-int sq_power_scale(float* img_buf, int rows, int cols)
+/*
+ * The statistics passes of the modes:
+ *   linear      extremes of the values
+ *   amp         extremes, then amplitudes above the minimum
+ *   power       amplitudes, then again above the minimum if it is negative
+ *   percentile  histogram sketch
+ */
+void sq_scaler_add(sq_img_scaler* scaler, const float* buf, unsigned int n)
 {
-    unsigned int imgi;
-    float imgvalf;
+    unsigned int smpli;
 
-    float mean, stddev;
+    if (scaler->is_ready || (n == 0))
+        return;
+
+    if (scaler->mode == SQ_SCALE_PERCENTILE)
+        sq_hist_add(&scaler->hist, buf, n);
+    else if ((scaler->mode == SQ_SCALE_POWER) || (scaler->pass > 0))
+        sq_amp_stats_add(&scaler->stats, buf, n, scaler->offset);
+    else
+    {
+        if (scaler->stats.count == 0)
+        {
+            scaler->stats.min = buf[0];
+            scaler->stats.max = buf[0];
+        }
+        for (smpli = 0; smpli < n; smpli++)
+        {
+            if (buf[smpli] < scaler->stats.min) scaler->stats.min = buf[smpli];
+            if (buf[smpli] > scaler->stats.max) scaler->stats.max = buf[smpli];
+        }
+        scaler->stats.count += n;
+    }
+}
+
+void sq_scaler_end_pass(sq_img_scaler* scaler)
+{
     float min, max;
 
-    // note image comes in already in the power domain
-    min = img_buf[0];
-
-    // compute the minimum value
-    for (imgi = 0; imgi < (rows * cols); imgi++)
-        if (img_buf[imgi] < min) min = img_buf[imgi];
-    // don't want errors about taking sqrt of negative numbers! if necessary subtract off min
-    if (min < 0.0)
-        for (imgi = 0; imgi < (rows * cols); imgi++)
-           img_buf[imgi] -= min;
-
-    // compute mean value of AMPLITUDE (not power)
-    mean = 0.0;
-    for (imgi = 0; imgi < (rows * cols); imgi++)
-        mean += sqrt(img_buf[imgi]);
-    mean /= (rows * cols);
-
-    // compute variance of Amplitude
-    stddev = 0.0;
-    for (imgi = 0; imgi < (rows * cols); imgi++)
-        stddev += (sqrt(img_buf[imgi]) - mean) * (sqrt(img_buf[imgi]) - mean);
-    stddev = sqrt(stddev / (rows * cols));
-
-    // convert min/max to power levels (is this the right way to go?)
-    min = mean - stddev;
-    if (min < 0.0) min = 0.0;
-    min = min * min;
-    max = mean + (STD_THRESH * stddev);
-    max = max * max;
+    if (scaler->is_ready)
+        return;
+
+    switch (scaler->mode)
+    {
+        case SQ_SCALE_LINEAR:
+            min = scaler->stats.min;
+            max = scaler->stats.max;
+            break;
+
+        case SQ_SCALE_PERCENTILE:
+            min = sq_hist_percentile(&scaler->hist, scaler->low);
+            max = sq_hist_percentile(&scaler->hist, scaler->high);
+            break;
+
+        case SQ_SCALE_AMP:
+            // amplitudes are taken above the minimum power, so there are
+            // no errors about taking sqrt of negative numbers
+            if (scaler->pass == 0)
+            {
+                scaler->offset = scaler->stats.min;
+                memset(&scaler->stats, 0, sizeof(scaler->stats));
+                scaler->pass++;
+                return;
+            }
+
+            min = scaler->stats.mean - scaler->stats.stddev;
+            if (min < 0.0) min = 0.0;
+            max = scaler->stats.mean + (STD_THRESH * scaler->stats.stddev);
+            break;
+
+        default:
+            // don't want errors about taking sqrt of negative numbers! if necessary take off min
+            if ((scaler->pass == 0) && (scaler->stats.min < 0.0))
+            {
+                scaler->offset = scaler->stats.min;
+                memset(&scaler->stats, 0, sizeof(scaler->stats));
+                scaler->pass++;
+                return;
+            }
+
+            // convert min/max to power levels (is this the right way to go?)
+            min = scaler->stats.mean - scaler->stats.stddev;
+            if (min < 0.0) min = 0.0;
+            min = min * min;
+            max = scaler->stats.mean + (STD_THRESH * scaler->stats.stddev);
+            max = max * max;
+            break;
+    }
+
+    scaler->min = min;
+    scaler->max = max;
+    scaler->is_ready = 1;
+}
+
+void sq_scaler_apply(const sq_img_scaler* scaler, const float* in, float* out, unsigned int n)
+{
+    unsigned int smpli;
+    float imgvalf;
+
+    if (scaler->mode == SQ_SCALE_NONE)
+    {
+        if (in != out)
+            memcpy(out, in, n * sizeof(float));
+        return;
+    }
 
     // scale image to min=0, max=MAX_PIXEL_VAL
-    for (imgi = 0; imgi < (rows * cols); imgi++)
+    for (smpli = 0; smpli < n; smpli++)
     {
-        imgvalf = img_buf[imgi]; // convert to floating point
-        imgvalf -= min;
-        imgvalf *= ((float) MAX_PIXEL_VAL) / (max - min);
-        img_buf[imgi] = imgvalf;
+        imgvalf = in[smpli] - scaler->offset;
+        if (scaler->mode == SQ_SCALE_AMP)
+            imgvalf = sqrt(imgvalf);
+        imgvalf -= scaler->min;
+        imgvalf *= ((float) MAX_PIXEL_VAL) / (scaler->max - scaler->min);
+        out[smpli] = imgvalf;
     }
 }
 
+void sq_scaler_free(sq_img_scaler* scaler)
+{
+    sq_hist_free(&scaler->hist);
+}
+
+// scales a whole image in memory, taking the statistics passes over it
+static int scale_buffer(float* img_buf, int rows, int cols, unsigned int mode, double low, double high)
+{
+    sq_img_scaler scaler;
+
+    int status = sq_scaler_init(&scaler, mode, low, high);
+    if (status < 0)
+        return status;
+
+    while (!scaler.is_ready)
+    {
+        sq_scaler_add(&scaler, img_buf, rows * cols);
+        sq_scaler_end_pass(&scaler);
+    }
+    sq_scaler_apply(&scaler, img_buf, img_buf, rows * cols);
+
+    sq_scaler_free(&scaler);
+    return 0;
+}
+
+int sq_linear_scale(float* img_buf, int rows, int cols)
+{
+    return scale_buffer(img_buf, rows, cols, SQ_SCALE_LINEAR, 0.0, 0.0);
+}
+
+int sq_amp_scale(float* img_buf, int rows, int cols)
+{
+    // note image comes in in the power domain; mean and deviation are of AMPLITUDE
+    return scale_buffer(img_buf, rows, cols, SQ_SCALE_AMP, 0.0, 0.0);
+}
+
+int sq_power_scale(float* img_buf, int rows, int cols)
+{
+    // note image comes in already in the power domain; mean and deviation
+    // are of AMPLITUDE (not power)
+    return scale_buffer(img_buf, rows, cols, SQ_SCALE_POWER, 0.0, 0.0);
+}
+
+int sq_percentile_range_scale(float* img_buf, int rows, int cols, double low_pct, double high_pct)
+{
+    return scale_buffer(img_buf, rows, cols, SQ_SCALE_PERCENTILE, low_pct, high_pct);
+}
+
+int sq_percentile_scale(float* img_buf, int rows, int cols)
+{
+    return sq_percentile_range_scale(img_buf, rows, cols, SQ_PCTL_LOW, SQ_PCTL_HIGH);
+}
+
 int sq_read_img(FILE* instream, float* img_buf, int rows, int cols)
 {
     unsigned int rowi;
@@ -234,31 +469,558 @@ int sq_imchop(float* img_in, float* img_out, int rows, int cols, float width_cho
 
 int sq_write_pnm(FILE* outstream, float* img_buf, int rows, int cols)
 {
-    unsigned int imgi;
-    
+    return sq_write_image(outstream, img_buf, rows, cols, SQ_IMAGE_PGM, 0, 1.0);
+}
+
+void sq_quantize_row(const float* img_row, unsigned char* pix_row, int cols, const unsigned char* lut)
+{
+    int coli;
     float imgvalf;
-    unsigned char imgvalb;
 
-    // write pnm header
+    for (coli = 0; coli < cols; coli++)
+    {
+        imgvalf = img_row[coli];
+
+        if (imgvalf < 0.0)
+            imgvalf = 0.0;
+        if (imgvalf > (float) MAX_PIXEL_VAL)
+            imgvalf = (float) MAX_PIXEL_VAL;
+
+        pix_row[coli] = (unsigned char) imgvalf;
+    }
+
+    if (lut != NULL)
+        for (coli = 0; coli < cols; coli++)
+            pix_row[coli] = lut[pix_row[coli]];
+}
+
+void sq_gamma_lut(unsigned char* lut, float gamma)
+{
+    unsigned int pixi;
+
+    for (pixi = 0; pixi < 256; pixi++)
+    {
+        if (pixi > MAX_PIXEL_VAL)
+            lut[pixi] = MAX_PIXEL_VAL;
+        else
+            lut[pixi] = (unsigned char) floor((MAX_PIXEL_VAL * pow(pixi / (double) MAX_PIXEL_VAL, 1.0 / gamma)) + 0.5);
+    }
+}
+
+int sq_write_pgm_pixels(FILE* outstream, const unsigned char* pix_buf, int rows, int cols)
+{
+    if (!((rows > 0) && (cols > 0)))
+        return ERR_ARG_BOUNDS;
+
     fprintf(outstream, "P5\n");
     fprintf(outstream, "%u %u\n", cols, rows);
     fprintf(outstream, "%u\n", MAX_PIXEL_VAL);
 
-    for (imgi= 0; imgi < rows * cols; imgi++)
+    if (fwrite(pix_buf, cols, rows, outstream) != (size_t) rows)
+        return ERR_STREAM_WRITE;
+
+    return 0;
+}
+
+static uint32_t png_crc_table[256];
+static pthread_once_t png_crc_once = PTHREAD_ONCE_INIT;
+
+static void png_crc_init(void)
+{
+    uint32_t c;
+    unsigned int n, k;
+
+    for (n = 0; n < 256; n++)
     {
-        imgvalf = img_buf[imgi];
-        
-        if (imgvalf < 0.0)
-            imgvalf = 0.0;
-        if (imgvalf > (float) MAX_PIXEL_VAL) 
-            imgvalf = (float) MAX_PIXEL_VAL;
-        
-        imgvalb = (unsigned char) imgvalf;
-        fwrite(&imgvalb, 1, 1, outstream);
+        c = n;
+        for (k = 0; k < 8; k++)
+            c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+        png_crc_table[n] = c;
     }
 }
 
-    
+// CRC-32 of PNG chunks, continued from crc (0 to start)
+static uint32_t png_crc(uint32_t crc, const unsigned char* buf, size_t len)
+{
+    uint32_t c;
+
+    // images may be written from several threads (see sq_waterfalls)
+    pthread_once(&png_crc_once, png_crc_init);
+
+    c = crc ^ 0xffffffff;
+    while (len-- > 0)
+        c = png_crc_table[(c ^ *buf++) & 0xff] ^ (c >> 8);
+    return c ^ 0xffffffff;
+}
+
+static void png_put32(unsigned char* buf, uint32_t val)
+{
+    buf[0] = val >> 24;
+    buf[1] = val >> 16;
+    buf[2] = val >> 8;
+    buf[3] = val;
+}
+
+static int png_write_chunk(FILE* outstream, const char* type, const unsigned char* data, size_t len)
+{
+    unsigned char lenbfr[4], crcbfr[4];
+    uint32_t crc;
+
+    png_put32(lenbfr, len);
+    crc = png_crc(0, (const unsigned char*) type, 4);
+    crc = png_crc(crc, data, len);
+    png_put32(crcbfr, crc);
+
+    if ((fwrite(lenbfr, 4, 1, outstream) != 1) ||
+            (fwrite(type, 4, 1, outstream) != 1) ||
+            ((len > 0) && (fwrite(data, len, 1, outstream) != 1)) ||
+            (fwrite(crcbfr, 4, 1, outstream) != 1))
+        return ERR_STREAM_WRITE;
+
+    return 0;
+}
+
+// bytes of deflated data gathered into one IDAT chunk
+#define PNG_IDAT_SIZE 65536
+
+/*
+ * Writes a PGM or PNG image a row at a time. PNG rows are deflated with zlib
+ * if the library was built with it, else wrapped in stored deflate blocks,
+ * which every PNG reader accepts; the deflated data goes out in IDAT chunks
+ * of up to PNG_IDAT_SIZE bytes.
+ */
+typedef struct
+{
+    FILE* stream;
+    unsigned int format;
+    unsigned int cols;
+    unsigned char* rowbfr;
+    unsigned char* idat;
+    size_t idat_len;
+#ifdef HAVE_ZLIB
+    z_stream zs;
+#else
+    uint32_t adler_a;
+    uint32_t adler_b;
+#endif
+} img_writer;
+
+static int writer_flush(img_writer* writer)
+{
+    int status = 0;
+
+    if (writer->idat_len > 0)
+        status = png_write_chunk(writer->stream, "IDAT", writer->idat, writer->idat_len);
+    writer->idat_len = 0;
+
+    return status;
+}
+
+#ifdef HAVE_ZLIB
+static int writer_deflate(img_writer* writer, const unsigned char* buf, size_t len, int flush)
+{
+    int zstatus;
+    int status = 0;
+
+    writer->zs.next_in = (Bytef*) buf;
+    writer->zs.avail_in = len;
+    do
+    {
+        writer->zs.next_out = &writer->idat[writer->idat_len];
+        writer->zs.avail_out = PNG_IDAT_SIZE - writer->idat_len;
+        zstatus = deflate(&writer->zs, flush);
+        writer->idat_len = PNG_IDAT_SIZE - writer->zs.avail_out;
+        if (writer->idat_len == PNG_IDAT_SIZE)
+            status = writer_flush(writer);
+    } while ((status == 0) && (zstatus == Z_OK) &&
+             ((writer->zs.avail_in > 0) || (writer->zs.avail_out == 0) || (flush == Z_FINISH)));
+
+    if ((zstatus == Z_STREAM_ERROR) || ((flush == Z_FINISH) && (zstatus != Z_STREAM_END)))
+        return ERR_STREAM_WRITE;
+    return status;
+}
+#else
+static int writer_put(img_writer* writer, const unsigned char* buf, size_t len)
+{
+    size_t n;
+    int status = 0;
+
+    while ((status == 0) && (len > 0))
+    {
+        n = PNG_IDAT_SIZE - writer->idat_len;
+        if (n > len)
+            n = len;
+        memcpy(&writer->idat[writer->idat_len], buf, n);
+        writer->idat_len += n;
+        buf += n;
+        len -= n;
+        if (writer->idat_len == PNG_IDAT_SIZE)
+            status = writer_flush(writer);
+    }
+
+    return status;
+}
+
+// the last block is an empty final one, written when the image is closed
+static int writer_stored(img_writer* writer, const unsigned char* buf, size_t len, unsigned char is_final)
+{
+    unsigned char blkhdr[5];
+    size_t blklen, ini;
+    int status = 0;
+
+    do
+    {
+        blklen = (len > 65535) ? 65535 : len;
+        blkhdr[0] = is_final;
+        blkhdr[1] = blklen & 0xff;
+        blkhdr[2] = blklen >> 8;
+        blkhdr[3] = ~blklen & 0xff;
+        blkhdr[4] = (~blklen >> 8) & 0xff;
+
+        for (ini = 0; ini < blklen; ini++)
+        {
+            writer->adler_a = (writer->adler_a + buf[ini]) % 65521;
+            writer->adler_b = (writer->adler_b + writer->adler_a) % 65521;
+        }
+
+        status = writer_put(writer, blkhdr, sizeof(blkhdr));
+        if (status == 0)
+            status = writer_put(writer, buf, blklen);
+        buf += blklen;
+        len -= blklen;
+    } while ((status == 0) && (len > 0));
+
+    return status;
+}
+#endif
+
+static int writer_open(img_writer* writer, FILE* stream, unsigned int format, unsigned int rows, unsigned int cols)
+{
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    unsigned char ihdr[13];
+    int status = 0;
+
+    memset(writer, 0, sizeof(*writer));
+    writer->stream = stream;
+    writer->format = format;
+    writer->cols = cols;
+
+    if (!((rows > 0) && (cols > 0)))
+        return ERR_ARG_BOUNDS;
+
+    if (format != SQ_IMAGE_PNG)
+    {
+        fprintf(stream, "P5\n");
+        fprintf(stream, "%u %u\n", cols, rows);
+        fprintf(stream, "%u\n", MAX_PIXEL_VAL);
+        return 0;
+    }
+
+    writer->rowbfr = malloc(cols + 1);
+    writer->idat = malloc(PNG_IDAT_SIZE);
+    if ((writer->rowbfr == NULL) || (writer->idat == NULL))
+        return ERR_MALLOC;
+
+    // 8-bit grayscale, deflate, adaptive filtering, no interlace
+    png_put32(&ihdr[0], cols);
+    png_put32(&ihdr[4], rows);
+    ihdr[8] = 8;
+    ihdr[9] = 0;
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+
+    if (fwrite(signature, sizeof(signature), 1, stream) != 1)
+        return ERR_STREAM_WRITE;
+    status = png_write_chunk(stream, "IHDR", ihdr, sizeof(ihdr));
+    if (status < 0)
+        return status;
+
+#ifdef HAVE_ZLIB
+    if (deflateInit(&writer->zs, Z_DEFAULT_COMPRESSION) != Z_OK)
+        return ERR_MALLOC;
+#else
+    // zlib header: deflate with a 32K window, no preset dictionary
+    writer->adler_a = 1;
+    writer->adler_b = 0;
+    writer->idat[0] = 0x78;
+    writer->idat[1] = 0x01;
+    writer->idat_len = 2;
+#endif
+
+    return 0;
+}
+
+static int writer_row(img_writer* writer, const unsigned char* pix_row)
+{
+    if (writer->format != SQ_IMAGE_PNG)
+        return (fwrite(pix_row, 1, writer->cols, writer->stream) == writer->cols) ? 0 : ERR_STREAM_WRITE;
+
+    // every row starts with its filter type, 0 (none)
+    writer->rowbfr[0] = 0;
+    memcpy(&writer->rowbfr[1], pix_row, writer->cols);
+#ifdef HAVE_ZLIB
+    return writer_deflate(writer, writer->rowbfr, writer->cols + 1, Z_NO_FLUSH);
+#else
+    return writer_stored(writer, writer->rowbfr, writer->cols + 1, 0);
+#endif
+}
+
+// finishes the image if status is 0, and frees the writer either way
+static int writer_close(img_writer* writer, int status)
+{
+    if (writer->format == SQ_IMAGE_PNG)
+    {
+#ifdef HAVE_ZLIB
+        if (status == 0)
+            status = writer_deflate(writer, NULL, 0, Z_FINISH);
+        if (writer->idat != NULL)
+            deflateEnd(&writer->zs);
+#else
+        unsigned char adler[4];
+
+        if (status == 0)
+            status = writer_stored(writer, NULL, 0, 1);
+        png_put32(adler, (writer->adler_b << 16) | writer->adler_a);
+        if (status == 0)
+            status = writer_put(writer, adler, sizeof(adler));
+#endif
+        if (status == 0)
+            status = writer_flush(writer);
+        if (status == 0)
+            status = png_write_chunk(writer->stream, "IEND", NULL, 0);
+
+        free(writer->rowbfr);
+        free(writer->idat);
+    }
+
+    return status;
+}
+
+int sq_write_png_pixels(FILE* outstream, const unsigned char* pix_buf, int rows, int cols)
+{
+    img_writer writer;
+    int rowi;
+
+    int status = writer_open(&writer, outstream, SQ_IMAGE_PNG, rows, cols);
+    for (rowi = 0; (status == 0) && (rowi < rows); rowi++)
+        status = writer_row(&writer, &pix_buf[(size_t) rowi * cols]);
+
+    return writer_close(&writer, status);
+}
+
+int sq_write_image(FILE* outstream, float* img_buf, int rows, int cols,
+                   unsigned int format, unsigned char is_flipped, float gamma)
+{
+    unsigned char lut[256];
+    unsigned char* pix_buf;
+    int rowi;
+    int status;
+
+    if (!((rows > 0) && (cols > 0)))
+        return ERR_ARG_BOUNDS;
+
+    pix_buf = malloc((size_t) rows * cols);
+    if (pix_buf == NULL)
+        return ERR_MALLOC;
+
+    if (gamma != 1.0)
+        sq_gamma_lut(lut, gamma);
+
+    for (rowi = 0; rowi < rows; rowi++)
+        sq_quantize_row(&img_buf[(size_t) rowi * cols],
+                        &pix_buf[(size_t) (is_flipped ? (rows - 1 - rowi) : rowi) * cols],
+                        cols, (gamma != 1.0) ? lut : NULL);
+
+    if (format == SQ_IMAGE_PNG)
+        status = sq_write_png_pixels(outstream, pix_buf, rows, cols);
+    else
+        status = sq_write_pgm_pixels(outstream, pix_buf, rows, cols);
+
+    free(pix_buf);
+    return status;
+}
+
+int sq_image_stream(FILE* instream, FILE* outstream, unsigned int rows, unsigned int cols,
+                    unsigned int avglines, unsigned int scale_mode, double low, double high,
+                    unsigned int sketch_rows, unsigned int format, unsigned char is_flipped,
+                    float gamma)
+{
+    sq_img_scaler scaler;
+    img_writer writer;
+    unsigned char is_writer_open = 0;
+    struct stat st;
+    off_t start = 0;
+    unsigned char is_seekable;
+
+    float* rowbfr = NULL;
+    float* avgbfr = NULL;
+    float* sketch = NULL;
+    unsigned char* pixbfr = NULL;
+    unsigned char lut[256];
+    FILE* staging = NULL;
+
+    unsigned int nsketch = 0;
+    unsigned int rowi, coli, avgi;
+    unsigned int outrows = 0;
+    const float* row;
+    int status;
+
+    if (cols == 0)
+        return ERR_ARG_BOUNDS;
+    if (avglines == 0)
+        avglines = 1;
+
+    status = sq_scaler_init(&scaler, scale_mode, low, high);
+    if (status < 0)
+        return status;
+
+    rowbfr = malloc(cols * sizeof(float));
+    avgbfr = calloc(cols, sizeof(float));
+    pixbfr = malloc(cols);
+    if ((rowbfr == NULL) || (avgbfr == NULL) || (pixbfr == NULL))
+    {
+        status = ERR_MALLOC;
+        goto done;
+    }
+
+    // a regular file is read again for every statistics pass, a pipe is
+    // scaled from its first rows, which are kept to be written later
+    is_seekable = (fstat(fileno(instream), &st) == 0) && S_ISREG(st.st_mode) &&
+                  ((start = ftello(instream)) >= 0);
+    if (is_seekable)
+    {
+        uint64_t avail = (st.st_size - start) / ((uint64_t) cols * sizeof(float));
+        if ((rows == 0) || (rows > avail))
+            rows = avail;
+
+        while ((status == 0) && !scaler.is_ready)
+        {
+            if (fseeko(instream, start, SEEK_SET) != 0)
+                status = ERR_STREAM_READ;
+            for (rowi = 0; (status == 0) && (rowi < rows); rowi++)
+            {
+                if (fread(rowbfr, sizeof(float), cols, instream) != cols)
+                    status = ERR_STREAM_READ;
+                else
+                    sq_scaler_add(&scaler, rowbfr, cols);
+            }
+            sq_scaler_end_pass(&scaler);
+        }
+        if ((status == 0) && (fseeko(instream, start, SEEK_SET) != 0))
+            status = ERR_STREAM_READ;
+    }
+    else if (!scaler.is_ready)
+    {
+        if (sketch_rows == 0)
+            sketch_rows = SQ_SKETCH_ROWS;
+        if ((rows > 0) && (sketch_rows > rows))
+            sketch_rows = rows;
+
+        sketch = malloc((size_t) sketch_rows * cols * sizeof(float));
+        if (sketch == NULL)
+        {
+            status = ERR_MALLOC;
+            goto done;
+        }
+        nsketch = sq_read_img(instream, sketch, sketch_rows, cols);
+
+        while (!scaler.is_ready)
+        {
+            sq_scaler_add(&scaler, sketch, nsketch * cols);
+            sq_scaler_end_pass(&scaler);
+        }
+    }
+    if (status < 0)
+        goto done;
+
+    // the header needs the number of rows, which only a file tells up front,
+    // and a flipped image starts with the last row
+    if (is_seekable && !is_flipped)
+    {
+        status = writer_open(&writer, outstream, format, rows / avglines, cols);
+        is_writer_open = 1;
+    }
+    else
+    {
+        staging = tmpfile();
+        if (staging == NULL)
+            status = ERR_STREAM_OPEN;
+    }
+
+    if (gamma != 1.0)
+        sq_gamma_lut(lut, gamma);
+
+    avgi = 0;
+    for (rowi = 0; (status == 0) && ((rows == 0) || (rowi < rows)); rowi++)
+    {
+        if (rowi < nsketch)
+            row = &sketch[(size_t) rowi * cols];
+        else if (fread(rowbfr, sizeof(float), cols, instream) == cols)
+            row = rowbfr;
+        else
+        {
+            if (is_seekable)
+                status = ERR_STREAM_READ;
+            break;
+        }
+
+        // the average is of scaled rows, as sq_average_lines does it
+        sq_scaler_apply(&scaler, row, rowbfr, cols);
+        for (coli = 0; coli < cols; coli++)
+            avgbfr[coli] += rowbfr[coli];
+        if (++avgi < avglines)
+            continue;
+
+        if (avglines > 1)
+            for (coli = 0; coli < cols; coli++)
+                avgbfr[coli] /= avglines;
+        sq_quantize_row(avgbfr, pixbfr, cols, (gamma != 1.0) ? lut : NULL);
+        memset(avgbfr, 0, cols * sizeof(float));
+        avgi = 0;
+
+        if (staging != NULL)
+            status = (fwrite(pixbfr, 1, cols, staging) == cols) ? 0 : ERR_STREAM_WRITE;
+        else
+            status = writer_row(&writer, pixbfr);
+        outrows++;
+    }
+
+    if ((status == 0) && (outrows == 0))
+        status = ERR_STREAM_READ;
+
+    if ((status == 0) && (staging != NULL))
+    {
+        status = writer_open(&writer, outstream, format, outrows, cols);
+        is_writer_open = 1;
+        if ((status == 0) && (fseeko(staging, 0, SEEK_SET) != 0))
+            status = ERR_STREAM_READ;
+
+        for (rowi = 0; (status == 0) && (rowi < outrows); rowi++)
+        {
+            if (is_flipped && (fseeko(staging, (off_t) (outrows - 1 - rowi) * cols, SEEK_SET) != 0))
+                status = ERR_STREAM_READ;
+            else if (fread(pixbfr, 1, cols, staging) != cols)
+                status = ERR_STREAM_READ;
+            else
+                status = writer_row(&writer, pixbfr);
+        }
+    }
+
+done:
+    if (is_writer_open)
+        status = writer_close(&writer, status);
+    if (staging != NULL)
+        fclose(staging);
+    sq_scaler_free(&scaler);
+    free(rowbfr);
+    free(avgbfr);
+    free(sketch);
+    free(pixbfr);
+
+    return status;
+}
+
 int sq_average_lines(float* img_in, int rows, int cols, float* img_out, int avglines)
 {
     unsigned int rowi, coli, rowi_out;
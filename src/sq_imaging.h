@@ -32,7 +32,80 @@
 
 #define MAX_PIXEL_VAL 255
 
+// default percentiles clipped by sq_percentile_scale
+#define SQ_PCTL_LOW 1.0
+#define SQ_PCTL_HIGH 99.5
+
+// bins of an sq_img_hist, one per value of the top 16 bits of a float
+#define SQ_HIST_BINS 65536
+
+// output formats of sq_write_image
+#define SQ_IMAGE_PGM 0
+#define SQ_IMAGE_PNG 1
+
+// scale modes of an sq_img_scaler
+#define SQ_SCALE_NONE 0
+#define SQ_SCALE_LINEAR 1
+#define SQ_SCALE_AMP 2
+#define SQ_SCALE_POWER 3
+#define SQ_SCALE_PERCENTILE 4
+#define SQ_SCALE_FIXED 5
+
+// default number of rows a pipe is scaled from by sq_image_stream
+#define SQ_SKETCH_ROWS 256
+
 #include <stdio.h>
+#include <inttypes.h>
+
+/**
+ * Statistics of an image of power values, as the scale functions use them:
+ * the extremes of the power values, and the mean and (population) standard
+ * deviation of the amplitudes sqrt(power - offset).
+ */
+typedef struct
+{
+    uint64_t count;
+    float min;
+    float max;
+    double mean;
+    double stddev;
+    // sum of squared deviations from the mean, for sq_amp_stats_add
+    double m2;
+} sq_img_stats;
+
+/**
+ * Histogram sketch of a stream of float values for approximate percentiles.
+ * The bins are keyed by the top 16 bits of the values, mapped so that the
+ * keys sort like the values: every bin spans a relative width of 2^-7
+ * (under 1%), whatever the range of the data, and the memory use does not
+ * depend on the number of values.
+ */
+typedef struct
+{
+    uint64_t count;
+    uint64_t* bins;
+} sq_img_hist;
+
+/**
+ * Scale of an image that is read a row at a time. The scale needs one or
+ * two passes of statistics over the image (none for SQ_SCALE_NONE and
+ * SQ_SCALE_FIXED), after which values are mapped as
+ * out = (f(in - offset) - min) * MAX_PIXEL_VAL / (max - min), where f is the
+ * square root for SQ_SCALE_AMP and the identity otherwise.
+ */
+typedef struct
+{
+    unsigned int mode;
+    unsigned int pass;
+    unsigned char is_ready;
+    double low;
+    double high;
+    sq_img_stats stats;
+    sq_img_hist hist;
+    float offset;
+    float min;
+    float max;
+} sq_img_scaler;
 
 /** 
  * Allocate memory to an image buffer
@@ -58,6 +131,123 @@ int sq_linear_scale(float* img_buf, int rows, int cols);
  */
 int sq_amp_scale(float* img_buf, int rows, int cols);
 
+/**
+ * Computes the statistics of an image of power values in one pass. The
+ * moments are accumulated in double precision over blocks of the image with
+ * the vector kernel sq_simd_amp_moments, and the blocks are merged with the
+ * parallel form of Welford's update, so large images lose no precision.
+ * @param img_buf float pointer to image buffer
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @param stride Distance between the starts of rows (>= cols), for images cut out of wider buffers
+ * @param offset Subtracted from the power values before the square root
+ * @param stats Output statistics
+ */
+void sq_amp_stats(const float* img_buf, int rows, int cols, int stride, float offset, sq_img_stats* stats);
+
+/**
+ * Adds values to statistics, like sq_amp_stats does for every row; start
+ * from zeroed statistics.
+ * @param stats Statistics to update
+ * @param buf Power values
+ * @param n Number of values
+ * @param offset Subtracted from the power values before the square root
+ */
+void sq_amp_stats_add(sq_img_stats* stats, const float* buf, unsigned int n, float offset);
+
+/**
+ * Initializes the scale of an image read a row at a time
+ * @param scaler Scale to initialize
+ * @param mode One of the SQ_SCALE_* modes
+ * @param low Low percentile for SQ_SCALE_PERCENTILE, value scaled to 0 for SQ_SCALE_FIXED
+ * @param high High percentile for SQ_SCALE_PERCENTILE, value scaled to MAX_PIXEL_VAL for SQ_SCALE_FIXED
+ * @return Code; negative if error.
+ */
+int sq_scaler_init(sq_img_scaler* scaler, unsigned int mode, double low, double high);
+
+/**
+ * Adds values to the statistics pass under way; call it for every row of the
+ * image while scaler->is_ready is 0, then end the pass.
+ * @param scaler An initialized scale
+ * @param buf Values
+ * @param n Number of values
+ */
+void sq_scaler_add(sq_img_scaler* scaler, const float* buf, unsigned int n);
+
+/**
+ * Ends a statistics pass. The scale is then either ready (scaler->is_ready)
+ * or needs another pass over the same values.
+ * @param scaler An initialized scale
+ */
+void sq_scaler_end_pass(sq_img_scaler* scaler);
+
+/**
+ * Maps values with a ready scale; in and out may be the same buffer.
+ * @param scaler A ready scale
+ * @param in Values
+ * @param out Scaled values, 0..MAX_PIXEL_VAL unless clipped later
+ * @param n Number of values
+ */
+void sq_scaler_apply(const sq_img_scaler* scaler, const float* in, float* out, unsigned int n);
+
+/**
+ * Frees a scale
+ * @param scaler Scale
+ */
+void sq_scaler_free(sq_img_scaler* scaler);
+
+/**
+ * Allocates an empty histogram sketch
+ * @param hist Histogram to initialize
+ * @return Code; negative if error.
+ */
+int sq_hist_init(sq_img_hist* hist);
+
+/**
+ * Adds values to a histogram sketch; NaNs are skipped.
+ * @param hist An initialized histogram
+ * @param buf Values
+ * @param n Number of values
+ */
+void sq_hist_add(sq_img_hist* hist, const float* buf, unsigned int n);
+
+/**
+ * Returns an approximate percentile of the values added to a histogram
+ * sketch, interpolated within its bin.
+ * @param hist An initialized histogram
+ * @param pct Percentile, 0 to 100
+ * @return The percentile; 0 if the histogram is empty.
+ */
+float sq_hist_percentile(const sq_img_hist* hist, double pct);
+
+/**
+ * Frees a histogram sketch
+ * @param hist Histogram
+ */
+void sq_hist_free(sq_img_hist* hist);
+
+/**
+ * Percentile scaling of image brightness: the low percentile is scaled to 0
+ * and the high percentile to MAX_PIXEL_VAL, so a few strong values (e.g.
+ * RFI) do not darken the rest of the image. The percentiles come from a
+ * histogram sketch (see sq_hist_init) built in one pass.
+ * @param img_buf float pointer to image buffer
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @param low_pct Percentile scaled to 0
+ * @param high_pct Percentile scaled to MAX_PIXEL_VAL
+ */
+int sq_percentile_range_scale(float* img_buf, int rows, int cols, double low_pct, double high_pct);
+
+/**
+ * Percentile scaling of image brightness between SQ_PCTL_LOW and SQ_PCTL_HIGH
+ * (see sq_percentile_range_scale)
+ * @param img_buf float pointer to image buffer
+ * @param rows Number of rows
+ * @param cols Number of columns
+ */
+int sq_percentile_scale(float* img_buf, int rows, int cols);
+
 /**
  * Power scaling of image brightness
  * @param img_buf float pointer to image buffer
@@ -111,6 +301,87 @@ int sq_imchop(float* img_in, float* img_out, int rows, int cols, float width_cho
  */
 int sq_write_pnm(FILE* outstream, float* img_buf, int rows, int cols);
 
+/**
+ * Converts a row of scaled values to 8-bit pixels, clipping them to
+ * 0..MAX_PIXEL_VAL and truncating like sq_write_pnm.
+ * @param img_row Row of cols scaled values
+ * @param pix_row Output row of cols pixels
+ * @param cols Number of columns
+ * @param lut Optional 256-entry lookup table applied to each pixel (e.g. from sq_gamma_lut); NULL for none
+ */
+void sq_quantize_row(const float* img_row, unsigned char* pix_row, int cols, const unsigned char* lut);
+
+/**
+ * Fills a pixel lookup table with a gamma correction, out = MAX_PIXEL_VAL * (in / MAX_PIXEL_VAL)^(1 / gamma),
+ * the correction of ImageMagick's -gamma option.
+ * @param lut 256-entry lookup table
+ * @param gamma Gamma; 1.0 gives the identity
+ */
+void sq_gamma_lut(unsigned char* lut, float gamma);
+
+/**
+ * Write 8-bit pixels as a PGM image to the output stream
+ * @param outstream output stream
+ * @param pix_buf pixel buffer, rows of cols pixels from the top
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @return Code; negative if error.
+ */
+int sq_write_pgm_pixels(FILE* outstream, const unsigned char* pix_buf, int rows, int cols);
+
+/**
+ * Write 8-bit pixels as a grayscale PNG image to the output stream. The image
+ * data is deflated with zlib if the library was built with it, else it is
+ * written in stored (uncompressed) deflate blocks.
+ * @param outstream output stream
+ * @param pix_buf pixel buffer, rows of cols pixels from the top
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @return Code; negative if error.
+ */
+int sq_write_png_pixels(FILE* outstream, const unsigned char* pix_buf, int rows, int cols);
+
+/**
+ * Write scaled image data as a PGM or PNG image to the output stream
+ * @param outstream output stream
+ * @param img_buf float pointer to image buffer, scaled to 0..MAX_PIXEL_VAL
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @param format SQ_IMAGE_PGM or SQ_IMAGE_PNG
+ * @param is_flipped If 1, the last row is written on top
+ * @param gamma Gamma correction (see sq_gamma_lut); 1.0 for none
+ * @return Code; negative if error.
+ */
+int sq_write_image(FILE* outstream, float* img_buf, int rows, int cols,
+                   unsigned int format, unsigned char is_flipped, float gamma);
+
+/**
+ * Reads an image of float values a row at a time from the input stream,
+ * scales it and writes it as a PGM or PNG image, with memory in proportion
+ * to the number of columns only. A regular file is read once per statistics
+ * pass of the scale and once more to write it; a pipe is scaled from its
+ * first sketch_rows rows and read once. If the output is flipped or the
+ * number of rows of a pipe is not known, the 8-bit rows are staged in a
+ * temporary file.
+ * @param instream input stream
+ * @param outstream output stream
+ * @param rows Number of rows; 0 to read to the end of the input
+ * @param cols Number of columns
+ * @param avglines Number of scaled rows averaged into each output row; 0 or 1 for none
+ * @param scale_mode One of the SQ_SCALE_* modes
+ * @param low See sq_scaler_init
+ * @param high See sq_scaler_init
+ * @param sketch_rows Number of rows a pipe is scaled from
+ * @param format SQ_IMAGE_PGM or SQ_IMAGE_PNG
+ * @param is_flipped If 1, the last row is written on top
+ * @param gamma Gamma correction (see sq_gamma_lut); 1.0 for none
+ * @return Code; negative if error.
+ */
+int sq_image_stream(FILE* instream, FILE* outstream, unsigned int rows, unsigned int cols,
+                    unsigned int avglines, unsigned int scale_mode, double low, double high,
+                    unsigned int sketch_rows, unsigned int format, unsigned char is_flipped,
+                    float gamma);
+
 /**
  * Average the horizontal raster lines of the image buffer -
  * this sometimes reveals certain patterns that may otherwise evade a visual analysis
@@ -0,0 +1,1024 @@
+/*******************************************************************************
+
+  File:    sq_pipeline.c
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <fftw3.h>
+
+#include "sq_constants.h"
+#include "sq_dsp.h"
+#include "sq_imaging.h"
+#include "sq_pipeline.h"
+#include "sq_tiled.h"
+#include "sq_utils.h"
+#include "sq_windows.h"
+
+int sq_tfp_init(sq_tfp_pipeline* pipeline, unsigned int fft_len, char* window_name,
+                unsigned int folds, unsigned char is_measured)
+{
+    int status;
+
+    memset(pipeline, 0, sizeof(*pipeline));
+    pipeline->fft_len = fft_len;
+    pipeline->readlen = fft_len;
+    pipeline->is_wola = !strcmp(window_name, "wola");
+
+    status = sq_fft_init(&pipeline->fft, fft_len, 0, is_measured, 0);
+    if (status < 0)
+        return status;
+
+    if (pipeline->is_wola)
+    {
+        status = sq_wola_init(&pipeline->wola, fft_len, folds, 0);
+        if (status < 0)
+            return status;
+        pipeline->readlen = pipeline->wola.readlen;
+
+        pipeline->smplbfr = malloc(pipeline->readlen * sizeof(cmplx));
+        if (pipeline->smplbfr == NULL) return ERR_MALLOC;
+    }
+    else
+    {
+        pipeline->wndwbfr = malloc(fft_len * sizeof(float));
+        if (pipeline->wndwbfr == NULL) return ERR_MALLOC;
+
+        status = sq_make_window_from_name(pipeline->wndwbfr, fft_len, window_name);
+        if (status < 0)
+            return status;
+    }
+
+    // for even lengths, fold the FFT channel swap into the window: negating
+    // the odd coefficients premodulates the windowed raster for free. The
+    // WOLA fold keeps the parity of the window index, since fft_len is even.
+    if (!(fft_len & 1))
+    {
+        float* wndwbfr = pipeline->is_wola ? pipeline->wola.wndwbfr : pipeline->wndwbfr;
+        unsigned int wndwlen = pipeline->is_wola ? pipeline->wola.wndwlen : fft_len;
+        unsigned int wndwi;
+
+        for (wndwi = 1; wndwi < wndwlen; wndwi += 2)
+            wndwbfr[wndwi] = -wndwbfr[wndwi];
+        pipeline->fft.premodulated = 1;
+    }
+
+    pipeline->pwrbfr = malloc(fft_len * sizeof(float));
+    if (pipeline->pwrbfr == NULL) return ERR_MALLOC;
+
+    return 0;
+}
+
+int sq_tfp_process(sq_tfp_pipeline* pipeline, const signed char* rawbfr)
+{
+    cmplx* fftbfr = (cmplx*) pipeline->fft.bfr;
+
+    if (pipeline->is_wola)
+    {
+        sq_sample_buf(rawbfr, pipeline->smplbfr, pipeline->readlen);
+        sq_wola_push(&pipeline->wola, pipeline->smplbfr, pipeline->readlen);
+
+        // the first raster needs a full history of folds * fft_len samples
+        if (pipeline->wola.filled < pipeline->wola.wndwlen)
+            return 0;
+
+        sq_wola_buf(&pipeline->wola, fftbfr);
+    }
+    else
+    {
+        sq_sample_buf(rawbfr, fftbfr, pipeline->fft_len);
+        sq_window_buf(pipeline->wndwbfr, fftbfr, fftbfr, pipeline->fft_len);
+    }
+
+    sq_fft_buf(&pipeline->fft);
+
+    // power of a complex sample is real, so this also does the job of sq_real
+    sq_power_buf(fftbfr, pipeline->pwrbfr, pipeline->fft_len);
+
+    return 1;
+}
+
+void sq_tfp_free(sq_tfp_pipeline* pipeline)
+{
+    if (pipeline->is_wola)
+        sq_wola_free(&pipeline->wola);
+    sq_fft_free(&pipeline->fft);
+    free(pipeline->wndwbfr);
+    free(pipeline->smplbfr);
+    free(pipeline->pwrbfr);
+}
+
+int sq_tfp(FILE* instream, FILE* outstream, unsigned int fft_len, char* window_name,
+           unsigned int folds, unsigned char is_measured, uint64_t filesize)
+{
+    sq_tfp_pipeline pipeline;
+    sq_input input;
+    const void* rawbfr;
+    uint64_t total_bytes = 0;
+
+    int status = sq_tfp_init(&pipeline, fft_len, window_name, folds, is_measured);
+    if (status < 0)
+        return status;
+
+    sq_input_open(&input, instream);
+    while (sq_input_view(&input, &rawbfr, 2, pipeline.readlen) == pipeline.readlen)
+    {
+        if (sq_tfp_process(&pipeline, rawbfr))
+            fwrite(pipeline.pwrbfr, sizeof(float), fft_len, outstream);
+
+        total_bytes += (pipeline.readlen * 2);
+        sq_print_progress(total_bytes, filesize);
+    }
+    sq_input_close(&input);
+
+    sq_tfp_free(&pipeline);
+
+    return 0;
+}
+
+static int xcorr_input_init(sq_xcorr_input* input, const char* path, unsigned int fft_len,
+                            unsigned int batch, char* window_name, unsigned int folds,
+                            unsigned char is_measured)
+{
+    int status;
+
+    status = sq_input_open_path(&input->input, path);
+    if (status < 0)
+        return status;
+
+    input->readlen = fft_len;
+    input->is_wola = !strcmp(window_name, "wola");
+
+    status = sq_fft_init_many(&input->fft, fft_len, batch, 0, is_measured, 0);
+    if (status < 0)
+        return status;
+
+    if (input->is_wola)
+    {
+        status = sq_wola_init(&input->wola, fft_len, folds, 0);
+        if (status < 0)
+            return status;
+        input->readlen = input->wola.readlen;
+
+        input->smplbfr = malloc(input->readlen * sizeof(cmplx));
+        if (input->smplbfr == NULL) return ERR_MALLOC;
+    }
+    else
+    {
+        input->wndwbfr = malloc(fft_len * sizeof(float));
+        if (input->wndwbfr == NULL) return ERR_MALLOC;
+
+        status = sq_make_window_from_name(input->wndwbfr, fft_len, window_name);
+        if (status < 0)
+            return status;
+    }
+
+    return 0;
+}
+
+int sq_xcorr_init(sq_xcorr_pipeline* pipeline, const char* path1, const char* path2,
+                  unsigned int fft_len, unsigned int batch, char* window_name,
+                  unsigned int folds, unsigned char is_convolution, unsigned char is_measured)
+{
+    int status;
+
+    memset(pipeline, 0, sizeof(*pipeline));
+    pipeline->fft_len = fft_len;
+    pipeline->batch = batch;
+    pipeline->is_convolution = is_convolution;
+
+    // the plans are all made here, as the FFTW planner is not thread-safe;
+    // executing them from two threads is
+    status = xcorr_input_init(&pipeline->inputs[0], path1, fft_len, batch, window_name, folds, is_measured);
+    if (status < 0)
+        return status;
+    status = xcorr_input_init(&pipeline->inputs[1], path2, fft_len, batch, window_name, folds, is_measured);
+    if (status < 0)
+        return status;
+
+    return sq_fft_init_many(&pipeline->inverse, fft_len, batch, 0, is_measured, 1);
+}
+
+static unsigned int xcorr_input_fill(sq_xcorr_input* input, unsigned int fft_len, unsigned int batch)
+{
+    cmplx* raster = (cmplx*) input->fft.bfr;
+    const void* rawbfr;
+
+    input->nrasters = 0;
+    while (input->nrasters < batch)
+    {
+        if (sq_input_view(&input->input, &rawbfr, 2, input->readlen) != input->readlen)
+            break;
+
+        if (input->is_wola)
+        {
+            sq_sample_buf(rawbfr, input->smplbfr, input->readlen);
+            sq_wola_push(&input->wola, input->smplbfr, input->readlen);
+
+            // the first raster needs a full history of folds * fft_len samples
+            if (input->wola.filled < input->wola.wndwlen)
+                continue;
+
+            sq_wola_buf(&input->wola, raster);
+        }
+        else
+        {
+            sq_sample_buf(rawbfr, raster, fft_len);
+            sq_window_buf(input->wndwbfr, raster, raster, fft_len);
+        }
+
+        raster += fft_len;
+        input->nrasters++;
+    }
+
+    // the spectra stay in FFTW order: the channel swap of sq_fft_buf would
+    // only be undone again before the inverse transform
+    if (input->nrasters > 0)
+        fftwf_execute(input->fft.plan);
+
+    return input->nrasters;
+}
+
+static void xcorr_input_free(sq_xcorr_input* input)
+{
+    if (input->is_wola)
+        sq_wola_free(&input->wola);
+    sq_fft_free(&input->fft);
+    free(input->wndwbfr);
+    free(input->smplbfr);
+    sq_input_close(&input->input);
+}
+
+unsigned int sq_xcorr_fill(sq_xcorr_pipeline* pipeline, sq_xcorr_input* input)
+{
+    return xcorr_input_fill(input, pipeline->fft_len, pipeline->batch);
+}
+
+static void xcorr_multiply(sq_xcorr_pipeline* pipeline, unsigned int nrasters)
+{
+    // with the 1/N of the inverse transform folded in, the product is
+    // exactly what sq_fft_buf would normalize for a power-of-two length
+    sq_crossmultiply_scale_buf((cmplx*) pipeline->inputs[0].fft.bfr,
+                               (cmplx*) pipeline->inputs[1].fft.bfr,
+                               (cmplx*) pipeline->inverse.bfr,
+                               nrasters * pipeline->fft_len,
+                               !pipeline->is_convolution,
+                               1.0f / pipeline->fft_len);
+}
+
+void sq_xcorr_process(sq_xcorr_pipeline* pipeline, unsigned int nrasters)
+{
+    xcorr_multiply(pipeline, nrasters);
+    fftwf_execute(pipeline->inverse.plan);
+}
+
+void sq_xcorr_free(sq_xcorr_pipeline* pipeline)
+{
+    xcorr_input_free(&pipeline->inputs[0]);
+    xcorr_input_free(&pipeline->inputs[1]);
+    sq_fft_free(&pipeline->inverse);
+}
+
+// the thread that fills the second input; batches are counted so that the
+// main thread can ask for the next one as soon as the products are made
+typedef struct
+{
+    sq_xcorr_pipeline* pipeline;
+    unsigned int requested;
+    unsigned int filled;
+    unsigned char is_stopped;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} xcorr_worker;
+
+static void* xcorr_work(void* arg)
+{
+    xcorr_worker* worker = arg;
+
+    pthread_mutex_lock(&worker->lock);
+    for (;;)
+    {
+        while ((worker->filled == worker->requested) && !worker->is_stopped)
+            pthread_cond_wait(&worker->cond, &worker->lock);
+        if (worker->filled == worker->requested)
+            break;
+        pthread_mutex_unlock(&worker->lock);
+
+        sq_xcorr_fill(worker->pipeline, &worker->pipeline->inputs[1]);
+
+        pthread_mutex_lock(&worker->lock);
+        worker->filled++;
+        pthread_cond_broadcast(&worker->cond);
+    }
+    pthread_mutex_unlock(&worker->lock);
+
+    return NULL;
+}
+
+static void xcorr_request(xcorr_worker* worker)
+{
+    pthread_mutex_lock(&worker->lock);
+    worker->requested++;
+    pthread_cond_broadcast(&worker->cond);
+    pthread_mutex_unlock(&worker->lock);
+}
+
+static void xcorr_wait(xcorr_worker* worker)
+{
+    pthread_mutex_lock(&worker->lock);
+    while (worker->filled != worker->requested)
+        pthread_cond_wait(&worker->cond, &worker->lock);
+    pthread_mutex_unlock(&worker->lock);
+}
+
+int sq_xcorr(const char* path1, const char* path2, FILE* outstream, unsigned int fft_len,
+             unsigned int batch, char* window_name, unsigned int folds,
+             unsigned char is_convolution, unsigned char is_measured)
+{
+    sq_xcorr_pipeline pipeline;
+    xcorr_worker worker;
+    pthread_t thread;
+    unsigned int nrasters;
+    int status;
+
+    status = sq_xcorr_init(&pipeline, path1, path2, fft_len, batch, window_name,
+                           folds, is_convolution, is_measured);
+    if (status < 0)
+    {
+        sq_xcorr_free(&pipeline);
+        return status;
+    }
+
+    memset(&worker, 0, sizeof(worker));
+    worker.pipeline = &pipeline;
+    pthread_mutex_init(&worker.lock, NULL);
+    pthread_cond_init(&worker.cond, NULL);
+
+    if (pthread_create(&thread, NULL, xcorr_work, &worker) != 0)
+    {
+        sq_xcorr_free(&pipeline);
+        return ERR_MALLOC;
+    }
+
+    xcorr_request(&worker);
+    for (;;)
+    {
+        sq_xcorr_fill(&pipeline, &pipeline.inputs[0]);
+        xcorr_wait(&worker);
+
+        nrasters = pipeline.inputs[0].nrasters;
+        if (pipeline.inputs[1].nrasters < nrasters)
+            nrasters = pipeline.inputs[1].nrasters;
+        if (nrasters == 0)
+            break;
+
+        xcorr_multiply(&pipeline, nrasters);
+
+        // the second input is free again once the products are made, so
+        // its next batch is read while this one is transformed and written
+        if (nrasters == batch)
+            xcorr_request(&worker);
+
+        fftwf_execute(pipeline.inverse.plan);
+
+        if (fwrite(pipeline.inverse.bfr, sizeof(cmplx), (size_t) nrasters * fft_len, outstream) !=
+            (size_t) nrasters * fft_len)
+        {
+            status = ERR_STREAM_WRITE;
+            xcorr_wait(&worker);
+            break;
+        }
+
+        if (nrasters < batch)
+            break;
+    }
+
+    pthread_mutex_lock(&worker.lock);
+    worker.is_stopped = 1;
+    pthread_cond_broadcast(&worker.cond);
+    pthread_mutex_unlock(&worker.lock);
+    pthread_join(thread, NULL);
+
+    pthread_mutex_destroy(&worker.lock);
+    pthread_cond_destroy(&worker.cond);
+    sq_xcorr_free(&pipeline);
+
+    return status;
+}
+
+// the visibilities and spectra of one block of channels take about this much
+#define FXCORR_BLOCK_BYTES (256 << 10)
+
+int sq_fxcorr_init(sq_fxcorr_pipeline* pipeline, char** paths, unsigned int ninputs,
+                   unsigned int fft_len, unsigned int batch, char* window_name,
+                   unsigned int folds, unsigned int num_to_sum, unsigned char is_measured)
+{
+    unsigned int inputi;
+    int status;
+
+    memset(pipeline, 0, sizeof(*pipeline));
+
+    if ((ninputs < 2) || (num_to_sum < 1))
+    {
+        sq_error_print("Correlation needs at least 2 inputs and 1 spectrum per integration.\n");
+        return ERR_ARG_BOUNDS;
+    }
+
+    pipeline->fft_len = fft_len;
+    pipeline->batch = batch;
+    pipeline->ninputs = ninputs;
+    pipeline->nbaselines = ninputs * (ninputs + 1) / 2;
+    pipeline->num_to_sum = num_to_sum;
+
+    // a multiple of 16 channels keeps every SIMD width on whole vectors
+    pipeline->blocklen = FXCORR_BLOCK_BYTES / ((pipeline->nbaselines + ninputs) * sizeof(cmplx));
+    pipeline->blocklen &= ~15U;
+    if (pipeline->blocklen < 16)
+        pipeline->blocklen = 16;
+    if (pipeline->blocklen > fft_len)
+        pipeline->blocklen = fft_len;
+
+    pipeline->inputs = calloc(ninputs, sizeof(sq_xcorr_input));
+    if (pipeline->inputs == NULL) return ERR_MALLOC;
+
+    for (inputi = 0; inputi < ninputs; inputi++)
+    {
+        status = xcorr_input_init(&pipeline->inputs[inputi], paths[inputi], fft_len, batch,
+                                  window_name, folds, is_measured);
+        if (status < 0)
+            return status;
+    }
+
+    pipeline->visbfr = calloc((size_t) pipeline->nbaselines * fft_len, sizeof(cmplx));
+    if (pipeline->visbfr == NULL) return ERR_MALLOC;
+
+    return 0;
+}
+
+void sq_fxcorr_add(sq_fxcorr_pipeline* pipeline, unsigned int first, unsigned int nrasters)
+{
+    unsigned int fft_len = pipeline->fft_len;
+    unsigned int chani, blocklen;
+    unsigned int rasteri, inputi, inputj;
+    size_t ofst;
+    cmplx* vis;
+    const cmplx* spectrum;
+
+    // channel blocks outermost: the visibilities of a block are summed over
+    // all the spectra of the batch before the next block is touched
+    for (chani = 0; chani < fft_len; chani += blocklen)
+    {
+        blocklen = (fft_len - chani < pipeline->blocklen) ? (fft_len - chani) : pipeline->blocklen;
+
+        for (rasteri = first; rasteri < first + nrasters; rasteri++)
+        {
+            ofst = ((size_t) rasteri * fft_len) + chani;
+            vis = &pipeline->visbfr[chani];
+
+            for (inputi = 0; inputi < pipeline->ninputs; inputi++)
+            {
+                spectrum = (const cmplx*) &pipeline->inputs[inputi].fft.bfr[ofst];
+
+                for (inputj = inputi; inputj < pipeline->ninputs; inputj++)
+                {
+                    sq_crossmultiply_sum_buf(spectrum, (const cmplx*) &pipeline->inputs[inputj].fft.bfr[ofst],
+                                             vis, blocklen);
+                    vis += fft_len;
+                }
+            }
+        }
+    }
+
+    pipeline->nsummed += nrasters;
+}
+
+int sq_fxcorr_write(sq_fxcorr_pipeline* pipeline, FILE* outstream)
+{
+    size_t nsamples = (size_t) pipeline->nbaselines * pipeline->fft_len;
+    unsigned int baselinei;
+
+    // the spectra were summed in FFTW order; swapping the sums once is the
+    // same as swapping every spectrum
+    for (baselinei = 0; baselinei < pipeline->nbaselines; baselinei++)
+        sq_channelswap(&pipeline->visbfr[(size_t) baselinei * pipeline->fft_len], pipeline->fft_len);
+
+    if (fwrite(pipeline->visbfr, sizeof(cmplx), nsamples, outstream) != nsamples)
+        return ERR_STREAM_WRITE;
+
+    memset(pipeline->visbfr, 0, nsamples * sizeof(cmplx));
+    pipeline->nsummed = 0;
+
+    return 0;
+}
+
+void sq_fxcorr_free(sq_fxcorr_pipeline* pipeline)
+{
+    unsigned int inputi;
+
+    // inputs is NULL if its allocation failed in sq_fxcorr_init
+    if (pipeline->inputs != NULL)
+        for (inputi = 0; inputi < pipeline->ninputs; inputi++)
+            xcorr_input_free(&pipeline->inputs[inputi]);
+    free(pipeline->inputs);
+    free(pipeline->visbfr);
+}
+
+int sq_fxcorr(char** paths, unsigned int ninputs, FILE* outstream, unsigned int fft_len,
+              unsigned int batch, char* window_name, unsigned int folds,
+              unsigned int num_to_sum, unsigned char is_measured)
+{
+    sq_fxcorr_pipeline pipeline;
+    unsigned int inputi, nrasters, rasteri, count;
+    unsigned char is_written = 0;
+    int status;
+
+    status = sq_fxcorr_init(&pipeline, paths, ninputs, fft_len, batch, window_name,
+                            folds, num_to_sum, is_measured);
+    if (status < 0)
+    {
+        sq_fxcorr_free(&pipeline);
+        return status;
+    }
+
+    do
+    {
+        nrasters = batch;
+        for (inputi = 0; inputi < ninputs; inputi++)
+        {
+            xcorr_input_fill(&pipeline.inputs[inputi], fft_len, batch);
+            if (pipeline.inputs[inputi].nrasters < nrasters)
+                nrasters = pipeline.inputs[inputi].nrasters;
+        }
+
+        // an integration may end anywhere in the batch
+        for (rasteri = 0; (status >= 0) && (rasteri < nrasters); rasteri += count)
+        {
+            count = num_to_sum - pipeline.nsummed;
+            if (count > nrasters - rasteri)
+                count = nrasters - rasteri;
+
+            sq_fxcorr_add(&pipeline, rasteri, count);
+
+            if (pipeline.nsummed == num_to_sum)
+            {
+                status = sq_fxcorr_write(&pipeline, outstream);
+                is_written = 1;
+            }
+        }
+    }
+    while ((status >= 0) && (nrasters == batch));
+
+    // like sq_sum, a short integration is only sent if it is the only one
+    if ((status >= 0) && !is_written)
+        status = sq_fxcorr_write(&pipeline, outstream);
+
+    sq_fxcorr_free(&pipeline);
+
+    return status;
+}
+
+// sizes of a flat TFP file without a stream header, as sqtfp writes it
+#define WATERFALL_TFPW 8388608
+#define WATERFALL_NCHANNELS 4096
+#define WATERFALL_BW 8.738133333
+// a band of channels read at once is about this big
+#define WATERFALL_BAND_BYTES (64 << 20)
+
+typedef struct
+{
+    FILE* stream;
+    sq_tiled tiled;
+    unsigned char is_tiled;
+    uint64_t dataofst;
+    unsigned int tfpw;
+    unsigned int chanw;
+    unsigned int imgw;
+    unsigned int nrows;
+    unsigned int nchannels;
+    const char* imagedir;
+    double cfreq;
+    double bw;
+    unsigned int format;
+    unsigned char* lut;
+    unsigned char gammalut[256];
+    // the band being rendered; bandw columns per row, starting with the
+    // statistics strip of offset 0 of channel bandchan
+    float* bandbfr;
+    unsigned int bandw;
+    int bandchan;
+    unsigned int njobs;
+    unsigned int nextjob;
+    int status;
+    // the workers are started once; each new band bumps band and wakes
+    // them, and each worker counts itself in nfinished when it runs out
+    // of jobs
+    unsigned int band;
+    unsigned int nfinished;
+    unsigned char is_stopped;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} waterfall_state;
+
+// first column of offset 0 of a channel; channel 0 is centered on the raster
+static int64_t waterfall_column(const waterfall_state* wf, int chan)
+{
+    return (int64_t) (wf->tfpw / 2) - (wf->chanw / 2) + ((int64_t) chan * wf->chanw);
+}
+
+// number of channels in the band starting at chan; the last band may be short
+static unsigned int waterfall_band(int chan, int rchan, unsigned int bandchans)
+{
+    return ((rchan - chan + 1) < (int) bandchans) ? (unsigned int) (rchan - chan + 1) : bandchans;
+}
+
+static int waterfall_read(waterfall_state* wf, float* bandbfr, int chan, unsigned int nchans)
+{
+    uint64_t col = waterfall_column(wf, chan) - ((SQ_WATERFALL_STATW / 2) * wf->imgw);
+    unsigned int ncols = (nchans * wf->chanw) + ((SQ_WATERFALL_STATW - 1) * wf->imgw);
+    unsigned int rowi;
+
+    if (wf->is_tiled)
+    {
+        int64_t nrows = sq_tiled_read(&wf->tiled, 0, wf->nrows, col, ncols, bandbfr);
+        if (nrows < 0)
+            return nrows;
+        return (nrows == wf->nrows) ? 0 : ERR_STREAM_READ;
+    }
+
+    for (rowi = 0; rowi < wf->nrows; rowi++)
+    {
+        if (fseeko(wf->stream, wf->dataofst + ((((uint64_t) rowi * wf->tfpw) + col) * sizeof(float)), SEEK_SET) != 0)
+            return ERR_STREAM_READ;
+        if (fread(&bandbfr[(size_t) rowi * ncols], sizeof(float), ncols, wf->stream) != ncols)
+            return ERR_STREAM_READ;
+    }
+
+    return 0;
+}
+
+/*
+ * Scales one image like sqgetimgtfp does: the amplitude mean and standard
+ * deviation of the whole statistics strip give the power range, which is
+ * mapped to 0..MAX_PIXEL_VAL and quantized like sq_write_pnm does it.
+ */
+static int waterfall_render(waterfall_state* wf, const float* strip, int chan, unsigned int ofst,
+                            float* rowbfr, unsigned char* pixbfr)
+{
+    unsigned int rowi, coli;
+
+    float imgvalf;
+    float mean, stddev;
+    float min, max;
+    sq_img_stats stats;
+
+    char path[4096];
+    FILE* outstream;
+    int status = 0;
+
+    sq_amp_stats(strip, wf->nrows, SQ_WATERFALL_STATW * wf->imgw, wf->bandw, 0.0, &stats);
+    mean = stats.mean;
+    stddev = stats.stddev;
+
+    min = mean - stddev;
+    if (min < 0.0) min = 0.0;
+    min = min * min;
+    max = mean + (2.3 * stddev);
+    max = max * max;
+
+    // only the middle image of the strip is drawn, the last row on top
+    for (rowi = 0; rowi < wf->nrows; rowi++)
+    {
+        const float* row = &strip[((size_t) rowi * wf->bandw) + ((SQ_WATERFALL_STATW / 2) * wf->imgw)];
+        unsigned char* pixrow = &pixbfr[(size_t) (wf->nrows - 1 - rowi) * wf->imgw];
+
+        for (coli = 0; coli < wf->imgw; coli++)
+        {
+            imgvalf = row[coli];
+            imgvalf -= min;
+            imgvalf *= ((float) MAX_PIXEL_VAL) / (max - min);
+            rowbfr[coli] = imgvalf;
+        }
+        sq_quantize_row(rowbfr, pixrow, wf->imgw, wf->lut);
+    }
+
+    snprintf(path, sizeof(path), "%s/chan%+05d/chan%+05d-%u-%.6f-%.6f.%s",
+             wf->imagedir, chan, chan, ofst,
+             wf->cfreq + ((wf->bw / wf->nchannels) * (chan + ((ofst - 4.0) / SQ_WATERFALL_OFFSETS))),
+             wf->cfreq + ((wf->bw / wf->nchannels) * (chan + ((ofst - 3.0) / SQ_WATERFALL_OFFSETS))),
+             (wf->format == SQ_IMAGE_PNG) ? "png" : "pgm");
+
+    outstream = fopen(path, "wb");
+    if (outstream == NULL)
+        return ERR_STREAM_OPEN;
+
+    if (wf->format == SQ_IMAGE_PNG)
+        status = sq_write_png_pixels(outstream, pixbfr, wf->nrows, wf->imgw);
+    else
+        status = sq_write_pgm_pixels(outstream, pixbfr, wf->nrows, wf->imgw);
+    if (fclose(outstream) != 0)
+        status = ERR_STREAM_WRITE;
+
+    return status;
+}
+
+// renders jobs of the current band until there are none left, or another
+// thread failed
+static void waterfall_jobs(waterfall_state* wf, float* rowbfr, unsigned char* pixbfr)
+{
+    unsigned int job;
+    int status = 0;
+
+    while (status == 0)
+    {
+        pthread_mutex_lock(&wf->lock);
+        job = wf->nextjob++;
+        if (wf->status < 0)
+            job = wf->njobs;
+        pthread_mutex_unlock(&wf->lock);
+
+        if (job >= wf->njobs)
+            break;
+
+        // jobs run across the offsets of a channel, then across channels
+        status = waterfall_render(wf,
+                    &wf->bandbfr[((job / SQ_WATERFALL_OFFSETS) * wf->chanw) + ((job % SQ_WATERFALL_OFFSETS) * wf->imgw)],
+                    wf->bandchan + (int) (job / SQ_WATERFALL_OFFSETS), job % SQ_WATERFALL_OFFSETS, rowbfr, pixbfr);
+    }
+
+    if (status < 0)
+    {
+        pthread_mutex_lock(&wf->lock);
+        wf->status = status;
+        pthread_mutex_unlock(&wf->lock);
+    }
+}
+
+static void* waterfall_worker(void* arg)
+{
+    waterfall_state* wf = arg;
+    unsigned char* pixbfr = malloc((size_t) wf->nrows * wf->imgw);
+    float* rowbfr = malloc(wf->imgw * sizeof(float));
+    unsigned int band = 0;
+
+    pthread_mutex_lock(&wf->lock);
+    for (;;)
+    {
+        while ((wf->band == band) && !wf->is_stopped)
+            pthread_cond_wait(&wf->cond, &wf->lock);
+        if (wf->band == band)
+            break;
+        band = wf->band;
+
+        // a worker without buffers fails the band instead of rendering it
+        if ((pixbfr == NULL) || (rowbfr == NULL))
+            wf->status = ERR_MALLOC;
+        pthread_mutex_unlock(&wf->lock);
+
+        waterfall_jobs(wf, rowbfr, pixbfr);
+
+        pthread_mutex_lock(&wf->lock);
+        wf->nfinished++;
+        pthread_cond_broadcast(&wf->cond);
+    }
+    pthread_mutex_unlock(&wf->lock);
+
+    free(pixbfr);
+    free(rowbfr);
+    return NULL;
+}
+
+static int waterfall_mkdir(const char* path)
+{
+    if ((mkdir(path, 0777) != 0) && (errno != EEXIST))
+        return ERR_STREAM_OPEN;
+    return 0;
+}
+
+// opens the file and works out its geometry; a header fills in cfreq and bw
+static int waterfall_open(waterfall_state* wf, const char* path)
+{
+    sq_stream_header header;
+    uint64_t nrows;
+
+    int status = sq_tiled_open(&wf->tiled, path);
+    if (status == 0)
+    {
+        wf->is_tiled = 1;
+        wf->tfpw = wf->tiled.header.fft_len;
+        if (wf->nchannels == 0)
+            wf->nchannels = wf->tiled.header.nchannels;
+        nrows = wf->tiled.header.rows;
+    }
+    else if (status == ERR_BAD_FORMAT)
+    {
+        wf->stream = fopen(path, "rb");
+        if (wf->stream == NULL)
+            return ERR_STREAM_OPEN;
+
+        wf->tfpw = WATERFALL_TFPW;
+        if ((fread(&header, sizeof(header), 1, wf->stream) == 1) &&
+                (memcmp(header.magic, SQ_STREAM_MAGIC, sizeof(header.magic)) == 0))
+        {
+            wf->dataofst = sizeof(header);
+            wf->tfpw = header.raster_length;
+            if (wf->cfreq == 0.0)
+                wf->cfreq = header.center_freq / 1000000.0;
+            if (wf->bw == 0.0)
+                wf->bw = header.sample_rate / 1000000.0;
+        }
+
+        if ((fseeko(wf->stream, 0, SEEK_END) != 0) || (wf->tfpw == 0))
+            return ERR_STREAM_READ;
+        nrows = (ftello(wf->stream) - wf->dataofst) / ((uint64_t) wf->tfpw * sizeof(float));
+    }
+    else
+        return status;
+
+    if (wf->nchannels == 0)
+        wf->nchannels = WATERFALL_NCHANNELS;
+    if (wf->bw == 0.0)
+        wf->bw = WATERFALL_BW;
+
+    wf->chanw = wf->tfpw / wf->nchannels;
+    wf->imgw = wf->chanw / SQ_WATERFALL_OFFSETS;
+    wf->nrows = (nrows < SQ_WATERFALL_ROWS) ? nrows : SQ_WATERFALL_ROWS;
+
+    if ((wf->cfreq == 0.0) || (wf->imgw == 0) || (wf->nchannels < 2))
+        return ERR_ARG_BOUNDS;
+    if (wf->nrows == 0)
+        return ERR_STREAM_READ;
+
+    return 0;
+}
+
+int sq_waterfalls(const char* path, const char* imagedir, double cfreq, double bw,
+                  unsigned int nchannels, unsigned int format, float gamma,
+                  unsigned int nthreads)
+{
+    waterfall_state wf;
+    pthread_t* threads = NULL;
+    float* bandbfrs[2] = {NULL, NULL};
+    float* rowbfr = NULL;
+    unsigned char* pixbfr = NULL;
+    unsigned int bandchans, bandw, nchans, threadi, nworkers;
+    unsigned int usable;
+    int lchan, rchan, chan, chani;
+    char chandir[4096];
+    int status;
+
+    memset(&wf, 0, sizeof(wf));
+    wf.imagedir = imagedir;
+    wf.cfreq = cfreq;
+    wf.bw = bw;
+    wf.nchannels = nchannels;
+    wf.format = format;
+    if (gamma != 1.0)
+    {
+        sq_gamma_lut(wf.gammalut, gamma);
+        wf.lut = wf.gammalut;
+    }
+    pthread_mutex_init(&wf.lock, NULL);
+    pthread_cond_init(&wf.cond, NULL);
+
+    if (nthreads == 0)
+        nthreads = 1;
+
+    status = waterfall_open(&wf, path);
+    if (status == 0)
+        status = waterfall_mkdir(imagedir);
+    if (status < 0)
+        goto done;
+
+    usable = (wf.nchannels * 3) / 4;
+    lchan = -((int) usable / 2);
+    rchan = -lchan - 1;
+
+    // enough channels per band to keep the threads busy between reads
+    bandchans = WATERFALL_BAND_BYTES / ((size_t) wf.nrows * wf.chanw * sizeof(float));
+    if (bandchans < 1)
+        bandchans = 1;
+    if (bandchans > (unsigned int) (rchan - lchan + 1))
+        bandchans = rchan - lchan + 1;
+    bandw = (bandchans * wf.chanw) + ((SQ_WATERFALL_STATW - 1) * wf.imgw);
+
+    threads = malloc(nthreads * sizeof(pthread_t));
+    bandbfrs[0] = malloc((size_t) wf.nrows * bandw * sizeof(float));
+    bandbfrs[1] = malloc((size_t) wf.nrows * bandw * sizeof(float));
+    if ((threads == NULL) || (bandbfrs[0] == NULL) || (bandbfrs[1] == NULL))
+    {
+        status = ERR_MALLOC;
+        goto done;
+    }
+
+    for (nworkers = 0; nworkers < nthreads; nworkers++)
+        if (pthread_create(&threads[nworkers], NULL, waterfall_worker, &wf) != 0)
+            break;
+
+    // without any thread, the bands are rendered here
+    if (nworkers == 0)
+    {
+        pixbfr = malloc((size_t) wf.nrows * wf.imgw);
+        rowbfr = malloc(wf.imgw * sizeof(float));
+        if ((pixbfr == NULL) || (rowbfr == NULL))
+            status = ERR_MALLOC;
+    }
+
+    if (status == 0)
+        status = waterfall_read(&wf, bandbfrs[0], lchan, waterfall_band(lchan, rchan, bandchans));
+
+    for (chan = lchan; (status == 0) && (chan <= rchan); chan += bandchans)
+    {
+        nchans = waterfall_band(chan, rchan, bandchans);
+
+        for (chani = chan; (status == 0) && (chani < (chan + (int) nchans)); chani++)
+        {
+            snprintf(chandir, sizeof(chandir), "%s/chan%+05d", imagedir, chani);
+            status = waterfall_mkdir(chandir);
+        }
+        if (status < 0)
+            break;
+
+        // the workers are all waiting, so the band can be swapped in
+        pthread_mutex_lock(&wf.lock);
+        wf.bandbfr = bandbfrs[0];
+        wf.bandw = (nchans * wf.chanw) + ((SQ_WATERFALL_STATW - 1) * wf.imgw);
+        wf.bandchan = chan;
+        wf.njobs = nchans * SQ_WATERFALL_OFFSETS;
+        wf.nextjob = 0;
+        wf.nfinished = 0;
+        wf.band++;
+        pthread_cond_broadcast(&wf.cond);
+        pthread_mutex_unlock(&wf.lock);
+
+        // read the next band while this one is rendered
+        if ((chan + (int) bandchans) <= rchan)
+            status = waterfall_read(&wf, bandbfrs[1], chan + bandchans,
+                                    waterfall_band(chan + bandchans, rchan, bandchans));
+
+        if (nworkers == 0)
+            waterfall_jobs(&wf, rowbfr, pixbfr);
+
+        pthread_mutex_lock(&wf.lock);
+        while (wf.nfinished < nworkers)
+            pthread_cond_wait(&wf.cond, &wf.lock);
+        if (wf.status < 0)
+            status = wf.status;
+        pthread_mutex_unlock(&wf.lock);
+
+        float* swap = bandbfrs[0];
+        bandbfrs[0] = bandbfrs[1];
+        bandbfrs[1] = swap;
+    }
+
+    pthread_mutex_lock(&wf.lock);
+    wf.is_stopped = 1;
+    pthread_cond_broadcast(&wf.cond);
+    pthread_mutex_unlock(&wf.lock);
+    for (threadi = 0; threadi < nworkers; threadi++)
+        pthread_join(threads[threadi], NULL);
+
+done:
+    free(rowbfr);
+    free(pixbfr);
+    free(threads);
+    free(bandbfrs[0]);
+    free(bandbfrs[1]);
+    if (wf.is_tiled)
+        sq_tiled_close(&wf.tiled);
+    else if (wf.stream != NULL)
+        fclose(wf.stream);
+    pthread_mutex_destroy(&wf.lock);
+    pthread_cond_destroy(&wf.cond);
+
+    return status;
+}
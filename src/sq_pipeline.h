@@ -0,0 +1,347 @@
+/*******************************************************************************
+
+  File:    sq_pipeline.h
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+#ifndef SQ_PIPELINE_H
+#define SQ_PIPELINE_H
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "sq_constants.h"
+#include "sq_dsp.h"
+#include "sq_utils.h"
+
+/**
+ * In-process time-frequency-power pipeline. This chains the sample, window,
+ * FFT, power and real stages of sqtfp.sh on shared in-memory buffers, so
+ * no raster is copied through a pipe between stages.
+ */
+typedef struct
+{
+    unsigned int fft_len;
+    unsigned int readlen;
+    unsigned char is_wola;
+    sq_wola_state wola;
+    float* wndwbfr;
+    sq_fft_state fft;
+    cmplx* smplbfr;
+    float* pwrbfr;
+} sq_tfp_pipeline;
+
+/**
+ * Allocates the buffers and plans of a time-frequency-power pipeline.
+ * @param pipeline Pipeline to initialize
+ * @param fft_len Length of the FFT
+ * @param window_name "wola" for a weighted overlap-add window, else one of the predefined window names
+ * @param folds Number of WOLA folds; ignored for other windows
+ * @param is_measured If 1, measure the FFT plan instead of estimating it
+ * @return Code; negative if error.
+ */
+int sq_tfp_init(sq_tfp_pipeline* pipeline,
+                unsigned int fft_len,
+                char* window_name,
+                unsigned int folds,
+                unsigned char is_measured);
+
+/**
+ * Runs one read of 8-bit input through the pipeline. The raw buffer must
+ * hold pipeline->readlen complex 8-bit samples.
+ * @param pipeline An initialized pipeline
+ * @param rawbfr Input 2-channel 8-bit samples
+ * @return 1 if a power raster of fft_len floats is ready in pipeline->pwrbfr, 0 if not yet.
+ */
+int sq_tfp_process(sq_tfp_pipeline* pipeline, const signed char* rawbfr);
+
+/**
+ * Frees the buffers and plans of a time-frequency-power pipeline.
+ * @param pipeline Pipeline
+ */
+void sq_tfp_free(sq_tfp_pipeline* pipeline);
+
+/**
+ * Takes 2-channel (quadrature) 8-bit data from the input stream and writes
+ * a time-frequency-power raster of fft_len floats to the output stream for
+ * every transform. This produces the same output as
+ * sqsample | (sqwola or sqwindow) | sqfft | sqpower | sqreal in one process.
+ * @param instream Input stream with 2-channel 8-bit data
+ * @param outstream Output stream of float power values
+ * @param fft_len Length of the FFT
+ * @param window_name "wola" or one of the predefined window names
+ * @param folds Number of WOLA folds
+ * @param is_measured If 1, measure the FFT plan instead of estimating it
+ * @param filesize Size of the input; if nonzero, the percentage progress is printed
+ * @return Code; negative if error.
+ */
+int sq_tfp(FILE* instream, FILE* outstream,
+           unsigned int fft_len,
+           char* window_name,
+           unsigned int folds,
+           unsigned char is_measured,
+           uint64_t filesize);
+
+/**
+ * One input of an in-process correlation: the sample, window and forward
+ * FFT stages of sqcrosscorr.sh, filling a batch of spectra at a time.
+ */
+typedef struct
+{
+    sq_input input;
+    unsigned int readlen;
+    unsigned char is_wola;
+    sq_wola_state wola;
+    float* wndwbfr;
+    cmplx* smplbfr;
+    sq_fft_state fft;
+    // spectra ready in fft.bfr after the last sq_xcorr_fill
+    unsigned int nrasters;
+} sq_xcorr_input;
+
+/**
+ * In-process cross-correlation (or convolution) of two signals, the job of
+ * sqcrosscorr.sh without the named pipes. The forward transforms of the
+ * two inputs run in parallel; the spectra are kept in FFTW order, so no
+ * channel swap is done, and the normalization of the inverse transform is
+ * folded into the multiply. The plans and buffers hold batch rasters and
+ * are reused for every batch.
+ */
+typedef struct
+{
+    unsigned int fft_len;
+    unsigned int batch;
+    unsigned char is_convolution;
+    sq_xcorr_input inputs[2];
+    sq_fft_state inverse;
+} sq_xcorr_pipeline;
+
+/**
+ * Opens the inputs and allocates the buffers and plans of a correlation.
+ * @param pipeline Pipeline to initialize
+ * @param path1 File of signal #1, 2-channel 8-bit samples; "-" for stdin
+ * @param path2 File of signal #2, 2-channel 8-bit samples; "-" for stdin
+ * @param fft_len Length of the FFT
+ * @param batch Number of rasters transformed per plan execution
+ * @param window_name "wola" for a weighted overlap-add window, else one of the predefined window names
+ * @param folds Number of WOLA folds; ignored for other windows
+ * @param is_convolution If 1, multiply the spectra as they are (convolution) instead of by the conjugate of signal #2
+ * @param is_measured If 1, measure the FFT plans instead of estimating them
+ * @return Code; negative if error, in which case the pipeline still
+ *         has to be freed with sq_xcorr_free.
+ */
+int sq_xcorr_init(sq_xcorr_pipeline* pipeline,
+                  const char* path1, const char* path2,
+                  unsigned int fft_len,
+                  unsigned int batch,
+                  char* window_name,
+                  unsigned int folds,
+                  unsigned char is_convolution,
+                  unsigned char is_measured);
+
+/**
+ * Reads, windows and transforms up to pipeline->batch rasters of one input.
+ * The spectra are left in input->fft.bfr, in FFTW order.
+ * @param pipeline An initialized pipeline
+ * @param input One of pipeline->inputs
+ * @return Number of spectra ready; less than the batch at the end of the input
+ */
+unsigned int sq_xcorr_fill(sq_xcorr_pipeline* pipeline, sq_xcorr_input* input);
+
+/**
+ * Multiplies the spectra of the two inputs and transforms the first
+ * nrasters products back into pipeline->inverse.bfr.
+ * @param pipeline A pipeline whose inputs have both been filled
+ * @param nrasters Number of rasters, at most the spectra ready in both inputs
+ */
+void sq_xcorr_process(sq_xcorr_pipeline* pipeline, unsigned int nrasters);
+
+/**
+ * Closes the inputs and frees the buffers and plans of a correlation.
+ * @param pipeline Pipeline
+ */
+void sq_xcorr_free(sq_xcorr_pipeline* pipeline);
+
+/**
+ * Cross-correlates (or convolves) two signals of 2-channel 8-bit data and
+ * writes one raster of fft_len complex floats per transform. This produces
+ * the output of sqcrosscorr.sh (sqconvolution.sh with is_convolution) in
+ * one process: the second input is read and transformed by a thread of its
+ * own, and the inverse transform and output of a batch overlap with the
+ * reading of the next one. Stops at the end of the shorter input.
+ * @param path1 File of signal #1; "-" for stdin
+ * @param path2 File of signal #2; "-" for stdin
+ * @param outstream Output stream of complex float data
+ * @param fft_len Length of the FFT
+ * @param batch Number of rasters transformed per plan execution
+ * @param window_name "wola" or one of the predefined window names
+ * @param folds Number of WOLA folds
+ * @param is_convolution If 1, convolve instead of correlating
+ * @param is_measured If 1, measure the FFT plans instead of estimating them
+ * @return Code; negative if error.
+ */
+int sq_xcorr(const char* path1, const char* path2, FILE* outstream,
+             unsigned int fft_len,
+             unsigned int batch,
+             char* window_name,
+             unsigned int folds,
+             unsigned char is_convolution,
+             unsigned char is_measured);
+
+/**
+ * In-process FX correlator of any number of signals. Every input is
+ * transformed once, and the spectra of all pairs of inputs (baselines),
+ * autocorrelations included, are cross-multiplied and summed over an
+ * integration like sq_sum sums rasters. The visibilities of baseline (i, j),
+ * i <= j, are the sums of X_i * conj(X_j), in the channel order sqfft
+ * writes; they are kept in visbfr in row-major upper triangle order
+ * (0,0), (0,1), ..., (0,N-1), (1,1), ..., (N-1,N-1).
+ */
+typedef struct
+{
+    unsigned int fft_len;
+    unsigned int batch;
+    unsigned int ninputs;
+    unsigned int nbaselines;
+    unsigned int num_to_sum;
+    // spectra summed into visbfr since it was last written
+    unsigned int nsummed;
+    // channels cross-multiplied for every baseline in turn; chosen so that
+    // the visibilities and the spectra of one block stay in cache
+    unsigned int blocklen;
+    sq_xcorr_input* inputs;
+    cmplx* visbfr;
+} sq_fxcorr_pipeline;
+
+/**
+ * Opens the inputs and allocates the buffers and plans of an FX correlator.
+ * @param pipeline Pipeline to initialize
+ * @param paths Files of the signals, 2-channel 8-bit samples; "-" for stdin
+ * @param ninputs Number of signals, at least 2
+ * @param fft_len Length of the FFT
+ * @param batch Number of rasters of each input transformed per plan execution
+ * @param window_name "wola" for a weighted overlap-add window, else one of the predefined window names
+ * @param folds Number of WOLA folds; ignored for other windows
+ * @param num_to_sum Number of spectra summed into one integration
+ * @param is_measured If 1, measure the FFT plans instead of estimating them
+ * @return Code; negative if error, in which case the pipeline still
+ *         has to be freed with sq_fxcorr_free.
+ */
+int sq_fxcorr_init(sq_fxcorr_pipeline* pipeline,
+                   char** paths,
+                   unsigned int ninputs,
+                   unsigned int fft_len,
+                   unsigned int batch,
+                   char* window_name,
+                   unsigned int folds,
+                   unsigned int num_to_sum,
+                   unsigned char is_measured);
+
+/**
+ * Adds the cross products of spectra first to first + nrasters - 1 of the
+ * batch of every input to the visibilities.
+ * @param pipeline A pipeline whose inputs have all been filled
+ * @param first Index of the first spectrum in the batch
+ * @param nrasters Number of spectra; at most num_to_sum - nsummed
+ */
+void sq_fxcorr_add(sq_fxcorr_pipeline* pipeline, unsigned int first, unsigned int nrasters);
+
+/**
+ * Writes the visibilities of every baseline, nbaselines * fft_len complex
+ * floats, and starts a new integration.
+ * @param pipeline Pipeline
+ * @param outstream Output stream
+ * @return Code; negative if error.
+ */
+int sq_fxcorr_write(sq_fxcorr_pipeline* pipeline, FILE* outstream);
+
+/**
+ * Closes the inputs and frees the buffers and plans of an FX correlator.
+ * @param pipeline Pipeline
+ */
+void sq_fxcorr_free(sq_fxcorr_pipeline* pipeline);
+
+/**
+ * Correlates every pair of a set of signals of 2-channel 8-bit data and
+ * writes one visibility matrix (see sq_fxcorr_pipeline) per num_to_sum
+ * spectra. This does the job of an sqcrosscorr-style chain ending in
+ * sqcrossmultiply | sqsum for every baseline, but each input is read and
+ * transformed only once. As with sq_sum, a short last integration is only
+ * written if it is the only one. Stops at the end of the shortest input.
+ * @param paths Files of the signals; "-" for stdin
+ * @param ninputs Number of signals, at least 2
+ * @param outstream Output stream of complex float data
+ * @param fft_len Length of the FFT
+ * @param batch Number of rasters of each input transformed per plan execution
+ * @param window_name "wola" or one of the predefined window names
+ * @param folds Number of WOLA folds
+ * @param num_to_sum Number of spectra summed into one integration
+ * @param is_measured If 1, measure the FFT plans instead of estimating them
+ * @return Code; negative if error.
+ */
+int sq_fxcorr(char** paths, unsigned int ninputs, FILE* outstream,
+              unsigned int fft_len,
+              unsigned int batch,
+              char* window_name,
+              unsigned int folds,
+              unsigned int num_to_sum,
+              unsigned char is_measured);
+
+/**
+ * Geometry of the waterfall images cut from a time-frequency-power file.
+ * Each coarse channel is split into SQ_WATERFALL_OFFSETS images across, and
+ * each image is scaled by the statistics of a strip SQ_WATERFALL_STATW
+ * images wide centered on it. Images are at most SQ_WATERFALL_ROWS tall.
+ */
+#define SQ_WATERFALL_OFFSETS 8
+#define SQ_WATERFALL_STATW 5
+#define SQ_WATERFALL_ROWS 340
+
+/**
+ * Renders the waterfall images of the usable center 3/4 of the channels of
+ * a time-frequency-power file, the job of sqgetimgtfp | sqpnm for every
+ * channel and offset, in one pass over the file. The file is read in bands
+ * of channels; the images of a band are scaled and written by a pool of
+ * threads while the next band is read. Images are written, flipped so that
+ * time runs upwards, to imagedir/chanCCCC/chanCCCC-O-LFREQ-RFREQ.png (or .pgm).
+ * @param path Flat TFP file, which may start with a stream header, or tiled TFP file
+ * @param imagedir Output directory; it and the channel directories are created if missing
+ * @param cfreq Center frequency (MHz); if 0, it is taken from the stream header
+ * @param bw Bandwidth (MHz); if 0, it is taken from the stream header, else 8.738133333
+ * @param nchannels Number of coarse channels; if 0, it is taken from a tiled file, else 4096
+ * @param format SQ_IMAGE_PNG or SQ_IMAGE_PGM
+ * @param gamma Gamma correction of the pixels (see sq_gamma_lut); 1.0 for none
+ * @param nthreads Number of rendering threads
+ * @return Code; negative if error.
+ */
+int sq_waterfalls(const char* path, const char* imagedir,
+                  double cfreq, double bw,
+                  unsigned int nchannels,
+                  unsigned int format,
+                  float gamma,
+                  unsigned int nthreads);
+
+#endif
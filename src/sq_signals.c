@@ -37,6 +37,12 @@
 #include "sq_signals.h"
 
 int sq_gen_sine(FILE* outstream, unsigned int nsamples, unsigned int length, unsigned int sin_arr_length, float wavelength, float SNR)
+{
+    return sq_gen_sine_header(outstream, nsamples, length, sin_arr_length, wavelength, SNR, NULL);
+}
+
+int sq_gen_sine_header(FILE* outstream, unsigned int nsamples, unsigned int length, unsigned int sin_arr_length,
+                       float wavelength, float SNR, sq_stream_header* header)
 {
     if((nsamples <= 0) || (nsamples > MAX_SMPLS_LEN))
         return ERR_ARG_BOUNDS;
@@ -67,6 +73,15 @@ int sq_gen_sine(FILE* outstream, unsigned int nsamples, unsigned int length, uns
         Sin[index] = (float)sin(index * 2 * PI / sin_arr_length);
         Cos[index] = (float)cos(index * 2 * PI / sin_arr_length);
     }    
+
+    if (header != NULL)
+    {
+        // a continuous series, written in chunks of nsamples
+        header->sample_type = SQ_SAMPLE_COMPLEX;
+        header->raster_length = nsamples;
+        header->flags = 0;
+        sq_header_write(outstream, header);
+    }
     
     for (i = 0; i < length; ++i)
     {
@@ -32,6 +32,8 @@
 
 #include <stdio.h>
 
+#include "sq_utils.h"
+
 /**
  * Generate a sinewave with gaussian noise 
  * @param outstream output stream
@@ -48,4 +50,24 @@ int sq_gen_sine(FILE* outstream,
                 float wavelength,
                 float SNR );
 
+/**
+ * Same as sq_gen_sine, and writes a stream header first.
+ * @param outstream output stream
+ * @param nsamples Number of samples to read/process/write in one go
+ * @param length Length of sinewave
+ * @param sin_arr_length Number of samples in one period
+ * @param wavelength Wavelength of sinewave
+ * @param SNR The signal-to-noise ratio
+ * @param header Header to write, with the sample rate, center frequency and
+ *               timestamp filled in; the other fields are set here. NULL
+ *               writes no header.
+ */
+int sq_gen_sine_header(FILE* outstream,
+                       unsigned int nsamples,
+                       unsigned int length,
+                       unsigned int sin_arr_length,
+                       float wavelength,
+                       float SNR,
+                       sq_stream_header* header);
+
 #endif
@@ -0,0 +1,1637 @@
+/*******************************************************************************
+
+  File:    sq_simd.c
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "sq_constants.h"
+#include "sq_simd.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#   define SQ_HAVE_X86_SIMD 1
+#   include <immintrin.h>
+#   define SQ_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+static int simd_level = SQ_SIMD_NONE;
+static pthread_once_t simd_once = PTHREAD_ONCE_INIT;
+
+// the level is worked out in a local and published once, so that no thread
+// sees one above the SETIKIT_SIMD limit
+static void simd_init(void)
+{
+    int level = SQ_SIMD_NONE;
+
+#ifdef SQ_HAVE_X86_SIMD
+    // SSE2 is part of x86-64
+    level = SQ_SIMD_SSE2;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        level = SQ_SIMD_AVX2;
+    if (__builtin_cpu_supports("avx512f"))
+        level = SQ_SIMD_AVX512;
+
+    char* limit = getenv("SETIKIT_SIMD");
+    if (limit != NULL)
+    {
+        if (!strcmp(limit, "none") && (level > SQ_SIMD_NONE))
+            level = SQ_SIMD_NONE;
+        else if (!strcmp(limit, "sse2") && (level > SQ_SIMD_SSE2))
+            level = SQ_SIMD_SSE2;
+        else if (!strcmp(limit, "avx2") && (level > SQ_SIMD_AVX2))
+            level = SQ_SIMD_AVX2;
+    }
+#endif
+
+    simd_level = level;
+}
+
+int sq_simd_level()
+{
+    pthread_once(&simd_once, simd_init);
+    return simd_level;
+}
+
+#ifdef SQ_HAVE_X86_SIMD
+
+/*
+ * SSE2: 2 complex samples per register
+ */
+
+static unsigned int power_sse2(const cmplx* in, float* out, unsigned int n, int take_sqrt)
+{
+    const float* src = (const float*) in;
+    unsigned int smpli;
+    __m128 a, b, re, im, p;
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+    {
+        a = _mm_loadu_ps(&src[(smpli<<1)]);
+        b = _mm_loadu_ps(&src[(smpli<<1) + 4]);
+        re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        p = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+        if (take_sqrt)
+            p = _mm_sqrt_ps(p);
+        _mm_storeu_ps(&out[smpli], p);
+    }
+
+    return smpli;
+}
+
+// the power (or magnitude) of each sample as a complex number with a zero
+// imaginary part; r*r + i*i is added in the real lane, in the scalar order
+static unsigned int power_cmplx_sse2(const cmplx* in, cmplx* out, unsigned int n, int take_sqrt)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m128 real = _mm_castsi128_ps(_mm_set_epi32(0, -1, 0, -1));
+    __m128 sq, p;
+
+    for (smpli = 0; smpli + 2 <= n; smpli += 2)
+    {
+        sq = _mm_loadu_ps(&src[(smpli<<1)]);
+        sq = _mm_mul_ps(sq, sq);
+        p = _mm_add_ps(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 3, 0, 1)));
+        if (take_sqrt)
+            p = _mm_sqrt_ps(p);
+        _mm_storeu_ps(&dst[(smpli<<1)], _mm_and_ps(p, real));
+    }
+
+    return smpli;
+}
+
+static unsigned int phase_sse2(const cmplx* in, cmplx* out, unsigned int n)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    __m128 x, sq, val, mask;
+
+    for (smpli = 0; smpli + 2 <= n; smpli += 2)
+    {
+        x = _mm_loadu_ps(&src[(smpli<<1)]);
+        sq = _mm_mul_ps(x, x);
+        // r*r + i*i in both lanes of each sample
+        val = _mm_sqrt_ps(_mm_add_ps(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 3, 0, 1))));
+        mask = _mm_cmpgt_ps(val, _mm_setzero_ps());
+        x = _mm_or_ps(_mm_and_ps(mask, _mm_div_ps(x, val)), _mm_andnot_ps(mask, x));
+        _mm_storeu_ps(&dst[(smpli<<1)], x);
+    }
+
+    return smpli;
+}
+
+static unsigned int conjugate_sse2(const cmplx* in, cmplx* out, unsigned int n)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m128 sign = _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+
+    for (smpli = 0; smpli + 2 <= n; smpli += 2)
+        _mm_storeu_ps(&dst[(smpli<<1)], _mm_xor_ps(_mm_loadu_ps(&src[(smpli<<1)]), sign));
+
+    return smpli;
+}
+
+static unsigned int offset_sse2(const cmplx* in, cmplx* out, unsigned int n, float real_delta, float imag_delta)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m128 delta = _mm_set_ps(imag_delta, real_delta, imag_delta, real_delta);
+
+    for (smpli = 0; smpli + 2 <= n; smpli += 2)
+        _mm_storeu_ps(&dst[(smpli<<1)], _mm_add_ps(_mm_loadu_ps(&src[(smpli<<1)]), delta));
+
+    return smpli;
+}
+
+static unsigned int affine_sse2(const cmplx* in, cmplx* out, unsigned int n, float a_re, float a_im,
+                                float b_re, float b_im, unsigned char is_conjugated)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m128 conj = is_conjugated ? _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f) : _mm_setzero_ps();
+    const __m128 ar = _mm_set1_ps(a_re);
+    const __m128 ai = _mm_set_ps(a_im, -a_im, a_im, -a_im);
+    const __m128 b = _mm_set_ps(b_im, b_re, b_im, b_re);
+    __m128 x;
+
+    for (smpli = 0; smpli + 2 <= n; smpli += 2)
+    {
+        x = _mm_xor_ps(_mm_loadu_ps(&src[(smpli<<1)]), conj);
+        // (c, d) * (a_re, a_im) = (c*a_re + d*-a_im, d*a_re + c*a_im)
+        x = _mm_add_ps(_mm_mul_ps(x, ar), _mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)), ai));
+        _mm_storeu_ps(&dst[(smpli<<1)], _mm_add_ps(x, b));
+    }
+
+    return smpli;
+}
+
+static unsigned int crossmultiply_sse2(const cmplx* in1, const cmplx* in2, cmplx* out, unsigned int n)
+{
+    const float* src1 = (const float*) in1;
+    const float* src2 = (const float*) in2;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m128 sign = _mm_set_ps(0.0f, -0.0f, 0.0f, -0.0f);
+    __m128 x, y, t1, t2;
+
+    for (smpli = 0; smpli + 2 <= n; smpli += 2)
+    {
+        x = _mm_loadu_ps(&src1[(smpli<<1)]);
+        y = _mm_loadu_ps(&src2[(smpli<<1)]);
+        // (a, b) * (c, d) = (a*c - b*d, b*c + a*d)
+        t1 = _mm_mul_ps(x, _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 2, 0, 0)));
+        t2 = _mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)),
+                        _mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 3, 1, 1)));
+        _mm_storeu_ps(&dst[(smpli<<1)], _mm_add_ps(t1, _mm_xor_ps(t2, sign)));
+    }
+
+    return smpli;
+}
+
+static unsigned int crossmultiply_scale_sse2(const cmplx* in1, const cmplx* in2, cmplx* out, unsigned int n,
+                                             unsigned char is_conjugated, float scale)
+{
+    const float* src1 = (const float*) in1;
+    const float* src2 = (const float*) in2;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m128 sign = _mm_set_ps(0.0f, -0.0f, 0.0f, -0.0f);
+    const __m128 conj = is_conjugated ? _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f) : _mm_setzero_ps();
+    const __m128 scales = _mm_set1_ps(scale);
+    __m128 x, y, t1, t2;
+
+    for (smpli = 0; smpli + 2 <= n; smpli += 2)
+    {
+        x = _mm_loadu_ps(&src1[(smpli<<1)]);
+        y = _mm_xor_ps(_mm_loadu_ps(&src2[(smpli<<1)]), conj);
+        t1 = _mm_mul_ps(x, _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 2, 0, 0)));
+        t2 = _mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)),
+                        _mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 3, 1, 1)));
+        _mm_storeu_ps(&dst[(smpli<<1)], _mm_mul_ps(_mm_add_ps(t1, _mm_xor_ps(t2, sign)), scales));
+    }
+
+    return smpli;
+}
+
+static unsigned int crossmultiply_sum_sse2(const cmplx* in1, const cmplx* in2, cmplx* sum, unsigned int n)
+{
+    const float* src1 = (const float*) in1;
+    const float* src2 = (const float*) in2;
+    float* dst = (float*) sum;
+    unsigned int smpli;
+    const __m128 sign = _mm_set_ps(0.0f, -0.0f, 0.0f, -0.0f);
+    const __m128 conj = _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+    __m128 x, y, t1, t2;
+
+    for (smpli = 0; smpli + 2 <= n; smpli += 2)
+    {
+        x = _mm_loadu_ps(&src1[(smpli<<1)]);
+        y = _mm_xor_ps(_mm_loadu_ps(&src2[(smpli<<1)]), conj);
+        t1 = _mm_mul_ps(x, _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 2, 0, 0)));
+        t2 = _mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)),
+                        _mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 3, 1, 1)));
+        _mm_storeu_ps(&dst[(smpli<<1)], _mm_add_ps(_mm_loadu_ps(&dst[(smpli<<1)]),
+                                                   _mm_add_ps(t1, _mm_xor_ps(t2, sign))));
+    }
+
+    return smpli;
+}
+
+static unsigned int accumulate_sse2(const float* in, double* sum, unsigned int n, double weight)
+{
+    unsigned int i;
+    const __m128d w = _mm_set1_pd(weight);
+    __m128 x;
+
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        x = _mm_loadu_ps(&in[i]);
+        _mm_storeu_pd(&sum[i], _mm_add_pd(_mm_loadu_pd(&sum[i]), _mm_mul_pd(w, _mm_cvtps_pd(x))));
+        _mm_storeu_pd(&sum[i + 2], _mm_add_pd(_mm_loadu_pd(&sum[i + 2]),
+                                              _mm_mul_pd(w, _mm_cvtps_pd(_mm_movehl_ps(x, x)))));
+    }
+
+    return i;
+}
+
+static inline void kahan_sse2(__m128d y, double* sum, double* comp)
+{
+    __m128d s = _mm_loadu_pd(sum);
+    __m128d t;
+
+    y = _mm_sub_pd(y, _mm_loadu_pd(comp));
+    t = _mm_add_pd(s, y);
+    _mm_storeu_pd(comp, _mm_sub_pd(_mm_sub_pd(t, s), y));
+    _mm_storeu_pd(sum, t);
+}
+
+static unsigned int accumulate_kahan_sse2(const float* in, double* sum, double* comp, unsigned int n, double weight)
+{
+    unsigned int i;
+    const __m128d w = _mm_set1_pd(weight);
+    __m128 x;
+
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        x = _mm_loadu_ps(&in[i]);
+        kahan_sse2(_mm_mul_pd(w, _mm_cvtps_pd(x)), &sum[i], &comp[i]);
+        kahan_sse2(_mm_mul_pd(w, _mm_cvtps_pd(_mm_movehl_ps(x, x))), &sum[i + 2], &comp[i + 2]);
+    }
+
+    return i;
+}
+
+static unsigned int leaky_accumulate_sse2(const float* in, double* sum, unsigned int n, double decay)
+{
+    unsigned int i;
+    const __m128d d = _mm_set1_pd(decay);
+    __m128 x;
+
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        x = _mm_loadu_ps(&in[i]);
+        _mm_storeu_pd(&sum[i], _mm_add_pd(_mm_mul_pd(d, _mm_loadu_pd(&sum[i])), _mm_cvtps_pd(x)));
+        _mm_storeu_pd(&sum[i + 2], _mm_add_pd(_mm_mul_pd(d, _mm_loadu_pd(&sum[i + 2])),
+                                              _mm_cvtps_pd(_mm_movehl_ps(x, x))));
+    }
+
+    return i;
+}
+
+static unsigned int sum_sse2(const cmplx* in, unsigned int n, double* sumr, double* sumi)
+{
+    const float* src = (const float*) in;
+    unsigned int smpli;
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    __m128 x;
+    double sums[2];
+
+    for (smpli = 0; smpli + 2 <= n; smpli += 2)
+    {
+        x = _mm_loadu_ps(&src[(smpli<<1)]);
+        acc0 = _mm_add_pd(acc0, _mm_cvtps_pd(x));
+        acc1 = _mm_add_pd(acc1, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+    }
+
+    _mm_storeu_pd(sums, _mm_add_pd(acc0, acc1));
+    *sumr += sums[0];
+    *sumi += sums[1];
+
+    return smpli;
+}
+
+static unsigned int amp_moments_sse2(const float* in, unsigned int n, float offset, double shift,
+                                     double* sum, double* sumsq, float* min, float* max)
+{
+    unsigned int smpli;
+    __m128 vofst = _mm_set1_ps(offset);
+    __m128d vshift = _mm_set1_pd(shift);
+    __m128 vmin = _mm_set1_ps(*min);
+    __m128 vmax = _mm_set1_ps(*max);
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    __m128d q0 = _mm_setzero_pd(), q1 = _mm_setzero_pd();
+    __m128 x, a;
+    __m128d d0, d1;
+    double sums[2], sumsqs[2];
+    float mins[4], maxs[4];
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+    {
+        x = _mm_loadu_ps(&in[smpli]);
+        // the running extreme is the second operand, so a NaN never replaces it
+        vmin = _mm_min_ps(x, vmin);
+        vmax = _mm_max_ps(x, vmax);
+        a = _mm_sqrt_ps(_mm_sub_ps(x, vofst));
+        d0 = _mm_sub_pd(_mm_cvtps_pd(a), vshift);
+        d1 = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(a, a)), vshift);
+        s0 = _mm_add_pd(s0, d0);
+        s1 = _mm_add_pd(s1, d1);
+        q0 = _mm_add_pd(q0, _mm_mul_pd(d0, d0));
+        q1 = _mm_add_pd(q1, _mm_mul_pd(d1, d1));
+    }
+
+    _mm_storeu_pd(sums, _mm_add_pd(s0, s1));
+    _mm_storeu_pd(sumsqs, _mm_add_pd(q0, q1));
+    *sum += sums[0] + sums[1];
+    *sumsq += sumsqs[0] + sumsqs[1];
+
+    _mm_storeu_ps(mins, vmin);
+    _mm_storeu_ps(maxs, vmax);
+    for (n = 0; n < 4; n++)
+    {
+        if (mins[n] < *min) *min = mins[n];
+        if (maxs[n] > *max) *max = maxs[n];
+    }
+
+    return smpli;
+}
+
+static unsigned int max_power_sse2(const cmplx* in, unsigned int n, float* max)
+{
+    const float* src = (const float*) in;
+    unsigned int smpli;
+    __m128 vmax = _mm_set1_ps(*max);
+    __m128 a, b, re, im;
+    float maxs[4];
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+    {
+        a = _mm_loadu_ps(&src[(smpli<<1)]);
+        b = _mm_loadu_ps(&src[(smpli<<1) + 4]);
+        re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        vmax = _mm_max_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)), vmax);
+    }
+
+    _mm_storeu_ps(maxs, vmax);
+    for (n = 0; n < 4; n++)
+        if (maxs[n] > *max) *max = maxs[n];
+
+    return smpli;
+}
+
+static unsigned int max_abs_sse2(const float* in, unsigned int n, float* max)
+{
+    unsigned int smpli;
+    __m128 vmask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 vmax = _mm_set1_ps(*max);
+    float maxs[4];
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+        vmax = _mm_max_ps(_mm_and_ps(_mm_loadu_ps(&in[smpli]), vmask), vmax);
+
+    _mm_storeu_ps(maxs, vmax);
+    for (n = 0; n < 4; n++)
+        if (maxs[n] > *max) *max = maxs[n];
+
+    return smpli;
+}
+
+static unsigned int int8_to_cmplx_sse2(const signed char* in, cmplx* out, unsigned int n, unsigned char is_negated)
+{
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m128 sign = is_negated ? _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f) : _mm_setzero_ps();
+    __m128i x, lo, hi;
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+    {
+        // sign-extend by placing each byte in the top of a wider lane
+        // and shifting it back down arithmetically
+        x = _mm_loadu_si128((const __m128i*) &in[(smpli<<1)]);
+        lo = _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);
+        hi = _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8);
+        _mm_storeu_ps(&dst[(smpli<<1)],
+            _mm_xor_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16)), sign));
+        _mm_storeu_ps(&dst[(smpli<<1) + 4],
+            _mm_xor_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16)), sign));
+        _mm_storeu_ps(&dst[(smpli<<1) + 8],
+            _mm_xor_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16)), sign));
+        _mm_storeu_ps(&dst[(smpli<<1) + 12],
+            _mm_xor_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16)), sign));
+    }
+
+    return smpli;
+}
+
+static unsigned int int16_to_cmplx_sse2(const int16_t* in, cmplx* out, unsigned int n, unsigned char is_negated)
+{
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m128 sign = is_negated ? _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f) : _mm_setzero_ps();
+    __m128i x;
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+    {
+        x = _mm_loadu_si128((const __m128i*) &in[(smpli<<1)]);
+        _mm_storeu_ps(&dst[(smpli<<1)],
+            _mm_xor_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)), sign));
+        _mm_storeu_ps(&dst[(smpli<<1) + 4],
+            _mm_xor_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16)), sign));
+    }
+
+    return smpli;
+}
+
+static unsigned int wola_fold_sse2(const float* wndw, const cmplx* hist, cmplx* out,
+                                   unsigned int n, unsigned int folds)
+{
+    const float* src = (const float*) hist;
+    float* dst = (float*) out;
+    unsigned int ffti, foldi;
+    size_t tap;
+    __m128 w, acc0, acc1;
+
+    for (ffti = 0; ffti + 4 <= n; ffti += 4)
+    {
+        w = _mm_loadu_ps(&wndw[ffti]);
+        acc0 = _mm_mul_ps(_mm_unpacklo_ps(w, w), _mm_loadu_ps(&src[(ffti<<1)]));
+        acc1 = _mm_mul_ps(_mm_unpackhi_ps(w, w), _mm_loadu_ps(&src[(ffti<<1) + 4]));
+        for (foldi = 1; foldi < folds; foldi++)
+        {
+            tap = (size_t) foldi * n + ffti;
+            w = _mm_loadu_ps(&wndw[tap]);
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_unpacklo_ps(w, w), _mm_loadu_ps(&src[(tap<<1)])));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_unpackhi_ps(w, w), _mm_loadu_ps(&src[(tap<<1) + 4])));
+        }
+        _mm_storeu_ps(&dst[(ffti<<1)], acc0);
+        _mm_storeu_ps(&dst[(ffti<<1) + 4], acc1);
+    }
+
+    return ffti;
+}
+
+/*
+ * AVX2: 4 complex samples per register
+ */
+
+SQ_TARGET("avx2")
+static unsigned int power_avx2(const cmplx* in, float* out, unsigned int n, int take_sqrt)
+{
+    const float* src = (const float*) in;
+    unsigned int smpli;
+    __m256 a, b, re, im, p;
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+    {
+        a = _mm256_loadu_ps(&src[(smpli<<1)]);
+        b = _mm256_loadu_ps(&src[(smpli<<1) + 8]);
+        // the in-lane shuffles leave samples in the order 0 1 4 5 2 3 6 7
+        re = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        im = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        p = _mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im));
+        if (take_sqrt)
+            p = _mm256_sqrt_ps(p);
+        p = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(p), _MM_SHUFFLE(3, 1, 2, 0)));
+        _mm256_storeu_ps(&out[smpli], p);
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx2")
+static unsigned int power_cmplx_avx2(const cmplx* in, cmplx* out, unsigned int n, int take_sqrt)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m256 real = _mm256_castsi256_ps(_mm256_set_epi32(0, -1, 0, -1, 0, -1, 0, -1));
+    __m256 sq, p;
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+    {
+        sq = _mm256_loadu_ps(&src[(smpli<<1)]);
+        sq = _mm256_mul_ps(sq, sq);
+        p = _mm256_add_ps(sq, _mm256_permute_ps(sq, _MM_SHUFFLE(2, 3, 0, 1)));
+        if (take_sqrt)
+            p = _mm256_sqrt_ps(p);
+        _mm256_storeu_ps(&dst[(smpli<<1)], _mm256_and_ps(p, real));
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx2")
+static unsigned int phase_avx2(const cmplx* in, cmplx* out, unsigned int n)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    __m256 x, sq, val, mask;
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+    {
+        x = _mm256_loadu_ps(&src[(smpli<<1)]);
+        sq = _mm256_mul_ps(x, x);
+        val = _mm256_sqrt_ps(_mm256_add_ps(sq, _mm256_permute_ps(sq, _MM_SHUFFLE(2, 3, 0, 1))));
+        mask = _mm256_cmp_ps(val, _mm256_setzero_ps(), _CMP_GT_OQ);
+        x = _mm256_blendv_ps(x, _mm256_div_ps(x, val), mask);
+        _mm256_storeu_ps(&dst[(smpli<<1)], x);
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx2")
+static unsigned int conjugate_avx2(const cmplx* in, cmplx* out, unsigned int n)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m256 sign = _mm256_set_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f);
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+        _mm256_storeu_ps(&dst[(smpli<<1)], _mm256_xor_ps(_mm256_loadu_ps(&src[(smpli<<1)]), sign));
+
+    return smpli;
+}
+
+SQ_TARGET("avx2")
+static unsigned int offset_avx2(const cmplx* in, cmplx* out, unsigned int n, float real_delta, float imag_delta)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m256 delta = _mm256_set_ps(imag_delta, real_delta, imag_delta, real_delta,
+                                       imag_delta, real_delta, imag_delta, real_delta);
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+        _mm256_storeu_ps(&dst[(smpli<<1)], _mm256_add_ps(_mm256_loadu_ps(&src[(smpli<<1)]), delta));
+
+    return smpli;
+}
+
+SQ_TARGET("avx2")
+static unsigned int affine_avx2(const cmplx* in, cmplx* out, unsigned int n, float a_re, float a_im,
+                                float b_re, float b_im, unsigned char is_conjugated)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m256 conj = is_conjugated ? _mm256_set_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f)
+                                      : _mm256_setzero_ps();
+    const __m256 ar = _mm256_set1_ps(a_re);
+    const __m256 ai = _mm256_set_ps(a_im, -a_im, a_im, -a_im, a_im, -a_im, a_im, -a_im);
+    const __m256 b = _mm256_set_ps(b_im, b_re, b_im, b_re, b_im, b_re, b_im, b_re);
+    __m256 x;
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+    {
+        x = _mm256_xor_ps(_mm256_loadu_ps(&src[(smpli<<1)]), conj);
+        x = _mm256_add_ps(_mm256_mul_ps(x, ar), _mm256_mul_ps(_mm256_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1)), ai));
+        _mm256_storeu_ps(&dst[(smpli<<1)], _mm256_add_ps(x, b));
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx2")
+static unsigned int crossmultiply_avx2(const cmplx* in1, const cmplx* in2, cmplx* out, unsigned int n)
+{
+    const float* src1 = (const float*) in1;
+    const float* src2 = (const float*) in2;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    __m256 x, y, t1, t2;
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+    {
+        x = _mm256_loadu_ps(&src1[(smpli<<1)]);
+        y = _mm256_loadu_ps(&src2[(smpli<<1)]);
+        t1 = _mm256_mul_ps(x, _mm256_moveldup_ps(y));
+        t2 = _mm256_mul_ps(_mm256_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1)), _mm256_movehdup_ps(y));
+        _mm256_storeu_ps(&dst[(smpli<<1)], _mm256_addsub_ps(t1, t2));
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx2")
+static unsigned int crossmultiply_scale_avx2(const cmplx* in1, const cmplx* in2, cmplx* out, unsigned int n,
+                                             unsigned char is_conjugated, float scale)
+{
+    const float* src1 = (const float*) in1;
+    const float* src2 = (const float*) in2;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m256 conj = is_conjugated ? _mm256_set_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f)
+                                      : _mm256_setzero_ps();
+    const __m256 scales = _mm256_set1_ps(scale);
+    __m256 x, y, t1, t2;
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+    {
+        x = _mm256_loadu_ps(&src1[(smpli<<1)]);
+        y = _mm256_xor_ps(_mm256_loadu_ps(&src2[(smpli<<1)]), conj);
+        t1 = _mm256_mul_ps(x, _mm256_moveldup_ps(y));
+        t2 = _mm256_mul_ps(_mm256_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1)), _mm256_movehdup_ps(y));
+        _mm256_storeu_ps(&dst[(smpli<<1)], _mm256_mul_ps(_mm256_addsub_ps(t1, t2), scales));
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx2")
+static unsigned int crossmultiply_sum_avx2(const cmplx* in1, const cmplx* in2, cmplx* sum, unsigned int n)
+{
+    const float* src1 = (const float*) in1;
+    const float* src2 = (const float*) in2;
+    float* dst = (float*) sum;
+    unsigned int smpli;
+    const __m256 conj = _mm256_set_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f);
+    __m256 x, y, t1, t2;
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+    {
+        x = _mm256_loadu_ps(&src1[(smpli<<1)]);
+        y = _mm256_xor_ps(_mm256_loadu_ps(&src2[(smpli<<1)]), conj);
+        t1 = _mm256_mul_ps(x, _mm256_moveldup_ps(y));
+        t2 = _mm256_mul_ps(_mm256_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1)), _mm256_movehdup_ps(y));
+        _mm256_storeu_ps(&dst[(smpli<<1)], _mm256_add_ps(_mm256_loadu_ps(&dst[(smpli<<1)]),
+                                                         _mm256_addsub_ps(t1, t2)));
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx2")
+static unsigned int accumulate_avx2(const float* in, double* sum, unsigned int n, double weight)
+{
+    unsigned int i;
+    const __m256d w = _mm256_set1_pd(weight);
+
+    for (i = 0; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(&sum[i], _mm256_add_pd(_mm256_loadu_pd(&sum[i]),
+                                                _mm256_mul_pd(w, _mm256_cvtps_pd(_mm_loadu_ps(&in[i])))));
+
+    return i;
+}
+
+SQ_TARGET("avx2")
+static unsigned int accumulate_kahan_avx2(const float* in, double* sum, double* comp, unsigned int n, double weight)
+{
+    unsigned int i;
+    const __m256d w = _mm256_set1_pd(weight);
+    __m256d y, s, t;
+
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        s = _mm256_loadu_pd(&sum[i]);
+        y = _mm256_sub_pd(_mm256_mul_pd(w, _mm256_cvtps_pd(_mm_loadu_ps(&in[i]))), _mm256_loadu_pd(&comp[i]));
+        t = _mm256_add_pd(s, y);
+        _mm256_storeu_pd(&comp[i], _mm256_sub_pd(_mm256_sub_pd(t, s), y));
+        _mm256_storeu_pd(&sum[i], t);
+    }
+
+    return i;
+}
+
+SQ_TARGET("avx2")
+static unsigned int leaky_accumulate_avx2(const float* in, double* sum, unsigned int n, double decay)
+{
+    unsigned int i;
+    const __m256d d = _mm256_set1_pd(decay);
+
+    for (i = 0; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(&sum[i], _mm256_add_pd(_mm256_mul_pd(d, _mm256_loadu_pd(&sum[i])),
+                                                _mm256_cvtps_pd(_mm_loadu_ps(&in[i]))));
+
+    return i;
+}
+
+SQ_TARGET("avx2")
+static unsigned int sum_avx2(const cmplx* in, unsigned int n, double* sumr, double* sumi)
+{
+    const float* src = (const float*) in;
+    unsigned int smpli;
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    double sums[4];
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+    {
+        acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm_loadu_ps(&src[(smpli<<1)])));
+        acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm_loadu_ps(&src[(smpli<<1) + 4])));
+    }
+
+    _mm256_storeu_pd(sums, _mm256_add_pd(acc0, acc1));
+    *sumr += sums[0] + sums[2];
+    *sumi += sums[1] + sums[3];
+
+    return smpli;
+}
+
+SQ_TARGET("avx2")
+static unsigned int amp_moments_avx2(const float* in, unsigned int n, float offset, double shift,
+                                     double* sum, double* sumsq, float* min, float* max)
+{
+    unsigned int smpli;
+    __m256 vofst = _mm256_set1_ps(offset);
+    __m256d vshift = _mm256_set1_pd(shift);
+    __m256 vmin = _mm256_set1_ps(*min);
+    __m256 vmax = _mm256_set1_ps(*max);
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    __m256d q0 = _mm256_setzero_pd(), q1 = _mm256_setzero_pd();
+    __m256 x, a;
+    __m256d d0, d1;
+    double sums[4], sumsqs[4];
+    float mins[8], maxs[8];
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+    {
+        x = _mm256_loadu_ps(&in[smpli]);
+        vmin = _mm256_min_ps(x, vmin);
+        vmax = _mm256_max_ps(x, vmax);
+        a = _mm256_sqrt_ps(_mm256_sub_ps(x, vofst));
+        d0 = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(a)), vshift);
+        d1 = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(a, 1)), vshift);
+        s0 = _mm256_add_pd(s0, d0);
+        s1 = _mm256_add_pd(s1, d1);
+        q0 = _mm256_add_pd(q0, _mm256_mul_pd(d0, d0));
+        q1 = _mm256_add_pd(q1, _mm256_mul_pd(d1, d1));
+    }
+
+    _mm256_storeu_pd(sums, _mm256_add_pd(s0, s1));
+    _mm256_storeu_pd(sumsqs, _mm256_add_pd(q0, q1));
+    *sum += (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    *sumsq += (sumsqs[0] + sumsqs[1]) + (sumsqs[2] + sumsqs[3]);
+
+    _mm256_storeu_ps(mins, vmin);
+    _mm256_storeu_ps(maxs, vmax);
+    for (n = 0; n < 8; n++)
+    {
+        if (mins[n] < *min) *min = mins[n];
+        if (maxs[n] > *max) *max = maxs[n];
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx2")
+static unsigned int max_power_avx2(const cmplx* in, unsigned int n, float* max)
+{
+    const float* src = (const float*) in;
+    unsigned int smpli;
+    __m256 vmax = _mm256_set1_ps(*max);
+    __m256 a, b, re, im;
+    float maxs[8];
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+    {
+        // the shuffles work within 128-bit lanes, so the powers come out
+        // permuted, which does not matter to a maximum
+        a = _mm256_loadu_ps(&src[(smpli<<1)]);
+        b = _mm256_loadu_ps(&src[(smpli<<1) + 8]);
+        re = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        im = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        vmax = _mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im)), vmax);
+    }
+
+    _mm256_storeu_ps(maxs, vmax);
+    for (n = 0; n < 8; n++)
+        if (maxs[n] > *max) *max = maxs[n];
+
+    return smpli;
+}
+
+SQ_TARGET("avx2")
+static unsigned int max_abs_avx2(const float* in, unsigned int n, float* max)
+{
+    unsigned int smpli;
+    __m256 vmask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 vmax = _mm256_set1_ps(*max);
+    float maxs[8];
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+        vmax = _mm256_max_ps(_mm256_and_ps(_mm256_loadu_ps(&in[smpli]), vmask), vmax);
+
+    _mm256_storeu_ps(maxs, vmax);
+    for (n = 0; n < 8; n++)
+        if (maxs[n] > *max) *max = maxs[n];
+
+    return smpli;
+}
+
+SQ_TARGET("avx2")
+static unsigned int int8_to_cmplx_avx2(const signed char* in, cmplx* out, unsigned int n, unsigned char is_negated)
+{
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m256 sign = is_negated ? _mm256_set_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f)
+                                   : _mm256_setzero_ps();
+    __m128i x;
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+    {
+        x = _mm_loadu_si128((const __m128i*) &in[(smpli<<1)]);
+        _mm256_storeu_ps(&dst[(smpli<<1)],
+            _mm256_xor_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(x)), sign));
+        _mm256_storeu_ps(&dst[(smpli<<1) + 8],
+            _mm256_xor_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_unpackhi_epi64(x, x))), sign));
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx2")
+static unsigned int int16_to_cmplx_avx2(const int16_t* in, cmplx* out, unsigned int n, unsigned char is_negated)
+{
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m256 sign = is_negated ? _mm256_set_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f)
+                                   : _mm256_setzero_ps();
+
+    for (smpli = 0; smpli + 4 <= n; smpli += 4)
+        _mm256_storeu_ps(&dst[(smpli<<1)],
+            _mm256_xor_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(
+                _mm_loadu_si128((const __m128i*) &in[(smpli<<1)]))), sign));
+
+    return smpli;
+}
+
+SQ_TARGET("avx2,fma")
+static unsigned int wola_fold_avx2(const float* wndw, const cmplx* hist, cmplx* out,
+                                   unsigned int n, unsigned int folds)
+{
+    const float* src = (const float*) hist;
+    float* dst = (float*) out;
+    unsigned int ffti, foldi;
+    size_t tap;
+    // repeats each coefficient for the real and imaginary lane
+    const __m256i dup = _mm256_set_epi32(3, 3, 2, 2, 1, 1, 0, 0);
+    __m256 acc0, acc1;
+
+    for (ffti = 0; ffti + 8 <= n; ffti += 8)
+    {
+        acc0 = _mm256_setzero_ps();
+        acc1 = _mm256_setzero_ps();
+        for (foldi = 0; foldi < folds; foldi++)
+        {
+            tap = (size_t) foldi * n + ffti;
+            acc0 = _mm256_fmadd_ps(_mm256_permutevar8x32_ps(_mm256_castps128_ps256(_mm_loadu_ps(&wndw[tap])), dup),
+                                   _mm256_loadu_ps(&src[(tap<<1)]), acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_permutevar8x32_ps(_mm256_castps128_ps256(_mm_loadu_ps(&wndw[tap + 4])), dup),
+                                   _mm256_loadu_ps(&src[(tap<<1) + 8]), acc1);
+        }
+        _mm256_storeu_ps(&dst[(ffti<<1)], acc0);
+        _mm256_storeu_ps(&dst[(ffti<<1) + 8], acc1);
+    }
+
+    return ffti;
+}
+
+/*
+ * AVX-512: 8 complex samples per register
+ */
+
+SQ_TARGET("avx512f")
+static unsigned int power_avx512(const cmplx* in, float* out, unsigned int n, int take_sqrt)
+{
+    const float* src = (const float*) in;
+    unsigned int smpli;
+    const __m512i even = _mm512_set_epi32(30, 28, 26, 24, 22, 20, 18, 16, 14, 12, 10, 8, 6, 4, 2, 0);
+    const __m512i odd = _mm512_set_epi32(31, 29, 27, 25, 23, 21, 19, 17, 15, 13, 11, 9, 7, 5, 3, 1);
+    __m512 a, b, re, im, p;
+
+    for (smpli = 0; smpli + 16 <= n; smpli += 16)
+    {
+        a = _mm512_loadu_ps(&src[(smpli<<1)]);
+        b = _mm512_loadu_ps(&src[(smpli<<1) + 16]);
+        re = _mm512_permutex2var_ps(a, even, b);
+        im = _mm512_permutex2var_ps(a, odd, b);
+        p = _mm512_add_ps(_mm512_mul_ps(re, re), _mm512_mul_ps(im, im));
+        if (take_sqrt)
+            p = _mm512_sqrt_ps(p);
+        _mm512_storeu_ps(&out[smpli], p);
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int power_cmplx_avx512(const cmplx* in, cmplx* out, unsigned int n, int take_sqrt)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    __m512 sq, p;
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+    {
+        sq = _mm512_loadu_ps(&src[(smpli<<1)]);
+        sq = _mm512_mul_ps(sq, sq);
+        p = _mm512_add_ps(sq, _mm512_permute_ps(sq, _MM_SHUFFLE(2, 3, 0, 1)));
+        if (take_sqrt)
+            p = _mm512_sqrt_ps(p);
+        _mm512_storeu_ps(&dst[(smpli<<1)], _mm512_maskz_mov_ps(0x5555, p));
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int phase_avx512(const cmplx* in, cmplx* out, unsigned int n)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    __m512 x, sq, val;
+    __mmask16 mask;
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+    {
+        x = _mm512_loadu_ps(&src[(smpli<<1)]);
+        sq = _mm512_mul_ps(x, x);
+        val = _mm512_sqrt_ps(_mm512_add_ps(sq, _mm512_permute_ps(sq, _MM_SHUFFLE(2, 3, 0, 1))));
+        mask = _mm512_cmp_ps_mask(val, _mm512_setzero_ps(), _CMP_GT_OQ);
+        x = _mm512_mask_div_ps(x, mask, x, val);
+        _mm512_storeu_ps(&dst[(smpli<<1)], x);
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int conjugate_avx512(const cmplx* in, cmplx* out, unsigned int n)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    // sign bit of every imaginary lane
+    const __m512i sign = _mm512_set1_epi64(0x8000000000000000LL);
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+        _mm512_storeu_ps(&dst[(smpli<<1)],
+            _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_loadu_ps(&src[(smpli<<1)])), sign)));
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int offset_avx512(const cmplx* in, cmplx* out, unsigned int n, float real_delta, float imag_delta)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    // imaginary delta in the odd lanes
+    const __m512 deltas = _mm512_mask_blend_ps(0xAAAA, _mm512_set1_ps(real_delta), _mm512_set1_ps(imag_delta));
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+        _mm512_storeu_ps(&dst[(smpli<<1)], _mm512_add_ps(_mm512_loadu_ps(&src[(smpli<<1)]), deltas));
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int affine_avx512(const cmplx* in, cmplx* out, unsigned int n, float a_re, float a_im,
+                                  float b_re, float b_im, unsigned char is_conjugated)
+{
+    const float* src = (const float*) in;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    // flips the sign bit of the imaginary lanes (xor of floats needs AVX-512DQ)
+    const __m512i conj = _mm512_set1_epi64(is_conjugated ? (int64_t) 0x8000000000000000ULL : 0);
+    const __m512 ar = _mm512_set1_ps(a_re);
+    const __m512 ai = _mm512_mask_mov_ps(_mm512_set1_ps(a_im), 0x5555, _mm512_set1_ps(-a_im));
+    const __m512 b = _mm512_mask_mov_ps(_mm512_set1_ps(b_im), 0x5555, _mm512_set1_ps(b_re));
+    __m512 x;
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+    {
+        x = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_loadu_si512(&src[(smpli<<1)]), conj));
+        x = _mm512_add_ps(_mm512_mul_ps(x, ar), _mm512_mul_ps(_mm512_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1)), ai));
+        _mm512_storeu_ps(&dst[(smpli<<1)], _mm512_add_ps(x, b));
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int crossmultiply_avx512(const cmplx* in1, const cmplx* in2, cmplx* out, unsigned int n)
+{
+    const float* src1 = (const float*) in1;
+    const float* src2 = (const float*) in2;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    __m512 x, y, t1, t2;
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+    {
+        x = _mm512_loadu_ps(&src1[(smpli<<1)]);
+        y = _mm512_loadu_ps(&src2[(smpli<<1)]);
+        t1 = _mm512_mul_ps(x, _mm512_moveldup_ps(y));
+        t2 = _mm512_mul_ps(_mm512_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1)), _mm512_movehdup_ps(y));
+        // subtract in the real lanes, add in the imaginary lanes
+        _mm512_storeu_ps(&dst[(smpli<<1)], _mm512_mask_sub_ps(_mm512_add_ps(t1, t2), 0x5555, t1, t2));
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int crossmultiply_scale_avx512(const cmplx* in1, const cmplx* in2, cmplx* out, unsigned int n,
+                                               unsigned char is_conjugated, float scale)
+{
+    const float* src1 = (const float*) in1;
+    const float* src2 = (const float*) in2;
+    float* dst = (float*) out;
+    unsigned int smpli;
+    // flips the sign bit of the imaginary lanes (xor of floats needs AVX-512DQ)
+    const __m512i conj = _mm512_set1_epi64(is_conjugated ? (int64_t) 0x8000000000000000ULL : 0);
+    const __m512 scales = _mm512_set1_ps(scale);
+    __m512 x, y, t1, t2;
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+    {
+        x = _mm512_loadu_ps(&src1[(smpli<<1)]);
+        y = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_loadu_si512(&src2[(smpli<<1)]), conj));
+        t1 = _mm512_mul_ps(x, _mm512_moveldup_ps(y));
+        t2 = _mm512_mul_ps(_mm512_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1)), _mm512_movehdup_ps(y));
+        _mm512_storeu_ps(&dst[(smpli<<1)],
+                         _mm512_mul_ps(_mm512_mask_sub_ps(_mm512_add_ps(t1, t2), 0x5555, t1, t2), scales));
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int crossmultiply_sum_avx512(const cmplx* in1, const cmplx* in2, cmplx* sum, unsigned int n)
+{
+    const float* src1 = (const float*) in1;
+    const float* src2 = (const float*) in2;
+    float* dst = (float*) sum;
+    unsigned int smpli;
+    const __m512i conj = _mm512_set1_epi64((int64_t) 0x8000000000000000ULL);
+    __m512 x, y, t1, t2;
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+    {
+        x = _mm512_loadu_ps(&src1[(smpli<<1)]);
+        y = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_loadu_si512(&src2[(smpli<<1)]), conj));
+        t1 = _mm512_mul_ps(x, _mm512_moveldup_ps(y));
+        t2 = _mm512_mul_ps(_mm512_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1)), _mm512_movehdup_ps(y));
+        _mm512_storeu_ps(&dst[(smpli<<1)],
+                         _mm512_add_ps(_mm512_loadu_ps(&dst[(smpli<<1)]),
+                                       _mm512_mask_sub_ps(_mm512_add_ps(t1, t2), 0x5555, t1, t2)));
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int accumulate_avx512(const float* in, double* sum, unsigned int n, double weight)
+{
+    unsigned int i;
+    const __m512d w = _mm512_set1_pd(weight);
+
+    for (i = 0; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(&sum[i], _mm512_add_pd(_mm512_loadu_pd(&sum[i]),
+                                                _mm512_mul_pd(w, _mm512_cvtps_pd(_mm256_loadu_ps(&in[i])))));
+
+    return i;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int accumulate_kahan_avx512(const float* in, double* sum, double* comp, unsigned int n, double weight)
+{
+    unsigned int i;
+    const __m512d w = _mm512_set1_pd(weight);
+    __m512d y, s, t;
+
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        s = _mm512_loadu_pd(&sum[i]);
+        y = _mm512_sub_pd(_mm512_mul_pd(w, _mm512_cvtps_pd(_mm256_loadu_ps(&in[i]))), _mm512_loadu_pd(&comp[i]));
+        t = _mm512_add_pd(s, y);
+        _mm512_storeu_pd(&comp[i], _mm512_sub_pd(_mm512_sub_pd(t, s), y));
+        _mm512_storeu_pd(&sum[i], t);
+    }
+
+    return i;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int leaky_accumulate_avx512(const float* in, double* sum, unsigned int n, double decay)
+{
+    unsigned int i;
+    const __m512d d = _mm512_set1_pd(decay);
+
+    for (i = 0; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(&sum[i], _mm512_add_pd(_mm512_mul_pd(d, _mm512_loadu_pd(&sum[i])),
+                                                _mm512_cvtps_pd(_mm256_loadu_ps(&in[i]))));
+
+    return i;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int sum_avx512(const cmplx* in, unsigned int n, double* sumr, double* sumi)
+{
+    const float* src = (const float*) in;
+    unsigned int smpli;
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    double sums[8];
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+    {
+        acc0 = _mm512_add_pd(acc0, _mm512_cvtps_pd(_mm256_loadu_ps(&src[(smpli<<1)])));
+        acc1 = _mm512_add_pd(acc1, _mm512_cvtps_pd(_mm256_loadu_ps(&src[(smpli<<1) + 8])));
+    }
+
+    _mm512_storeu_pd(sums, _mm512_add_pd(acc0, acc1));
+    *sumr += (sums[0] + sums[2]) + (sums[4] + sums[6]);
+    *sumi += (sums[1] + sums[3]) + (sums[5] + sums[7]);
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int amp_moments_avx512(const float* in, unsigned int n, float offset, double shift,
+                                       double* sum, double* sumsq, float* min, float* max)
+{
+    unsigned int smpli;
+    __m512 vofst = _mm512_set1_ps(offset);
+    __m512d vshift = _mm512_set1_pd(shift);
+    __m512 vmin = _mm512_set1_ps(*min);
+    __m512 vmax = _mm512_set1_ps(*max);
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    __m512d q0 = _mm512_setzero_pd(), q1 = _mm512_setzero_pd();
+    __m512 x, a;
+    __m512d d0, d1;
+    double sums[8], sumsqs[8];
+    float mins[16], maxs[16];
+
+    for (smpli = 0; smpli + 16 <= n; smpli += 16)
+    {
+        x = _mm512_loadu_ps(&in[smpli]);
+        vmin = _mm512_min_ps(x, vmin);
+        vmax = _mm512_max_ps(x, vmax);
+        a = _mm512_sqrt_ps(_mm512_sub_ps(x, vofst));
+        d0 = _mm512_sub_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(a)), vshift);
+        d1 = _mm512_sub_pd(_mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(a), 1))), vshift);
+        s0 = _mm512_add_pd(s0, d0);
+        s1 = _mm512_add_pd(s1, d1);
+        q0 = _mm512_add_pd(q0, _mm512_mul_pd(d0, d0));
+        q1 = _mm512_add_pd(q1, _mm512_mul_pd(d1, d1));
+    }
+
+    _mm512_storeu_pd(sums, _mm512_add_pd(s0, s1));
+    _mm512_storeu_pd(sumsqs, _mm512_add_pd(q0, q1));
+    for (n = 0; n < 8; n++)
+    {
+        *sum += sums[n];
+        *sumsq += sumsqs[n];
+    }
+
+    _mm512_storeu_ps(mins, vmin);
+    _mm512_storeu_ps(maxs, vmax);
+    for (n = 0; n < 16; n++)
+    {
+        if (mins[n] < *min) *min = mins[n];
+        if (maxs[n] > *max) *max = maxs[n];
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int max_power_avx512(const cmplx* in, unsigned int n, float* max)
+{
+    const float* src = (const float*) in;
+    unsigned int smpli;
+    __m512 vmax = _mm512_set1_ps(*max);
+    __m512 a, b, re, im;
+    float maxs[16];
+
+    for (smpli = 0; smpli + 16 <= n; smpli += 16)
+    {
+        a = _mm512_loadu_ps(&src[(smpli<<1)]);
+        b = _mm512_loadu_ps(&src[(smpli<<1) + 16]);
+        re = _mm512_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        im = _mm512_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        vmax = _mm512_max_ps(_mm512_add_ps(_mm512_mul_ps(re, re), _mm512_mul_ps(im, im)), vmax);
+    }
+
+    _mm512_storeu_ps(maxs, vmax);
+    for (n = 0; n < 16; n++)
+        if (maxs[n] > *max) *max = maxs[n];
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int max_abs_avx512(const float* in, unsigned int n, float* max)
+{
+    unsigned int smpli;
+    __m512i vmask = _mm512_set1_epi32(0x7fffffff);
+    __m512 vmax = _mm512_set1_ps(*max);
+    float maxs[16];
+
+    for (smpli = 0; smpli + 16 <= n; smpli += 16)
+        vmax = _mm512_max_ps(_mm512_castsi512_ps(_mm512_and_si512(
+                   _mm512_castps_si512(_mm512_loadu_ps(&in[smpli])), vmask)), vmax);
+
+    _mm512_storeu_ps(maxs, vmax);
+    for (n = 0; n < 16; n++)
+        if (maxs[n] > *max) *max = maxs[n];
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int int8_to_cmplx_avx512(const signed char* in, cmplx* out, unsigned int n, unsigned char is_negated)
+{
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m512i sign = _mm512_set1_epi64(is_negated ? 0x8000000000000000LL : 0);
+    __m512 x;
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+    {
+        x = _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm_loadu_si128((const __m128i*) &in[(smpli<<1)])));
+        _mm512_storeu_ps(&dst[(smpli<<1)], _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(x), sign)));
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int int16_to_cmplx_avx512(const int16_t* in, cmplx* out, unsigned int n, unsigned char is_negated)
+{
+    float* dst = (float*) out;
+    unsigned int smpli;
+    const __m512i sign = _mm512_set1_epi64(is_negated ? 0x8000000000000000LL : 0);
+    __m512 x;
+
+    for (smpli = 0; smpli + 8 <= n; smpli += 8)
+    {
+        x = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i*) &in[(smpli<<1)])));
+        _mm512_storeu_ps(&dst[(smpli<<1)], _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(x), sign)));
+    }
+
+    return smpli;
+}
+
+SQ_TARGET("avx512f")
+static unsigned int wola_fold_avx512(const float* wndw, const cmplx* hist, cmplx* out,
+                                     unsigned int n, unsigned int folds)
+{
+    const float* src = (const float*) hist;
+    float* dst = (float*) out;
+    unsigned int ffti, foldi;
+    size_t tap;
+    const __m512i dup = _mm512_set_epi32(7, 7, 6, 6, 5, 5, 4, 4, 3, 3, 2, 2, 1, 1, 0, 0);
+    __m512 acc0, acc1;
+
+    for (ffti = 0; ffti + 16 <= n; ffti += 16)
+    {
+        acc0 = _mm512_setzero_ps();
+        acc1 = _mm512_setzero_ps();
+        for (foldi = 0; foldi < folds; foldi++)
+        {
+            tap = (size_t) foldi * n + ffti;
+            acc0 = _mm512_fmadd_ps(_mm512_permutexvar_ps(dup, _mm512_castps256_ps512(_mm256_loadu_ps(&wndw[tap]))),
+                                   _mm512_loadu_ps(&src[(tap<<1)]), acc0);
+            acc1 = _mm512_fmadd_ps(_mm512_permutexvar_ps(dup, _mm512_castps256_ps512(_mm256_loadu_ps(&wndw[tap + 8]))),
+                                   _mm512_loadu_ps(&src[(tap<<1) + 16]), acc1);
+        }
+        _mm512_storeu_ps(&dst[(ffti<<1)], acc0);
+        _mm512_storeu_ps(&dst[(ffti<<1) + 16], acc1);
+    }
+
+    return ffti;
+}
+
+#endif
+
+unsigned int sq_simd_power(const cmplx* in, float* out, unsigned int n)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return power_avx512(in, out, n, 0);
+        case SQ_SIMD_AVX2:   return power_avx2(in, out, n, 0);
+        case SQ_SIMD_SSE2:   return power_sse2(in, out, n, 0);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_abs(const cmplx* in, float* out, unsigned int n)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return power_avx512(in, out, n, 1);
+        case SQ_SIMD_AVX2:   return power_avx2(in, out, n, 1);
+        case SQ_SIMD_SSE2:   return power_sse2(in, out, n, 1);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_power_cmplx(const cmplx* in, cmplx* out, unsigned int n)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return power_cmplx_avx512(in, out, n, 0);
+        case SQ_SIMD_AVX2:   return power_cmplx_avx2(in, out, n, 0);
+        case SQ_SIMD_SSE2:   return power_cmplx_sse2(in, out, n, 0);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_abs_cmplx(const cmplx* in, cmplx* out, unsigned int n)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return power_cmplx_avx512(in, out, n, 1);
+        case SQ_SIMD_AVX2:   return power_cmplx_avx2(in, out, n, 1);
+        case SQ_SIMD_SSE2:   return power_cmplx_sse2(in, out, n, 1);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_phase(const cmplx* in, cmplx* out, unsigned int n)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return phase_avx512(in, out, n);
+        case SQ_SIMD_AVX2:   return phase_avx2(in, out, n);
+        case SQ_SIMD_SSE2:   return phase_sse2(in, out, n);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_conjugate(const cmplx* in, cmplx* out, unsigned int n)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return conjugate_avx512(in, out, n);
+        case SQ_SIMD_AVX2:   return conjugate_avx2(in, out, n);
+        case SQ_SIMD_SSE2:   return conjugate_sse2(in, out, n);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_offset(const cmplx* in, cmplx* out, unsigned int n, float real_delta, float imag_delta)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return offset_avx512(in, out, n, real_delta, imag_delta);
+        case SQ_SIMD_AVX2:   return offset_avx2(in, out, n, real_delta, imag_delta);
+        case SQ_SIMD_SSE2:   return offset_sse2(in, out, n, real_delta, imag_delta);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_affine(const cmplx* in, cmplx* out, unsigned int n, float a_re, float a_im,
+                            float b_re, float b_im, unsigned char is_conjugated)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return affine_avx512(in, out, n, a_re, a_im, b_re, b_im, is_conjugated);
+        case SQ_SIMD_AVX2:   return affine_avx2(in, out, n, a_re, a_im, b_re, b_im, is_conjugated);
+        case SQ_SIMD_SSE2:   return affine_sse2(in, out, n, a_re, a_im, b_re, b_im, is_conjugated);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_crossmultiply(const cmplx* in1, const cmplx* in2, cmplx* out, unsigned int n)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return crossmultiply_avx512(in1, in2, out, n);
+        case SQ_SIMD_AVX2:   return crossmultiply_avx2(in1, in2, out, n);
+        case SQ_SIMD_SSE2:   return crossmultiply_sse2(in1, in2, out, n);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_crossmultiply_scale(const cmplx* in1, const cmplx* in2, cmplx* out, unsigned int n,
+                                         unsigned char is_conjugated, float scale)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return crossmultiply_scale_avx512(in1, in2, out, n, is_conjugated, scale);
+        case SQ_SIMD_AVX2:   return crossmultiply_scale_avx2(in1, in2, out, n, is_conjugated, scale);
+        case SQ_SIMD_SSE2:   return crossmultiply_scale_sse2(in1, in2, out, n, is_conjugated, scale);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_crossmultiply_sum(const cmplx* in1, const cmplx* in2, cmplx* sum, unsigned int n)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return crossmultiply_sum_avx512(in1, in2, sum, n);
+        case SQ_SIMD_AVX2:   return crossmultiply_sum_avx2(in1, in2, sum, n);
+        case SQ_SIMD_SSE2:   return crossmultiply_sum_sse2(in1, in2, sum, n);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_accumulate(const float* in, double* sum, unsigned int n, double weight)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return accumulate_avx512(in, sum, n, weight);
+        case SQ_SIMD_AVX2:   return accumulate_avx2(in, sum, n, weight);
+        case SQ_SIMD_SSE2:   return accumulate_sse2(in, sum, n, weight);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_accumulate_kahan(const float* in, double* sum, double* comp, unsigned int n, double weight)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return accumulate_kahan_avx512(in, sum, comp, n, weight);
+        case SQ_SIMD_AVX2:   return accumulate_kahan_avx2(in, sum, comp, n, weight);
+        case SQ_SIMD_SSE2:   return accumulate_kahan_sse2(in, sum, comp, n, weight);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_leaky_accumulate(const float* in, double* sum, unsigned int n, double decay)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return leaky_accumulate_avx512(in, sum, n, decay);
+        case SQ_SIMD_AVX2:   return leaky_accumulate_avx2(in, sum, n, decay);
+        case SQ_SIMD_SSE2:   return leaky_accumulate_sse2(in, sum, n, decay);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_int8_to_cmplx(const signed char* in, cmplx* out, unsigned int n, unsigned char is_negated)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return int8_to_cmplx_avx512(in, out, n, is_negated);
+        case SQ_SIMD_AVX2:   return int8_to_cmplx_avx2(in, out, n, is_negated);
+        case SQ_SIMD_SSE2:   return int8_to_cmplx_sse2(in, out, n, is_negated);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_int16_to_cmplx(const int16_t* in, cmplx* out, unsigned int n, unsigned char is_negated)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return int16_to_cmplx_avx512(in, out, n, is_negated);
+        case SQ_SIMD_AVX2:   return int16_to_cmplx_avx2(in, out, n, is_negated);
+        case SQ_SIMD_SSE2:   return int16_to_cmplx_sse2(in, out, n, is_negated);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_wola_fold(const float* wndw, const cmplx* hist, cmplx* out,
+                               unsigned int n, unsigned int folds)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return wola_fold_avx512(wndw, hist, out, n, folds);
+        case SQ_SIMD_AVX2:   return wola_fold_avx2(wndw, hist, out, n, folds);
+        case SQ_SIMD_SSE2:   return wola_fold_sse2(wndw, hist, out, n, folds);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_sum(const cmplx* in, unsigned int n, double* sumr, double* sumi)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return sum_avx512(in, n, sumr, sumi);
+        case SQ_SIMD_AVX2:   return sum_avx2(in, n, sumr, sumi);
+        case SQ_SIMD_SSE2:   return sum_sse2(in, n, sumr, sumi);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_amp_moments(const float* in, unsigned int n, float offset, double shift,
+                                 double* sum, double* sumsq, float* min, float* max)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return amp_moments_avx512(in, n, offset, shift, sum, sumsq, min, max);
+        case SQ_SIMD_AVX2:   return amp_moments_avx2(in, n, offset, shift, sum, sumsq, min, max);
+        case SQ_SIMD_SSE2:   return amp_moments_sse2(in, n, offset, shift, sum, sumsq, min, max);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_max_power(const cmplx* in, unsigned int n, float* max)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return max_power_avx512(in, n, max);
+        case SQ_SIMD_AVX2:   return max_power_avx2(in, n, max);
+        case SQ_SIMD_SSE2:   return max_power_sse2(in, n, max);
+    }
+#endif
+    return 0;
+}
+
+unsigned int sq_simd_max_abs(const float* in, unsigned int n, float* max)
+{
+#ifdef SQ_HAVE_X86_SIMD
+    switch (sq_simd_level())
+    {
+        case SQ_SIMD_AVX512: return max_abs_avx512(in, n, max);
+        case SQ_SIMD_AVX2:   return max_abs_avx2(in, n, max);
+        case SQ_SIMD_SSE2:   return max_abs_sse2(in, n, max);
+    }
+#endif
+    return 0;
+}
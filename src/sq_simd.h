@@ -0,0 +1,155 @@
+/*******************************************************************************
+
+  File:    sq_simd.h
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+#ifndef SQ_SIMD_H
+#define SQ_SIMD_H
+
+#include "sq_constants.h"
+
+// Instruction set levels, in increasing order
+#define SQ_SIMD_NONE 0
+#define SQ_SIMD_SSE2 1
+#define SQ_SIMD_AVX2 2
+#define SQ_SIMD_AVX512 3
+
+/*
+ * Vectorized versions of the elementwise buffer kernels in sq_dsp. Each
+ * one processes the longest prefix of the buffer that fits its vector
+ * width, using the best instruction set of the running CPU, and returns
+ * the number of samples it processed; the caller finishes the rest with
+ * scalar code. They return 0 when no vector unit is available.
+ *
+ * Results are bit-identical to the scalar kernels, except for the sums
+ * of sq_simd_sum and sq_simd_amp_moments, which add in a different order
+ * (in double precision, so the difference is far below float resolution), and the
+ * AVX2/AVX-512 WOLA fold, which rounds once per fused multiply-add.
+ */
+
+/**
+ * Returns the instruction set level used by the kernels. It is detected
+ * with cpuid the first time, and can be lowered (for comparisons) by
+ * setting SETIKIT_SIMD to none, sse2, avx2 or avx512 in the environment.
+ * @return One of the SQ_SIMD_* levels
+ */
+int sq_simd_level();
+
+unsigned int sq_simd_power(const cmplx* in, float* out, unsigned int n);
+unsigned int sq_simd_abs(const cmplx* in, float* out, unsigned int n);
+
+/**
+ * Power (or magnitude) of each sample, written as a complex sample with a
+ * zero imaginary part, as sq_power and sq_abs stream it.
+ * @return Number of samples processed
+ */
+unsigned int sq_simd_power_cmplx(const cmplx* in, cmplx* out, unsigned int n);
+unsigned int sq_simd_abs_cmplx(const cmplx* in, cmplx* out, unsigned int n);
+
+unsigned int sq_simd_phase(const cmplx* in, cmplx* out, unsigned int n);
+unsigned int sq_simd_conjugate(const cmplx* in, cmplx* out, unsigned int n);
+unsigned int sq_simd_offset(const cmplx* in, cmplx* out, unsigned int n, float real_delta, float imag_delta);
+unsigned int sq_simd_crossmultiply(const cmplx* in1, const cmplx* in2, cmplx* out, unsigned int n);
+
+/**
+ * Complex affine map out = a * x + b, where x is the input sample or, if
+ * is_conjugated is set, its conjugate.
+ * @return Number of samples processed
+ */
+unsigned int sq_simd_affine(const cmplx* in, cmplx* out, unsigned int n, float a_re, float a_im,
+                            float b_re, float b_im, unsigned char is_conjugated);
+
+/**
+ * Multiplies in1 by in2, or by the conjugate of in2 if is_conjugated is
+ * set, and scales the products.
+ * @return Number of samples processed
+ */
+unsigned int sq_simd_crossmultiply_scale(const cmplx* in1, const cmplx* in2, cmplx* out, unsigned int n,
+                                         unsigned char is_conjugated, float scale);
+
+/**
+ * Adds the products of in1 and the conjugate of in2 to sum.
+ * @return Number of samples processed
+ */
+unsigned int sq_simd_crossmultiply_sum(const cmplx* in1, const cmplx* in2, cmplx* sum, unsigned int n);
+
+/**
+ * Converts interleaved 8-bit or 16-bit I/Q to complex floats, negating the
+ * imaginary part if is_negated is set.
+ * @return Number of samples converted
+ */
+unsigned int sq_simd_int8_to_cmplx(const signed char* in, cmplx* out, unsigned int n, unsigned char is_negated);
+unsigned int sq_simd_int16_to_cmplx(const int16_t* in, cmplx* out, unsigned int n, unsigned char is_negated);
+
+/**
+ * Polyphase WOLA fold: out[k] = sum over f of wndw[f * n + k] * hist[f * n + k],
+ * accumulated with fused multiply-adds, so it may differ from the scalar
+ * sum in the last bit.
+ * @return Number of output samples computed
+ */
+unsigned int sq_simd_wola_fold(const float* wndw, const cmplx* hist, cmplx* out,
+                               unsigned int n, unsigned int folds);
+
+/**
+ * Adds the real and imaginary parts of the samples into *sumr and *sumi.
+ * @return Number of samples added
+ */
+unsigned int sq_simd_sum(const cmplx* in, unsigned int n, double* sumr, double* sumi);
+
+/**
+ * Adds weight * in[i] to the double sums sum[i] of n floats; the Kahan
+ * version keeps the running compensation of each sum in comp.
+ * @return Number of values added
+ */
+unsigned int sq_simd_accumulate(const float* in, double* sum, unsigned int n, double weight);
+unsigned int sq_simd_accumulate_kahan(const float* in, double* sum, double* comp, unsigned int n, double weight);
+
+/**
+ * Leaky integration of n floats: sum[i] = decay * sum[i] + in[i].
+ * @return Number of values added
+ */
+unsigned int sq_simd_leaky_accumulate(const float* in, double* sum, unsigned int n, double decay);
+
+/**
+ * Accumulates the moments of the amplitudes a = sqrt(in - offset) of power
+ * values about shift: adds a - shift into *sum and (a - shift)^2 into
+ * *sumsq, in double precision, and lowers *min and raises *max to the
+ * extremes of the power values.
+ * @return Number of values processed
+ */
+unsigned int sq_simd_amp_moments(const float* in, unsigned int n, float offset, double shift,
+                                 double* sum, double* sumsq, float* min, float* max);
+
+/**
+ * Raises *max to the largest power (or magnitude, for real samples) in
+ * the buffer. NaNs are skipped, as in the scalar comparisons.
+ * @return Number of samples examined
+ */
+unsigned int sq_simd_max_power(const cmplx* in, unsigned int n, float* max);
+unsigned int sq_simd_max_abs(const float* in, unsigned int n, float* max);
+
+#endif
@@ -0,0 +1,298 @@
+/*******************************************************************************
+
+  File:    sq_tiled.c
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+#ifndef __x86_64__
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "sq_constants.h"
+#include "sq_tiled.h"
+#include "sq_utils.h"
+
+int sq_tiled_convert(FILE* instream, FILE* outstream, unsigned int fft_len,
+                     unsigned int nchannels, unsigned int tile_rows, unsigned int tile_cols)
+{
+    sq_tiled_header header;
+    sq_input input;
+    const float* row;
+    float* band;
+    uint64_t* index = NULL;
+    uint64_t nbands = 0;
+    uint64_t offset;
+    unsigned int ntiles = 0;
+    unsigned int rowi = 0;
+    unsigned int tilei;
+    size_t tile_len;
+
+    if (!((fft_len >= 2) && (fft_len <= MAX_SMPLS_LEN)))
+    {
+        fprintf(stderr, "Array lengths must be between 2 and %u\n", MAX_SMPLS_LEN);
+        return ERR_ARG_BOUNDS;
+    }
+    if ((tile_rows < 1) || (tile_cols < 1) || (fft_len % tile_cols != 0))
+    {
+        sq_error_print("Tile width must divide the FFT length.\n");
+        return ERR_ARG_BOUNDS;
+    }
+    if ((nchannels < 1) || (fft_len % nchannels != 0))
+    {
+        sq_error_print("Number of channels must divide the FFT length.\n");
+        return ERR_ARG_BOUNDS;
+    }
+
+    ntiles = fft_len / tile_cols;
+    tile_len = (size_t) tile_rows * tile_cols;
+
+    band = calloc((size_t) tile_rows * fft_len, sizeof(float));
+    if (band == NULL) return ERR_MALLOC;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SQ_TILED_MAGIC, sizeof(header.magic));
+    header.version = SQ_TILED_VERSION;
+    header.fft_len = fft_len;
+    header.nchannels = nchannels;
+    header.tile_rows = tile_rows;
+    header.tile_cols = tile_cols;
+
+    // the header is rewritten with the row count and index at the end
+    if (!(fwrite(&header, sizeof(header), 1, outstream) == 1))
+    {
+        free(band);
+        return ERR_STREAM_WRITE;
+    }
+    offset = sizeof(header);
+
+    sq_input_open(&input, instream);
+    for (;;)
+    {
+        int is_done = !(sq_input_view(&input, (const void**) &row, sizeof(float), fft_len) == fft_len);
+
+        if (!is_done)
+        {
+            // scatter the row into the tiles of the band
+            for (tilei = 0; tilei < ntiles; tilei++)
+                memcpy(&band[tilei * tile_len + (size_t) rowi * tile_cols],
+                       &row[tilei * tile_cols], tile_cols * sizeof(float));
+            rowi++;
+            header.rows++;
+        }
+
+        if ((rowi == tile_rows) || (is_done && (rowi > 0)))
+        {
+            uint64_t* grown = realloc(index, (nbands + 1) * ntiles * sizeof(uint64_t));
+            if (grown == NULL)
+            {
+                sq_input_close(&input);
+                free(index);
+                free(band);
+                return ERR_MALLOC;
+            }
+            index = grown;
+
+            // zero the rows a short last band did not fill
+            if (rowi < tile_rows)
+                for (tilei = 0; tilei < ntiles; tilei++)
+                    memset(&band[tilei * tile_len + (size_t) rowi * tile_cols], 0,
+                           (size_t)(tile_rows - rowi) * tile_cols * sizeof(float));
+
+            for (tilei = 0; tilei < ntiles; tilei++)
+                index[nbands * ntiles + tilei] = offset + (uint64_t) tilei * tile_len * sizeof(float);
+
+            if (!(fwrite(band, sizeof(float) * tile_len, ntiles, outstream) == ntiles))
+            {
+                sq_input_close(&input);
+                free(index);
+                free(band);
+                return ERR_STREAM_WRITE;
+            }
+            offset += (uint64_t) ntiles * tile_len * sizeof(float);
+            nbands++;
+            rowi = 0;
+        }
+
+        if (is_done)
+            break;
+    }
+    sq_input_close(&input);
+    free(band);
+
+    header.index_offset = offset;
+    if ((nbands > 0) && !(fwrite(index, sizeof(uint64_t) * ntiles, nbands, outstream) == nbands))
+    {
+        free(index);
+        return ERR_STREAM_WRITE;
+    }
+    free(index);
+
+    if (!((fseeko(outstream, 0, SEEK_SET) == 0) &&
+          (fwrite(&header, sizeof(header), 1, outstream) == 1)))
+    {
+        sq_error_print("Tiled TFP output must be a seekable file.\n");
+        return ERR_STREAM_WRITE;
+    }
+
+    return 0;
+}
+
+int sq_tiled_open(sq_tiled* tiled, const char* path)
+{
+    sq_tiled_header* header = &tiled->header;
+    uint64_t nindex;
+
+    memset(tiled, 0, sizeof(*tiled));
+
+    tiled->stream = fopen(path, "rb");
+    if (tiled->stream == NULL)
+        return ERR_STREAM_OPEN;
+
+    if (!((fread(header, sizeof(*header), 1, tiled->stream) == 1) &&
+          (memcmp(header->magic, SQ_TILED_MAGIC, sizeof(header->magic)) == 0) &&
+          (header->version == SQ_TILED_VERSION) &&
+          (header->tile_rows > 0) && (header->tile_cols > 0) &&
+          (header->fft_len % header->tile_cols == 0)))
+    {
+        sq_tiled_close(tiled);
+        return ERR_BAD_FORMAT;
+    }
+
+    tiled->ntiles_per_band = header->fft_len / header->tile_cols;
+    tiled->nbands = (header->rows + header->tile_rows - 1) / header->tile_rows;
+    nindex = tiled->nbands * tiled->ntiles_per_band;
+
+    tiled->index = malloc(nindex * sizeof(uint64_t));
+    if ((nindex > 0) && (tiled->index == NULL))
+    {
+        sq_tiled_close(tiled);
+        return ERR_MALLOC;
+    }
+
+    if (!((fseeko(tiled->stream, header->index_offset, SEEK_SET) == 0) &&
+          (fread(tiled->index, sizeof(uint64_t), nindex, tiled->stream) == nindex)))
+    {
+        sq_tiled_close(tiled);
+        return ERR_STREAM_READ;
+    }
+
+    return 0;
+}
+
+int64_t sq_tiled_read(sq_tiled* tiled, uint64_t row, unsigned int nrows,
+                      unsigned int col, unsigned int ncols, float* out)
+{
+    const sq_tiled_header* header = &tiled->header;
+    size_t tile_len = (size_t) header->tile_rows * header->tile_cols;
+    unsigned int first_tile, last_tile, tilei, span;
+    unsigned int c0, c1;
+    uint64_t band, r0, r1, rowi;
+    const uint64_t* band_index;
+    size_t need;
+
+    if ((ncols < 1) || ((uint64_t) col + ncols > header->fft_len))
+        return ERR_ARG_BOUNDS;
+
+    if (row >= header->rows)
+        return 0;
+    if (row + nrows > header->rows)
+        nrows = header->rows - row;
+
+    first_tile = col / header->tile_cols;
+    last_tile = (col + ncols - 1) / header->tile_cols;
+    span = last_tile - first_tile + 1;
+
+    need = span * tile_len;
+    if (tiled->bfr_len < need)
+    {
+        free(tiled->bfr);
+        tiled->bfr_len = 0;
+        tiled->bfr = malloc(need * sizeof(float));
+        if (tiled->bfr == NULL) return ERR_MALLOC;
+        tiled->bfr_len = need;
+    }
+
+    for (band = row / header->tile_rows; band * header->tile_rows < row + nrows; band++)
+    {
+        band_index = &tiled->index[band * tiled->ntiles_per_band];
+
+        // one read if the tiles of the strip are adjacent, as sq_tiled_convert
+        // writes them; otherwise one read per tile
+        if (band_index[last_tile] == band_index[first_tile] + (uint64_t)(span - 1) * tile_len * sizeof(float))
+        {
+            if (!((fseeko(tiled->stream, band_index[first_tile], SEEK_SET) == 0) &&
+                  (fread(tiled->bfr, sizeof(float) * tile_len, span, tiled->stream) == span)))
+                return ERR_STREAM_READ;
+        }
+        else
+        {
+            for (tilei = 0; tilei < span; tilei++)
+                if (!((fseeko(tiled->stream, band_index[first_tile + tilei], SEEK_SET) == 0) &&
+                      (fread(&tiled->bfr[tilei * tile_len], sizeof(float), tile_len, tiled->stream) == tile_len)))
+                    return ERR_STREAM_READ;
+        }
+
+        r0 = band * header->tile_rows;
+        r1 = r0 + header->tile_rows;
+        if (r0 < row) r0 = row;
+        if (r1 > row + nrows) r1 = row + nrows;
+
+        for (rowi = r0; rowi < r1; rowi++)
+        {
+            float* dst = &out[(rowi - row) * ncols];
+            unsigned int tile_row = rowi - band * header->tile_rows;
+
+            for (tilei = first_tile; tilei <= last_tile; tilei++)
+            {
+                c0 = tilei * header->tile_cols;
+                c1 = c0 + header->tile_cols;
+                if (c0 < col) c0 = col;
+                if (c1 > col + ncols) c1 = col + ncols;
+
+                memcpy(&dst[c0 - col],
+                       &tiled->bfr[(tilei - first_tile) * tile_len +
+                                   (size_t) tile_row * header->tile_cols +
+                                   (c0 - tilei * header->tile_cols)],
+                       (c1 - c0) * sizeof(float));
+            }
+        }
+    }
+
+    return nrows;
+}
+
+void sq_tiled_close(sq_tiled* tiled)
+{
+    if (tiled->stream != NULL)
+        fclose(tiled->stream);
+    free(tiled->index);
+    free(tiled->bfr);
+    memset(tiled, 0, sizeof(*tiled));
+}
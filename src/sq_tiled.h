@@ -0,0 +1,120 @@
+/*******************************************************************************
+
+  File:    sq_tiled.h
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+#ifndef SQ_TILED_H
+#define SQ_TILED_H
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "sq_constants.h"
+
+#define SQ_TILED_MAGIC "SQTFPT\0"
+#define SQ_TILED_VERSION 1
+
+/*
+ * Tiled time-frequency-power file. A flat TFP file is one row of fft_len
+ * power values per FFT; reading a narrow channel strip out of it takes one
+ * seek per row. The tiled file cuts the rows into bands of tile_rows rows,
+ * and each band into tiles of tile_cols columns, stored one after another:
+ *
+ *   header | band 0: tile 0, tile 1, ... | band 1: ... | chunk index
+ *
+ * Each tile holds tile_rows * tile_cols floats, row-major; the last band is
+ * padded with zeros. Adjacent tiles of a band are adjacent in the file, so
+ * a strip costs one contiguous read per band. The chunk index gives the
+ * file offset of every tile (band-major), so readers never assume the
+ * layout and writers are free to reorder or pad.
+ */
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t fft_len;
+    // number of coarse channels the FFT output is divided into
+    uint32_t nchannels;
+    uint32_t tile_rows;
+    uint32_t tile_cols;
+    uint32_t reserved;
+    uint64_t rows;
+    uint64_t index_offset;
+} sq_tiled_header;
+
+typedef struct
+{
+    FILE* stream;
+    sq_tiled_header header;
+    uint64_t nbands;
+    unsigned int ntiles_per_band;
+    uint64_t* index;
+    float* bfr;
+    size_t bfr_len;
+} sq_tiled;
+
+/**
+ * Converts a flat TFP stream into a tiled TFP file.
+ * @param instream Input stream of fft_len floats per row
+ * @param outstream Output file; must be seekable, the header is written last
+ * @param fft_len Row length
+ * @param nchannels Number of coarse channels, recorded in the header
+ * @param tile_rows Rows per tile
+ * @param tile_cols Columns per tile; must divide fft_len
+ * @return Code; negative if error.
+ */
+int sq_tiled_convert(FILE* instream, FILE* outstream, unsigned int fft_len,
+                     unsigned int nchannels, unsigned int tile_rows, unsigned int tile_cols);
+
+/**
+ * Opens a tiled TFP file and loads its chunk index.
+ * @param tiled Reader to initialize
+ * @param path Path of the file
+ * @return Code; ERR_BAD_FORMAT if the file is not a tiled TFP file.
+ */
+int sq_tiled_open(sq_tiled* tiled, const char* path);
+
+/**
+ * Reads a rectangle of a tiled TFP file.
+ * @param tiled An open reader
+ * @param row First row
+ * @param nrows Number of rows
+ * @param col First column
+ * @param ncols Number of columns
+ * @param out Output, nrows rows of ncols floats
+ * @return Number of rows read (fewer at the end of the file); negative if error.
+ */
+int64_t sq_tiled_read(sq_tiled* tiled, uint64_t row, unsigned int nrows,
+                      unsigned int col, unsigned int ncols, float* out);
+
+/**
+ * Closes a tiled TFP file.
+ * @param tiled An open reader
+ */
+void sq_tiled_close(sq_tiled* tiled);
+
+#endif
@@ -31,10 +31,16 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <fftw3.h>
 
 #include "sq_constants.h"
 #include "sq_utils.h"
+#include "sq_simd.h"
 
 void print_usage(char* usage_text[], int arrlen)
 {
@@ -139,50 +145,413 @@ int sq_read_stream(FILE* instream, FILE* outstream, int ncolumns)
 }
 
 int sq_sample( FILE* instream, FILE* outstream, unsigned int nsamples, uint64_t filesize)
+{
+    return sq_sample_bits(instream, outstream, nsamples, filesize, 8, 1);
+}
+
+int sq_sample_bits(FILE* instream, FILE* outstream, unsigned int nsamples, uint64_t filesize,
+                   unsigned int bits, unsigned char is_negated)
+{
+    return sq_sample_header(instream, outstream, nsamples, filesize, bits, is_negated, NULL);
+}
+
+int sq_sample_header(FILE* instream, FILE* outstream, unsigned int nsamples, uint64_t filesize,
+                     unsigned int bits, unsigned char is_negated, sq_stream_header* header)
 {
     if ((nsamples <= 0) || (nsamples > MAX_SMPLS_LEN))
         return ERR_ARG_BOUNDS;
+
+    unsigned int smpl_bytes = sq_sample_bytes(bits);
+    if (smpl_bytes == 0)
+    {
+        sq_error_print("Sample width must be 4, 8 or 16 bits.\n");
+        return ERR_ARG_BOUNDS;
+    }
     
-    signed char *smpls_in;
-    float *smpls_out;
+    sq_input input;
+    const void *smpls_in;
+    cmplx *smpls_out;
     uint64_t total_bytes = 0;
     
-    unsigned int smpli, smplj;
-    
-    smpls_in = malloc(nsamples * sizeof(char) * 2);
-    if(smpls_in == NULL)
-        return ERR_MALLOC;
-    smpls_out = malloc(nsamples * sizeof(float) * 2);
+    smpls_out = malloc(nsamples * sizeof(cmplx));
     if(smpls_out == NULL)
         return ERR_MALLOC;
+
+    if (header != NULL)
+    {
+        // a continuous series, written in chunks of nsamples
+        header->sample_type = SQ_SAMPLE_COMPLEX;
+        header->raster_length = nsamples;
+        header->flags = 0;
+        sq_header_write(outstream, header);
+    }
     
-    while (fread(smpls_in, 2, nsamples, instream) == nsamples)
+    sq_input_open(&input, instream);
+    while (sq_input_view(&input, &smpls_in, smpl_bytes, nsamples) == nsamples)
     {
         // Sample
-        for (smpli = 0; smpli < nsamples; smpli++)
-        {
-            // notice that imaginary part is negated, assuming SETIQuest convention
-            smpls_out[(smpli<<1) + REAL] =  (float) smpls_in[(smpli<<1) + REAL];
-            smpls_out[(smpli<<1) + IMAG] = -(float) smpls_in[(smpli<<1) + IMAG];
-        }
+        sq_sample_bits_buf(smpls_in, smpls_out, nsamples, bits, is_negated);
         
         // Write 8 byte complex values
         fwrite(smpls_out, 8, nsamples, outstream);
         
         // Print progress
-        if(filesize > 0)
-        {
-            total_bytes += (nsamples * 2);
-            fprintf(stderr, "Percentage done = %f\n", (double)total_bytes*100/(double)filesize);
-        }
+        total_bytes += ((uint64_t) nsamples * smpl_bytes);
+        sq_print_progress(total_bytes, filesize);
     }
+    sq_input_close(&input);
     
-    free(smpls_in);
     free(smpls_out);
     
     return 0;
 }
 
+void sq_sample_buf(const signed char* in, cmplx* out, unsigned int nsamples)
+{
+    unsigned int smpli;
+
+    for (smpli = sq_simd_int8_to_cmplx(in, out, nsamples, 1); smpli < nsamples; smpli++)
+    {
+        // notice that imaginary part is negated, assuming SETIQuest convention
+        out[smpli][REAL] =  (float) in[(smpli<<1) + REAL];
+        out[smpli][IMAG] = -(float) in[(smpli<<1) + IMAG];
+    }
+}
+
+static cmplx nibble_table[256];
+static cmplx nibble_table_neg[256];
+static pthread_once_t nibble_once = PTHREAD_ONCE_INIT;
+
+static void nibble_init(void)
+{
+    int value;
+
+    for (value = 0; value < 256; value++)
+    {
+        nibble_table[value][REAL] = (float)(((value >> 4) ^ 8) - 8);
+        nibble_table[value][IMAG] = (float)(((value & 15) ^ 8) - 8);
+        nibble_table_neg[value][REAL] = nibble_table[value][REAL];
+        nibble_table_neg[value][IMAG] = -nibble_table[value][IMAG];
+    }
+}
+
+void sq_sample_bits_buf(const void* in, cmplx* out, unsigned int nsamples,
+                        unsigned int bits, unsigned char is_negated)
+{
+    unsigned int smpli;
+    float sign = is_negated ? -1.0 : 1.0;
+
+    if (bits == 4)
+    {
+        // one byte holds a whole sample, so a table covers every input
+        const cmplx* table;
+        const unsigned char* in4 = (const unsigned char*) in;
+
+        pthread_once(&nibble_once, nibble_init);
+        table = is_negated ? nibble_table_neg : nibble_table;
+
+        for (smpli = 0; smpli < nsamples; smpli++)
+        {
+            out[smpli][REAL] = table[in4[smpli]][REAL];
+            out[smpli][IMAG] = table[in4[smpli]][IMAG];
+        }
+    }
+    else if (bits == 16)
+    {
+        const int16_t* in16 = (const int16_t*) in;
+
+        for (smpli = sq_simd_int16_to_cmplx(in16, out, nsamples, is_negated); smpli < nsamples; smpli++)
+        {
+            out[smpli][REAL] = (float) in16[(smpli<<1) + REAL];
+            out[smpli][IMAG] = sign * (float) in16[(smpli<<1) + IMAG];
+        }
+    }
+    else
+    {
+        const signed char* in8 = (const signed char*) in;
+
+        for (smpli = sq_simd_int8_to_cmplx(in8, out, nsamples, is_negated); smpli < nsamples; smpli++)
+        {
+            out[smpli][REAL] = (float) in8[(smpli<<1) + REAL];
+            out[smpli][IMAG] = sign * (float) in8[(smpli<<1) + IMAG];
+        }
+    }
+}
+
+unsigned int sq_sample_bytes(unsigned int bits)
+{
+    switch (bits)
+    {
+        case 4:  return 1;
+        case 8:  return 2;
+        case 16: return 4;
+    }
+    return 0;
+}
+
+int sq_input_open(sq_input* input, FILE* stream)
+{
+    struct stat st;
+    off_t start;
+    void* map;
+
+    memset(input, 0, sizeof(*input));
+    input->stream = stream;
+
+    if ((fstat(fileno(stream), &st) < 0) || !S_ISREG(st.st_mode))
+        return 0;
+    start = ftello(stream);
+    if ((start < 0) || (st.st_size <= start) || ((uint64_t) st.st_size > SIZE_MAX))
+        return 0;
+
+    // pipes and unmappable files are read through the stream instead
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(stream), 0);
+    if (map == MAP_FAILED)
+        return 0;
+
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise(map, st.st_size, MADV_HUGEPAGE);
+#endif
+
+    input->map = map;
+    input->map_len = st.st_size;
+    input->offset = start;
+
+    return 0;
+}
+
+int sq_input_open_path(sq_input* input, const char* path)
+{
+    FILE* stream;
+
+    if (!strcmp(path, "-"))
+        return sq_input_open(input, stdin);
+
+    stream = fopen(path, "rb");
+    if (stream == NULL)
+    {
+        fprintf(stderr, "Could not open %s\n", path);
+        return ERR_STREAM_OPEN;
+    }
+
+    sq_input_open(input, stream);
+    input->is_owner = 1;
+
+    return 0;
+}
+
+// reads from the stream of an input, after any bytes left over from
+// looking for a header
+static size_t input_fread(sq_input* input, void* dst, size_t size, size_t count)
+{
+    size_t n;
+
+    if (input->pending_len == 0)
+        return fread(dst, size, count, input->stream);
+
+    n = input->pending_len;
+    if (n > size * count)
+        n = size * count;
+    memcpy(dst, input->pending, n);
+    input->pending_len -= n;
+    memmove(input->pending, &input->pending[n], input->pending_len);
+
+    n += fread((unsigned char*) dst + n, 1, size * count - n, input->stream);
+
+    return n / size;
+}
+
+size_t sq_input_view(sq_input* input, const void** view, size_t size, size_t count)
+{
+    uint64_t available;
+    uint64_t release_end;
+    long page = sysconf(_SC_PAGESIZE);
+
+    if (input->map == NULL)
+    {
+        if (input->bfr_len < size * count)
+        {
+            free(input->bfr);
+            input->bfr_len = 0;
+            input->bfr = malloc(size * count);
+            if (input->bfr == NULL)
+            {
+                sq_error_handle(ERR_MALLOC);
+                return 0;
+            }
+            input->bfr_len = size * count;
+        }
+        *view = input->bfr;
+        return input_fread(input, input->bfr, size, count);
+    }
+
+    // drop pages already consumed, so a long file does not pile up in the
+    // process; earlier views are no longer valid at this point
+    release_end = input->offset - (input->offset % page);
+    if (release_end - input->released >= SQ_INPUT_RELEASE_BYTES)
+    {
+        madvise((void*) &input->map[input->released], release_end - input->released, MADV_DONTNEED);
+        input->released = release_end;
+    }
+
+    available = (input->map_len - input->offset) / size;
+    if (count > available)
+        count = available;
+
+    *view = &input->map[input->offset];
+    input->offset += (uint64_t) size * count;
+
+    return count;
+}
+
+size_t sq_input_read(sq_input* input, void* dst, size_t size, size_t count)
+{
+    const void* view;
+
+    if (input->map == NULL)
+        return input_fread(input, dst, size, count);
+
+    count = sq_input_view(input, &view, size, count);
+    memcpy(dst, view, size * count);
+
+    return count;
+}
+
+int sq_input_header(sq_input* input, sq_stream_header* header)
+{
+    size_t magic_len = sizeof(header->magic);
+
+    if (input->map != NULL)
+    {
+        if ((input->map_len - input->offset < sizeof(*header)) ||
+            (memcmp(&input->map[input->offset], SQ_STREAM_MAGIC, magic_len) != 0))
+            return 0;
+        memcpy(header, &input->map[input->offset], sizeof(*header));
+        input->offset += sizeof(*header);
+    }
+    else
+    {
+        // keep what was read for the samples if it is not a header
+        input->pending_len = fread(input->pending, 1, magic_len, input->stream);
+        if ((input->pending_len < magic_len) ||
+            (memcmp(input->pending, SQ_STREAM_MAGIC, magic_len) != 0))
+            return 0;
+        input->pending_len = 0;
+
+        memcpy(header->magic, SQ_STREAM_MAGIC, magic_len);
+        if (fread((char*) header + magic_len, sizeof(*header) - magic_len, 1, input->stream) != 1)
+        {
+            sq_error_print("Stream header is truncated.\n");
+            return ERR_BAD_FORMAT;
+        }
+    }
+
+    if (header->version != SQ_STREAM_VERSION)
+    {
+        fprintf(stderr, "Stream header version %u is not supported\n", header->version);
+        return ERR_BAD_FORMAT;
+    }
+
+    return 1;
+}
+
+void sq_header_init(sq_stream_header* header, unsigned int sample_type,
+                    unsigned int raster_length, unsigned int flags)
+{
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, SQ_STREAM_MAGIC, sizeof(header->magic));
+    header->version = SQ_STREAM_VERSION;
+    header->sample_type = sample_type;
+    header->raster_length = raster_length;
+    header->flags = flags;
+}
+
+int sq_header_check(const sq_stream_header* header, unsigned int sample_type,
+                    unsigned int raster_length)
+{
+    static const char* type_names[] = { "complex", "real" };
+
+    if (header->sample_type != sample_type)
+    {
+        fprintf(stderr, "Stream holds %s samples, but %s samples are expected\n",
+                (header->sample_type == SQ_SAMPLE_REAL) ? type_names[1] : type_names[0],
+                type_names[sample_type == SQ_SAMPLE_REAL]);
+        return ERR_BAD_FORMAT;
+    }
+    if ((header->flags & SQ_STREAM_RASTERED) && (header->raster_length != raster_length))
+    {
+        fprintf(stderr, "Stream rasters are %u samples long, but the length given is %u\n",
+                header->raster_length, raster_length);
+        return ERR_BAD_FORMAT;
+    }
+
+    return 0;
+}
+
+int sq_header_write(FILE* outstream, const sq_stream_header* header)
+{
+    if (fwrite(header, sizeof(*header), 1, outstream) != 1)
+        return ERR_STREAM_WRITE;
+
+    return 0;
+}
+
+int sq_header_pass(sq_input* input, FILE* outstream,
+                   unsigned int in_type, unsigned int in_length,
+                   unsigned int out_type, unsigned int out_length,
+                   unsigned char is_rastering)
+{
+    sq_stream_header header;
+
+    int status = sq_input_header(input, &header);
+    if (status <= 0)
+        return status;
+
+    status = sq_header_check(&header, in_type, in_length);
+    if (status < 0)
+        return status;
+
+    header.sample_type = out_type;
+    header.raster_length = out_length;
+    if (is_rastering)
+        header.flags |= SQ_STREAM_RASTERED;
+
+    status = sq_header_write(outstream, &header);
+    if (status < 0)
+        return status;
+
+    return 1;
+}
+
+void sq_input_close(sq_input* input)
+{
+    if (input->map != NULL)
+        munmap((void*) input->map, input->map_len);
+    free(input->bfr);
+    if (input->is_owner)
+        fclose(input->stream);
+    memset(input, 0, sizeof(*input));
+}
+
+void sq_print_progress(uint64_t done_bytes, uint64_t filesize)
+{
+    static uint64_t last_ms = 0;
+    struct timeval tv;
+    uint64_t now_ms;
+
+    if (filesize == 0)
+        return;
+
+    gettimeofday(&tv, NULL);
+    now_ms = (uint64_t) tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    if ((now_ms - last_ms < PROGRESS_INTERVAL_MS) && (done_bytes < filesize))
+        return;
+    last_ms = now_ms;
+
+    fprintf(stderr, "Percentage done = %f\n", (double)done_bytes*100/(double)filesize);
+}
+
 float sq_randgaus()
 {
     float rand1 = ((float)rand() / RAND_MAX);
@@ -207,6 +576,7 @@ void sq_error_handle(int errcode)
         case ERR_MALLOC:            sq_error_print("Could not allocate memory."); break;
         case ERR_UNKNOWN_OPTION:    sq_error_print("Unknown option."); break;
         case ERR_UNKNOWN_WINDOW:    sq_error_print("Unknown window."); break;
+        case ERR_BAD_FORMAT:        sq_error_print("Unrecognized file or stream format."); break;
         default:
             if(errcode < 0)
                 sq_error_print("Unhandled error.");
@@ -215,14 +585,74 @@ void sq_error_handle(int errcode)
     sq_error_print("\n");
 }
 
+// reverses buffer[first..last] in place
+static void reverse_complex(fftwf_complex* buffer, unsigned int first, unsigned int last)
+{
+    float temp0, temp1;
+
+    while (first < last)
+    {
+        temp0 = buffer[first][0];
+        temp1 = buffer[first][1];
+        buffer[first][0] = buffer[last][0];
+        buffer[first][1] = buffer[last][1];
+        buffer[last][0] = temp0;
+        buffer[last][1] = temp1;
+        first++;
+        last--;
+    }
+}
+
+// rotates the buffer in place so that buffer[first] ends up at index 0
+static void rotate_complex(fftwf_complex* buffer, unsigned int length, unsigned int first)
+{
+    if ((first == 0) || (first >= length))
+        return;
+
+    reverse_complex(buffer, 0, first - 1);
+    reverse_complex(buffer, first, length - 1);
+    reverse_complex(buffer, 0, length - 1);
+}
+
 void sq_channelswap(fftwf_complex* buffer, unsigned int length)
 {
-    fftwf_complex* arr = malloc(length * sizeof(*buffer));
+    unsigned int half = length / 2;
+    unsigned int i;
+    float temp0, temp1;
 
-    memcpy(&arr[0], &buffer[length / 2], sizeof(*buffer) * length / 2);
-    memcpy(&arr[length / 2], &buffer[0], sizeof(*buffer) * length / 2);
-    
-    memcpy(&buffer[0], &arr[0], sizeof(*buffer) * length);
-    
-    free(arr);
+    if (length & 1)
+    {
+        // DC moves to index length/2, so the top (length+1)/2 samples come first
+        rotate_complex(buffer, length, half + 1);
+        return;
+    }
+
+    for (i = 0; i < half; i++)
+    {
+        temp0 = buffer[i][0];
+        temp1 = buffer[i][1];
+        buffer[i][0] = buffer[i + half][0];
+        buffer[i][1] = buffer[i + half][1];
+        buffer[i + half][0] = temp0;
+        buffer[i + half][1] = temp1;
+    }
+}
+
+void sq_channelunswap(fftwf_complex* buffer, unsigned int length)
+{
+    if (length & 1)
+        rotate_complex(buffer, length, length / 2);
+    else
+        sq_channelswap(buffer, length);
+}
+
+void sq_premodulate(fftwf_complex* buffer, unsigned int length)
+{
+    unsigned int i;
+
+    for (i = 1; i < length; i += 2)
+    {
+        buffer[i][0] = -buffer[i][0];
+        buffer[i][1] = -buffer[i][1];
+    }
 }
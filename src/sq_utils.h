@@ -36,6 +36,65 @@
 #include <sys/types.h>
 #include <fftw3.h>
 
+#include "sq_constants.h"
+
+#define SQ_STREAM_MAGIC "SQSTRM\0"
+#define SQ_STREAM_VERSION 1
+
+// sample types of a stream
+#define SQ_SAMPLE_COMPLEX 0
+#define SQ_SAMPLE_REAL 1
+
+// stream flags
+#define SQ_STREAM_RASTERED 1
+
+/*
+ * Optional header at the start of a block-to-block stream. Without one a
+ * stream is bare samples, as it always was; with one, each stage checks
+ * that its input is what it expects and passes the header on, updated for
+ * its output. Fields are in host byte order, like the samples.
+ */
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    // SQ_SAMPLE_COMPLEX (two floats per sample) or SQ_SAMPLE_REAL (one)
+    uint32_t sample_type;
+    // samples per raster; with SQ_STREAM_RASTERED the rasters are
+    // meaningful (spectra, windowed blocks) and readers must use this
+    // length, otherwise the stream is a continuous series written in
+    // chunks of this length
+    uint32_t raster_length;
+    uint32_t flags;
+    // of the time series the stream derives from, in Hz; 0 if unknown
+    double sample_rate;
+    // in Hz; 0 if unknown
+    double center_freq;
+    // of the first sample, in seconds since the epoch; 0 if unknown
+    double timestamp;
+} sq_stream_header;
+
+/**
+ * Input of a processing stage. A regular file is memory-mapped and handed
+ * out as views into the mapping, so reading a raster costs no copy; pipes
+ * and terminals fall back to buffered reads into a buffer the input owns.
+ */
+typedef struct
+{
+    FILE* stream;
+    const unsigned char* map;
+    uint64_t map_len;
+    uint64_t offset;
+    // mapped bytes before this offset have been handed back to the kernel
+    uint64_t released;
+    unsigned char* bfr;
+    size_t bfr_len;
+    unsigned char is_owner;
+    // bytes read from a stream while looking for a header, and not used
+    unsigned char pending[8];
+    size_t pending_len;
+} sq_input;
+
 /** 
  * Prints a processing block's usage to the output stream.
  * @param usage_text A two-dimensional character array; each row is printed on a new line.
@@ -83,12 +142,204 @@ int sq_read_stream(FILE* instream, FILE* outstream, int ncolumns);
 int sq_sample( FILE* instream, FILE* outstream, unsigned int nsamples, uint64_t filesize);
 
 /**
- * Swaps left and right halves of an array of complex numbers
+ * Like sq_sample, for recorders with other sample widths.
+ * @param instream Input stream of 2-channel samples
+ * @param outstream Output stream of floats
+ * @param nsamples Number of samples to process at a time
+ * @param filesize Size of the input in bytes, for progress reports; 0 for none
+ * @param bits Bits per channel: 4, 8 or 16 (see sq_sample_bits_buf)
+ * @param is_negated If 1, the imaginary part is negated (setiQuest convention)
+ * @return Code; negative if error.
+ */
+int sq_sample_bits(FILE* instream, FILE* outstream, unsigned int nsamples, uint64_t filesize,
+                   unsigned int bits, unsigned char is_negated);
+
+/**
+ * Same as sq_sample_bits, and writes a stream header first.
+ * @param instream Input stream of 2-channel samples
+ * @param outstream Output stream of floats
+ * @param nsamples Number of samples to process at a time
+ * @param filesize Size of the input in bytes, for progress reports; 0 for none
+ * @param bits Bits per channel: 4, 8 or 16 (see sq_sample_bits_buf)
+ * @param is_negated If 1, the imaginary part is negated (setiQuest convention)
+ * @param header Header to write, with the sample rate, center frequency and
+ *               timestamp filled in; the other fields are set here. NULL
+ *               writes no header.
+ * @return Code; negative if error.
+ */
+int sq_sample_header(FILE* instream, FILE* outstream, unsigned int nsamples, uint64_t filesize,
+                     unsigned int bits, unsigned char is_negated, sq_stream_header* header);
+
+/**
+ * Converts 2-channel (quadrature) 8-bit samples to complex floats. The
+ * imaginary part is negated, following the setiQuest convention.
+ * @param in Input 8-bit samples, alternating real and imaginary
+ * @param out Output complex samples
+ * @param nsamples Number of complex samples to convert
+ */
+void sq_sample_buf(const signed char* in, cmplx* out, unsigned int nsamples);
+
+/**
+ * Converts 2-channel (quadrature) integer samples to complex floats.
+ * 4-bit samples take one byte each, real part in the upper nibble and
+ * imaginary part in the lower one; 8-bit samples alternate real and
+ * imaginary bytes; 16-bit samples alternate real and imaginary words in
+ * host byte order. All are two's complement.
+ * @param in Input samples
+ * @param out Output complex samples
+ * @param nsamples Number of complex samples to convert
+ * @param bits Bits per channel: 4, 8 or 16
+ * @param is_negated If 1, the imaginary part is negated
+ */
+void sq_sample_bits_buf(const void* in, cmplx* out, unsigned int nsamples,
+                        unsigned int bits, unsigned char is_negated);
+
+/**
+ * Returns the number of bytes one complex sample takes at a sample width.
+ * @param bits Bits per channel: 4, 8 or 16
+ * @return Bytes per complex sample, or 0 if the width is not supported
+ */
+unsigned int sq_sample_bytes(unsigned int bits);
+
+/**
+ * Sets up reading from a stream. If it is a regular file, the rest of it
+ * from the current position is memory-mapped.
+ * @param input Input to initialize
+ * @param stream Stream to read from; stays open after sq_input_close
+ * @return Code; negative if error.
+ */
+int sq_input_open(sq_input* input, FILE* stream);
+
+/**
+ * Opens a file by name and sets up reading from it.
+ * @param input Input to initialize
+ * @param path Path of the file; "-" means stdin
+ * @return Code; negative if error.
+ */
+int sq_input_open_path(sq_input* input, const char* path);
+
+/**
+ * Returns a view of the next items of the input, like fread without the
+ * copy. The view stays valid until the next call on the input.
+ * @param input An open input
+ * @param view Set to the start of the items
+ * @param size Size of one item in bytes
+ * @param count Number of items wanted
+ * @return Number of complete items in the view; less than count at the end
+ */
+size_t sq_input_view(sq_input* input, const void** view, size_t size, size_t count);
+
+/**
+ * Copies the next items of the input into a buffer, like fread.
+ * @param input An open input
+ * @param dst Destination of size * count bytes
+ * @param size Size of one item in bytes
+ * @param count Number of items wanted
+ * @return Number of complete items copied
+ */
+size_t sq_input_read(sq_input* input, void* dst, size_t size, size_t count);
+
+/**
+ * Reads the stream header at the start of an input, if there is one. Must
+ * be called before anything else is read from the input; if there is no
+ * header, nothing is consumed.
+ * @param input An open input
+ * @param header Filled in if there is a header
+ * @return 1 if a header was read, 0 if there is none; negative if error.
+ */
+int sq_input_header(sq_input* input, sq_stream_header* header);
+
+/**
+ * Sets up a stream header with unknown sample rate, center frequency and
+ * timestamp.
+ * @param header Header to initialize
+ * @param sample_type SQ_SAMPLE_COMPLEX or SQ_SAMPLE_REAL
+ * @param raster_length Samples per raster
+ * @param flags Stream flags, e.g. SQ_STREAM_RASTERED
+ */
+void sq_header_init(sq_stream_header* header, unsigned int sample_type,
+                    unsigned int raster_length, unsigned int flags);
+
+/**
+ * Checks that a stream header describes what a stage expects to read.
+ * @param header Header of the stage's input
+ * @param sample_type SQ_SAMPLE_COMPLEX or SQ_SAMPLE_REAL
+ * @param raster_length Raster length the stage was given; only checked if
+ *                      the stream is SQ_STREAM_RASTERED
+ * @return Code; ERR_BAD_FORMAT, with a message, if they disagree.
+ */
+int sq_header_check(const sq_stream_header* header, unsigned int sample_type,
+                    unsigned int raster_length);
+
+/**
+ * Writes a stream header.
+ * @param outstream Output stream
+ * @param header Header to write
+ * @return Code; negative if error.
+ */
+int sq_header_write(FILE* outstream, const sq_stream_header* header);
+
+/**
+ * Does what most stages do with the header of their input: if there is
+ * one, checks it and writes it on to the output, updated for the stage.
+ * @param input An open input, nothing read from it yet
+ * @param outstream Output stream of the stage
+ * @param in_type Sample type the stage reads
+ * @param in_length Raster length the stage reads
+ * @param out_type Sample type the stage writes
+ * @param out_length Raster length the stage writes
+ * @param is_rastering 1 if the stage gives its output raster structure
+ *                     (windows, transforms, bins...); 0 if it works
+ *                     sample by sample and the output is rastered only if
+ *                     the input was
+ * @return 1 if there was a header, 0 if not; negative if error.
+ */
+int sq_header_pass(sq_input* input, FILE* outstream,
+                   unsigned int in_type, unsigned int in_length,
+                   unsigned int out_type, unsigned int out_length,
+                   unsigned char is_rastering);
+
+/**
+ * Unmaps and frees an input, closing its stream if it opened it.
+ * @param input An open input
+ */
+void sq_input_close(sq_input* input);
+
+/**
+ * Prints the percentage of the input that has been processed to stderr,
+ * at most once every PROGRESS_INTERVAL_MS and once more on completion.
+ * @param done_bytes Number of input bytes processed so far
+ * @param filesize Total size of the input in bytes; nothing is printed if 0
+ */
+void sq_print_progress(uint64_t done_bytes, uint64_t filesize);
+
+/**
+ * Swaps left and right halves of an array of complex numbers, in place and
+ * without allocating, so that the DC channel of an FFT output moves from
+ * index 0 to index length/2. Odd lengths are rotated accordingly.
  * @param buffer A pointer to an fftwf_complex array
  * @param length Length of input array
  */
 void sq_channelswap(fftwf_complex* buffer, unsigned int length);
 
+/**
+ * Undoes sq_channelswap, moving the DC channel from index length/2 back to
+ * index 0. This is the same as sq_channelswap for even lengths.
+ * @param buffer A pointer to an fftwf_complex array
+ * @param length Length of input array
+ */
+void sq_channelunswap(fftwf_complex* buffer, unsigned int length);
+
+/**
+ * Multiplies sample n by (-1)^n. For even lengths, the forward FFT of the
+ * premodulated samples is the channel-swapped FFT of the original ones,
+ * and the inverse FFT of unswapped channels is the premodulated inverse
+ * FFT of swapped ones; this lets the swap be folded into other passes.
+ * @param buffer A pointer to an fftwf_complex array
+ * @param length Length of input array
+ */
+void sq_premodulate(fftwf_complex* buffer, unsigned int length);
+
 /**
  * Generates a random guassian number between 0 and 1
  * @return A float value between 0 and 1
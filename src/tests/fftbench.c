@@ -0,0 +1,195 @@
+/*******************************************************************************
+
+  File:    fftbench.c
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+#ifndef __x86_64__
+#   define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <sq_dsp.h>
+#include <sq_utils.h>
+
+char* usage_text[] = 
+{
+    "                                                                   ",
+    "NAME                                                               ",
+    "   fftbench - times the FFT of sqfft for every combination of      ",
+    "              thread count and batch size, and reports throughput  ",
+    "              per thread, i.e. per core when there are as many     ",
+    "              cores as threads                                     ",
+    "SYNOPSIS                                                           ",
+    "   fftbench [OPTIONS] ...                                          ",
+    "DESCRIPTION                                                        ",
+    "   -l FFT length (default 4096)                                    ",
+    "   -b largest batch; 1, 2, 4, ... up to it are timed (default 64)  ",
+    "   -t largest thread count; 1, 2, 4, ... up to it (default 1)      ",
+    "   -s million samples transformed per combination (default 64)     ",
+    "   -m flag, measure the plans instead of estimating them           ",
+    "                                                                   "
+};
+int arrlen = sizeof(usage_text)/sizeof(*usage_text);
+
+unsigned int length = 4096;
+unsigned int max_batch = 64;
+unsigned int max_threads = 1;
+unsigned int msamples = 64;
+unsigned char is_measured = 0;
+
+static double seconds()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// time spent in sq_fft_buf for about msamples million samples, in seconds;
+// the input is restored before each call, outside the timing, so that the
+// values stay finite over repeated forward transforms
+static int time_fft(unsigned int nthreads, unsigned int batch, const fftwf_complex* input,
+                    double* elapsed)
+{
+    sq_fft_state fft;
+    size_t total = (size_t) length * batch;
+    uint64_t calli, ncalls;
+    double start;
+    int status;
+
+    status = sq_fft_set_threads(nthreads);
+    if (status == 0)
+        status = sq_fft_init_many(&fft, length, batch, 0, is_measured, 0);
+    if (status < 0)
+        return status;
+
+    ncalls = ((uint64_t) msamples * 1000000 + total - 1) / total;
+
+    // one untimed call faults the pages in
+    memcpy(fft.bfr, input, total * sizeof(fftwf_complex));
+    sq_fft_buf(&fft);
+
+    *elapsed = 0;
+    for (calli = 0; calli < ncalls; calli++)
+    {
+        memcpy(fft.bfr, input, total * sizeof(fftwf_complex));
+        start = seconds();
+        sq_fft_buf(&fft);
+        *elapsed += seconds() - start;
+    }
+    *elapsed /= (double) (ncalls * total) / 1e6;
+
+    sq_fft_free(&fft);
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+    size_t smpli;
+    unsigned int nthreads, batch;
+    fftwf_complex* input;
+    double elapsed;
+    int status = 0;
+
+    while ((opt = getopt(argc, argv, "hl:b:t:s:m")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(usage_text, arrlen);
+                exit(EXIT_FAILURE);
+            case 'l':
+                sscanf(optarg, "%u", &length);
+                break;
+            case 'b':
+                sscanf(optarg, "%u", &max_batch);
+                break;
+            case 't':
+                sscanf(optarg, "%u", &max_threads);
+                break;
+            case 's':
+                sscanf(optarg, "%u", &msamples);
+                break;
+            case 'm':
+                is_measured = 1;
+                break;
+            default:
+                print_usage(usage_text, arrlen);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if ((length < 2) || (max_batch < 1) || (max_threads < 1) || (msamples < 1))
+    {
+        print_usage(usage_text, arrlen);
+        exit(EXIT_FAILURE);
+    }
+
+    input = malloc((size_t) length * max_batch * sizeof(fftwf_complex));
+    if (input == NULL)
+    {
+        fprintf(stderr, "%s encountered a fatal error.", argv[0]);
+        sq_error_handle(ERR_MALLOC);
+        exit(EXIT_FAILURE);
+    }
+    for (smpli = 0; smpli < (size_t) length * max_batch; smpli++)
+    {
+        input[smpli][0] = (float) (rand() % 256 - 128);
+        input[smpli][1] = (float) (rand() % 256 - 128);
+    }
+
+    printf("FFT length %u, %u million samples per combination\n", length, msamples);
+    printf("threads  batch   ns/sample    Msamples/s   Msamples/s per thread\n");
+    for (nthreads = 1; (status == 0) && (nthreads <= max_threads); nthreads <<= 1)
+    {
+        for (batch = 1; (status == 0) && (batch <= max_batch); batch <<= 1)
+        {
+            status = time_fft(nthreads, batch, input, &elapsed);
+            if (status == 0)
+                printf("%7u  %5u  %10.2f  %12.1f  %22.1f\n", nthreads, batch, elapsed * 1e3,
+                       1.0 / elapsed, 1.0 / elapsed / nthreads);
+        }
+    }
+
+    free(input);
+
+    if (status < 0)
+    {
+        fprintf(stderr, "%s encountered a fatal error.", argv[0]);
+        sq_error_handle(status);
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,160 @@
+/*******************************************************************************
+
+  File:    swapbench.c
+  Project: SETIkit
+  Authors: agent <agent at local>
+
+  Copyright 2026 agent
+
+  SETIkit is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  SETIkit is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+ 
+  You should have received a copy of the GNU General Public License
+  along with SETIkit.  If not, see <http://www.gnu.org/licenses/>.
+
+  Implementers of this code are requested to include the caption
+  "Licensed through SETI" with a link to setiQuest.org.
+
+  For alternate licensing arrangements, please contact
+  The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+#ifndef __x86_64__
+#   define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <sq_utils.h>
+
+char* usage_text[] = 
+{
+    "                                                                   ",
+    "NAME                                                               ",
+    "   swapbench - times the FFT channel swap: the original version,   ",
+    "               which copies through a malloc'd array, against the  ",
+    "               in-place sq_channelswap and sq_premodulate          ",
+    "SYNOPSIS                                                           ",
+    "   swapbench [OPTIONS] ...                                         ",
+    "DESCRIPTION                                                        ",
+    "   -l number of complex samples (default 8388608)                  ",
+    "   -n number of timed repetitions (default 20)                     ",
+    "                                                                   "
+};
+int arrlen = sizeof(usage_text)/sizeof(*usage_text);
+
+unsigned int length = 8388608;
+unsigned int reps = 20;
+
+// the channel swap as it was before it was made allocation-free
+static void channelswap_copy(fftwf_complex* buffer, unsigned int length)
+{
+    fftwf_complex* arr = malloc(length * sizeof(*buffer));
+
+    memcpy(&arr[0], &buffer[length / 2], sizeof(*buffer) * length / 2);
+    memcpy(&arr[length / 2], &buffer[0], sizeof(*buffer) * length / 2);
+
+    memcpy(&buffer[0], &arr[0], sizeof(*buffer) * length);
+
+    free(arr);
+}
+
+static double seconds()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// best time of reps calls, in seconds
+static double time_swap(void (*swap)(fftwf_complex*, unsigned int), fftwf_complex* buffer)
+{
+    unsigned int repi;
+    double start, elapsed, best = 0;
+
+    // one untimed call faults the pages in
+    swap(buffer, length);
+    for (repi = 0; repi < reps; repi++)
+    {
+        start = seconds();
+        swap(buffer, length);
+        elapsed = seconds() - start;
+        if ((repi == 0) || (elapsed < best))
+            best = elapsed;
+    }
+
+    return best;
+}
+
+static void report(const char* name, double elapsed)
+{
+    printf("%-24s %8.2f ms  %8.2f ns/sample  %8.1f MB/s\n", name, elapsed * 1e3,
+           elapsed * 1e9 / length, length * sizeof(fftwf_complex) / elapsed / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+    unsigned int smpli;
+    fftwf_complex* buffer;
+
+    while ((opt = getopt(argc, argv, "hl:n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(usage_text, arrlen);
+                exit(EXIT_FAILURE);
+            case 'l':
+                sscanf(optarg, "%u", &length);
+                break;
+            case 'n':
+                sscanf(optarg, "%u", &reps);
+                break;
+            default:
+                print_usage(usage_text, arrlen);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if ((length < 2) || (reps < 1))
+    {
+        print_usage(usage_text, arrlen);
+        exit(EXIT_FAILURE);
+    }
+
+    buffer = fftwf_malloc(length * sizeof(fftwf_complex));
+    if (buffer == NULL)
+    {
+        fprintf(stderr, "%s encountered a fatal error.", argv[0]);
+        sq_error_handle(ERR_MALLOC);
+        exit(EXIT_FAILURE);
+    }
+    for (smpli = 0; smpli < length; smpli++)
+    {
+        buffer[smpli][0] = smpli;
+        buffer[smpli][1] = -(float) smpli;
+    }
+
+    printf("%u complex samples, best of %u\n", length, reps);
+    report("malloc + 3 memcpy swap", time_swap(channelswap_copy, buffer));
+    report("sq_channelswap", time_swap(sq_channelswap, buffer));
+    report("sq_premodulate", time_swap(sq_premodulate, buffer));
+
+    fftwf_free(buffer);
+
+    exit(EXIT_SUCCESS);
+}
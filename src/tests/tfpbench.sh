@@ -0,0 +1,82 @@
+#!/bin/bash
+
+# Times the fused sqtfp program against the piped chain of sqtfp.sh -P on
+# the same input, and checks that the two outputs are identical.
+
+FFTLEN=4096
+WINDOW="wola"
+MBYTES=64
+
+usage () 
+{
+    echo "                                                                        " >&2
+    echo "NAME                                                                    " >&2
+    echo "  tfpbench - compares the throughput of sqtfp with the piped chain of   " >&2
+    echo "             sqtfp.sh -P on the same 8-bit complex input                " >&2
+    echo "SYNOPSIS                                                                " >&2
+    echo "  tfpbench.sh [OPTIONS] [file]                                          " >&2
+    echo "OPTIONS                                                                 " >&2
+    echo "  -l integer, FFT length; default value is 4096                         " >&2
+    echo "  -w window type [wola, hann]; default is wola                          " >&2
+    echo "  -s integer, megabytes of random input to make if no file is given;    " >&2
+    echo "     default value is 64                                                " >&2
+    echo "  -h show help(this)                                                    " >&2
+    echo "                                                                        " >&2
+}
+
+while getopts l:w:s:h OPT
+    do
+        case $OPT in
+        l) FFTLEN=$OPTARG;;
+        w) WINDOW=$OPTARG;;
+        s) MBYTES=$OPTARG;;
+        h) usage && exit 1;;
+        ?) usage && exit 1;;
+    esac
+done
+
+shift $(expr $OPTIND - 1)
+
+TMPDIR=$(mktemp -d)
+trap 'rm -rf "$TMPDIR"' EXIT
+
+INPUT=$1
+if [ ! "$INPUT" ]; then
+    INPUT=$TMPDIR/input.dat
+    head -c $(expr $MBYTES \* 1048576) /dev/urandom > $INPUT
+fi
+SIZE=$(stat -c%s "$INPUT")
+
+# runs a command on the input file, writing to the file named first;
+# prints the seconds taken
+run ()
+{
+    local output=$1
+    shift
+    local start=$(date +%s.%N)
+    "$@" $INPUT > $output || exit 1
+    local end=$(date +%s.%N)
+    echo "$start $end" | awk '{ printf "%.3f", $2 - $1 }'
+}
+
+# one untimed pass warms the page cache
+cat $INPUT > /dev/null
+
+cd $TMPDIR
+FUSED=$(run fused.out sqtfp -l $FFTLEN -w $WINDOW -f 9)
+CHAIN=$(run chain.out sqtfp.sh -P -l $FFTLEN -w $WINDOW)
+
+echo "input: $SIZE bytes, FFT length $FFTLEN, window $WINDOW"
+for result in "sqtfp $FUSED" "sqtfp.sh-P $CHAIN"; do
+    echo "$result $SIZE" | awk '{ printf "%-12s %8.3f s %8.1f MB/s\n", $1, $2, $3 / $2 / 1e6 }'
+done
+# sqtfp folds the channel swap into the window as a premodulation, so the
+# FFT rounds differently; the outputs should agree to float precision
+if cmp -s fused.out chain.out; then
+    echo "outputs are identical"
+else
+    paste <(od -An -v -w4 -f fused.out) <(od -An -v -w4 -f chain.out) | awk '
+        { d = $1 - $2; if (d < 0) d = -d; m = ($2 < 0) ? -$2 : $2;
+          if (m > 0 && d / m > worst) worst = d / m }
+        END { printf "outputs differ by at most %.1e (relative)\n", worst }'
+fi